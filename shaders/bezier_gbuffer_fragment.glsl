@@ -0,0 +1,55 @@
+#version 410 core
+
+// Przebieg geometrii trybu odroczonego dla powierzchni Beziera - uklad
+// G-buffera jak w gbuffer_fragment.glsl. Model oswietlenia flagi rozni sie
+// od glownego: diffuse bez wspolczynnika materialu, specular bez koloru bazowego.
+// Warianty programu (shader_variants.h): USE_FLAG_COLORS
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+
+layout (location = 0) out vec4 gAlbedoOut;
+layout (location = 1) out vec4 gNormalOut;
+layout (location = 2) out vec4 gSpecularOut;
+
+// Material, kolor obiektu i szachownica dla podlogi
+layout(std140) uniform MaterialData {
+    vec3 ambient;
+    float shininess;
+    vec3 diffuse;
+    bool useTexture;
+    vec3 specular;
+    bool useCheckerboard;
+    vec3 objectColor;
+    float checkerScale;
+    vec3 checkerColor1;
+    bool useFlagColors;
+    vec3 checkerColor2;
+    vec3 flagColor1;
+    vec3 flagColor2;
+} material;
+
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xy;
+    if(n.z < 0.0) {
+        e = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return e * 0.5 + 0.5;
+}
+
+void main()
+{
+    // Kolor flagi - gorna/dolna polowa (polska flaga: bialy u gory, czerwony na dole)
+#ifdef USE_FLAG_COLORS
+    vec3 baseColor = TexCoord.y > 0.5 ? material.flagColor1 : material.flagColor2;
+#else
+    vec3 baseColor = material.objectColor;
+#endif
+
+    gAlbedoOut = vec4(baseColor, material.ambient.x);
+    gNormalOut = vec4(encodeNormal(normalize(Normal)), 1.0, 0.0);
+    gSpecularOut = vec4(material.specular, material.shininess / 255.0);
+}
@@ -3,21 +3,184 @@
 layout (vertices = 16) out;
 
 in vec3 vPos[];
+in vec2 vUV[];
+in mat4 vModel[];
+in mat3 vNormalMatrix[];
+in vec2 vWind[];
+
 out vec3 tcPos[];
+out vec2 tcUV[];
+// Dane egzemplarza - jednakowe dla wszystkich punktow platu
+patch out mat4 tcModel;
+patch out mat3 tcNormalMatrix;
+patch out vec2 tcWind;
+
+// Dane klatki - wspolne dla wszystkich shaderow
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 fogColor;          // Mgla
+    float fogDensity;
+    float dayNightFactor;   // Dzien/Noc: 0.0 = noc, 1.0 = dzien
+    bool fogEnabled;
+    bool useBlinn;          // Phong vs Blinn
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    vec2 viewportSize;      // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+};
+
+// Parametry powierzchni - zapisywane co klatke do bufora dynamicznego
+// Adaptacyjnie: poziom krawedzi = rzutowana dlugosc / tessTriangleSize,
+// ograniczony przez tessMaxLevel. Inaczej wszystkie poziomy = tessMaxLevel.
+layout(std140) uniform SurfaceData {
+    vec2 windDirection;
+    float windStrength;       // mnoznik sily wiatru egzemplarzy
+    float tessMaxLevel;
+    float tessTriangleSize;   // docelowa dlugosc krawedzi trojkata w pikselach
+    bool adaptiveTessellation;
+    // Odrzucanie patchy odwroconych od kamery - tylko dla powierzchni jednostronnych
+    bool backfaceCulling;
+};
+
+// Wiatr jak w TES, w globalnym UV punktu kontrolnego - wspolne punkty
+// sasiednich platow przesuwaja sie identycznie
+vec3 windDisplaced(vec3 p, vec2 uv, float strength, float phase)
+{
+    float u = uv.x;
+    float v = uv.y;
+    float windEffect = u * u * strength;
+    float wave1 = sin(time * 2.5 + phase + u * 5.0 + v * 2.0) * windEffect;
+    float wave2 = sin(time * 4.0 + phase + u * 3.5 - v * 1.5) * windEffect * 0.4;
+    float wave3 = sin(time * 1.8 + phase + u * 2.5 + v * 4.0) * windEffect * 0.25;
+    p.z += (wave1 + wave2 + wave3) * windDirection.x;
+    p.x += wave2 * 0.1 * windDirection.y;
+    return p;
+}
+
+// Dlugosc odcinka w pikselach: srednica sfery na nim opisanej po rzutowaniu
+// (stabilne takze dla punktow blisko/za plaszczyzna bliska)
+float projectedLength(vec3 a, vec3 b)
+{
+    vec3 center = 0.5 * (a + b);
+    float depth = max(-center.z, 0.1);
+    return distance(a, b) * projection[1][1] * 0.5 * viewportSize.y / depth;
+}
 
-uniform int tessLevelOuter;
-uniform int tessLevelInner;
+// Krawedz patcha z 4 punktow kontrolnych; kolejnosc sumowania symetryczna,
+// wiec sasiedni patch liczacy wspolna krawedz od drugiego konca da ten sam poziom
+float edgeLevel(vec3 p0, vec3 p1, vec3 p2, vec3 p3)
+{
+    float pixels = (projectedLength(p0, p1) + projectedLength(p2, p3)) + projectedLength(p1, p2);
+    return clamp(pixels / tessTriangleSize, 1.0, tessMaxLevel);
+}
+
+// Otoczka punktow kontrolnych (+ zapas na wiatr) poza jedna z plaszczyzn frustum
+bool outsideFrustum(mat4 model, float strength)
+{
+    vec3 boundsMin = vPos[0];
+    vec3 boundsMax = vPos[0];
+    for (int i = 1; i < 16; ++i) {
+        boundsMin = min(boundsMin, vPos[i]);
+        boundsMax = max(boundsMax, vPos[i]);
+    }
+    // Maksymalne wychylenie fal z TES: |wave1 + wave2 + wave3| <= 1.65 * windStrength
+    vec3 wind = vec3(0.04 * abs(windDirection.y), 0.0, 1.65 * abs(windDirection.x)) * strength;
+    boundsMin -= wind;
+    boundsMax += wind;
+
+    mat4 viewProjection = projection * view * model;
+    int outside[6] = int[6](0, 0, 0, 0, 0, 0);
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner = vec3((i & 1) != 0 ? boundsMax.x : boundsMin.x,
+                           (i & 2) != 0 ? boundsMax.y : boundsMin.y,
+                           (i & 4) != 0 ? boundsMax.z : boundsMin.z);
+        vec4 clip = viewProjection * vec4(corner, 1.0);
+        if (clip.x < -clip.w) outside[0]++;
+        if (clip.x > clip.w) outside[1]++;
+        if (clip.y < -clip.w) outside[2]++;
+        if (clip.y > clip.w) outside[3]++;
+        if (clip.z < -clip.w) outside[4]++;
+        if (clip.z > clip.w) outside[5]++;
+    }
+    for (int p = 0; p < 6; ++p) {
+        if (outside[p] == 8) return true;
+    }
+    return false;
+}
+
+// Wszystkie czworokaty siatki kontrolnej odwrocone od kamery (uklad widoku)
+bool facingAway(vec3 points[16])
+{
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            vec3 p = points[i * 4 + j];
+            vec3 n = cross(points[(i + 1) * 4 + j] - p, points[i * 4 + j + 1] - p);
+            if (dot(n, -p) > 0.0) return false;
+        }
+    }
+    return true;
+}
 
 void main()
 {
     tcPos[gl_InvocationID] = vPos[gl_InvocationID];
+    tcUV[gl_InvocationID] = vUV[gl_InvocationID];
 
     if (gl_InvocationID == 0) {
-        gl_TessLevelOuter[0] = tessLevelOuter;
-        gl_TessLevelOuter[1] = tessLevelOuter;
-        gl_TessLevelOuter[2] = tessLevelOuter;
-        gl_TessLevelOuter[3] = tessLevelOuter;
-        gl_TessLevelInner[0] = tessLevelInner;
-        gl_TessLevelInner[1] = tessLevelInner;
+        mat4 model = vModel[0];
+        float strength = vWind[0].x * windStrength;
+        float phase = vWind[0].y;
+        tcModel = model;
+        tcNormalMatrix = vNormalMatrix[0];
+        tcWind = vec2(strength, phase);
+
+        if (!adaptiveTessellation) {
+            gl_TessLevelOuter[0] = tessMaxLevel;
+            gl_TessLevelOuter[1] = tessMaxLevel;
+            gl_TessLevelOuter[2] = tessMaxLevel;
+            gl_TessLevelOuter[3] = tessMaxLevel;
+            gl_TessLevelInner[0] = tessMaxLevel;
+            gl_TessLevelInner[1] = tessMaxLevel;
+            return;
+        }
+
+        // Poziom 0 na krawedzi - patch odrzucony przed generatorem prymitywow
+        if (outsideFrustum(model, strength)) {
+            gl_TessLevelOuter[0] = 0.0;
+            gl_TessLevelOuter[1] = 0.0;
+            gl_TessLevelOuter[2] = 0.0;
+            gl_TessLevelOuter[3] = 0.0;
+            return;
+        }
+
+        // Punkty kontrolne po wietrze, w ukladzie widoku
+        mat4 modelView = view * model;
+        vec3 points[16];
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                vec3 p = windDisplaced(vPos[i * 4 + j], vUV[i * 4 + j], strength, phase);
+                points[i * 4 + j] = vec3(modelView * vec4(p, 1.0));
+            }
+        }
+
+        if (backfaceCulling && facingAway(points)) {
+            gl_TessLevelOuter[0] = 0.0;
+            gl_TessLevelOuter[1] = 0.0;
+            gl_TessLevelOuter[2] = 0.0;
+            gl_TessLevelOuter[3] = 0.0;
+            return;
+        }
+
+        // Krawedzie quads: 0 - u=0, 1 - v=0, 2 - u=1, 3 - v=1 (punkt [i*4+j], i wzdluz u)
+        gl_TessLevelOuter[0] = edgeLevel(points[0], points[1], points[2], points[3]);
+        gl_TessLevelOuter[1] = edgeLevel(points[0], points[4], points[8], points[12]);
+        gl_TessLevelOuter[2] = edgeLevel(points[12], points[13], points[14], points[15]);
+        gl_TessLevelOuter[3] = edgeLevel(points[3], points[7], points[11], points[15]);
+        // Wnetrze: wzdluz u jak krawedzie v=0/v=1, wzdluz v jak u=0/u=1
+        gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+        gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
     }
 }
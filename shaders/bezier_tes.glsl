@@ -1,118 +1,113 @@
 #version 410 core
 
-layout (quads, equal_spacing, ccw) in;
+// Poziomy ulamkowe z adaptacyjnego TCS - plynna zmiana gestosci bez przeskokow
+layout (quads, fractional_even_spacing, ccw) in;
 
 in vec3 tcPos[];
+in vec2 tcUV[];
+patch in mat4 tcModel;
+patch in mat3 tcNormalMatrix;
+patch in vec2 tcWind;   // x - sila (z mnoznikiem), y - faza
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat3 normalMatrix;
-
-uniform float time;
-uniform float windStrength;
-uniform vec2 windDirection;
-
-// Funkcja Bernsteina
-float bernstein(int i, float t)
+// Ta sama glebokosc w pre-passie i przebiegu cieniowania (test GL_EQUAL)
+invariant gl_Position;
+
+// Dane klatki - wspolne dla wszystkich shaderow
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 fogColor;          // Mgla
+    float fogDensity;
+    float dayNightFactor;   // Dzien/Noc: 0.0 = noc, 1.0 = dzien
+    bool fogEnabled;
+    bool useBlinn;          // Phong vs Blinn
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    vec2 viewportSize;      // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+};
+
+// Parametry powierzchni (jak w bezier_tcs.glsl) - TES czyta tylko kierunek wiatru
+layout(std140) uniform SurfaceData {
+    vec2 windDirection;
+    float windStrength;
+    float tessMaxLevel;
+    float tessTriangleSize;
+    bool adaptiveTessellation;
+    bool backfaceCulling;
+};
+
+// Baza Bernsteina stopnia 3 i jej pochodna w jednym przejsciu
+void bernsteinBasis(float t, out vec4 basis, out vec4 derivative)
 {
     float mt = 1.0 - t;
-    if (i == 0) return mt * mt * mt;
-    if (i == 1) return 3.0 * mt * mt * t;
-    if (i == 2) return 3.0 * mt * t * t;
-    return t * t * t;
+    basis = vec4(mt * mt * mt, 3.0 * mt * mt * t, 3.0 * mt * t * t, t * t * t);
+    derivative = vec4(-3.0 * mt * mt, 3.0 * mt * mt - 6.0 * mt * t, 6.0 * mt * t - 3.0 * t * t, 3.0 * t * t);
 }
 
-// Pochodna funkcji Bernsteina
-float bernsteinDerivative(int i, float t)
+void main()
 {
-    float mt = 1.0 - t;
-    if (i == 0) return -3.0 * mt * mt;
-    if (i == 1) return 3.0 * mt * mt - 6.0 * mt * t;
-    if (i == 2) return 6.0 * mt * t - 3.0 * t * t;
-    return 3.0 * t * t;
-}
+    float u = gl_TessCoord.x;
+    float v = gl_TessCoord.y;
 
-vec3 evaluateBezier(float u, float v)
-{
+    // Pozycja i obie styczne z jednej petli po 16 punktach
+    vec4 bu, dbu, bv, dbv;
+    bernsteinBasis(u, bu, dbu);
+    bernsteinBasis(v, bv, dbv);
     vec3 pos = vec3(0.0);
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            float bu = bernstein(i, u);
-            float bv = bernstein(j, v);
-            pos += tcPos[i * 4 + j] * bu * bv;
-        }
-    }
-    return pos;
-}
-
-vec3 evaluateBezierDu(float u, float v)
-{
     vec3 du = vec3(0.0);
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            float dbu = bernsteinDerivative(i, u);
-            float bv = bernstein(j, v);
-            du += tcPos[i * 4 + j] * dbu * bv;
-        }
-    }
-    return du;
-}
-
-vec3 evaluateBezierDv(float u, float v)
-{
     vec3 dv = vec3(0.0);
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
-            float bu = bernstein(i, u);
-            float dbv = bernsteinDerivative(j, v);
-            dv += tcPos[i * 4 + j] * bu * dbv;
+            vec3 p = tcPos[i * 4 + j];
+            pos += p * (bu[i] * bv[j]);
+            du += p * (dbu[i] * bv[j]);
+            dv += p * (bu[i] * dbv[j]);
         }
     }
-    return dv;
-}
 
-void main()
-{
-    float u = gl_TessCoord.x;
-    float v = gl_TessCoord.y;
-
-    // Oblicz pozycje na powierzchni Beziera
-    vec3 pos = evaluateBezier(u, v);
+    // Globalne UV powierzchni z narozy platu
+    vec2 uvMin = tcUV[0];
+    vec2 uvMax = tcUV[15];
+    vec2 surfaceUV = mix(uvMin, uvMax, vec2(u, v));
+    float su = surfaceUV.x;
+    float sv = surfaceUV.y;
+    float strength = tcWind.x;
+    float phase = tcWind.y;
 
     // Animacja wiatru - sinusoidalna deformacja
     // Im dalej od krawedzi przymocowania (u=0), tym wieksza deformacja
     // Flaga jest w plaszczynnie XY, wiatr wygina ja w kierunku Z
-    float windEffect = u * u * windStrength;
-    float wave1 = sin(time * 2.5 + u * 5.0 + v * 2.0) * windEffect;
-    float wave2 = sin(time * 4.0 + u * 3.5 - v * 1.5) * windEffect * 0.4;
-    float wave3 = sin(time * 1.8 + u * 2.5 + v * 4.0) * windEffect * 0.25;
+    float windEffect = su * su * strength;
+    float wave1 = sin(time * 2.5 + phase + su * 5.0 + sv * 2.0) * windEffect;
+    float wave2 = sin(time * 4.0 + phase + su * 3.5 - sv * 1.5) * windEffect * 0.4;
+    float wave3 = sin(time * 1.8 + phase + su * 2.5 + sv * 4.0) * windEffect * 0.25;
 
     // Glowna deformacja w kierunku Z (w glab sceny)
     pos.z += (wave1 + wave2 + wave3) * windDirection.x;
     // Lekka deformacja w kierunku X (rozciaganie)
     pos.x += wave2 * 0.1 * windDirection.y;
 
-    // Oblicz normalna przez pochodne czesciowe
-    vec3 du = evaluateBezierDu(u, v);
-    vec3 dv = evaluateBezierDv(u, v);
-
-    // Zmodyfikuj pochodne dla animacji (dla poprawnych normali)
-    float dWave = cos(time * 2.5 + u * 5.0 + v * 2.0) * 5.0 * 2.0 * u * windStrength * windDirection.x;
-    du.z += dWave;
+    // Zmodyfikuj pochodne dla animacji (dla poprawnych normali); du platu
+    // odpowiada (uvMax.x - uvMin.x) jednostek globalnego u
+    float dWave = cos(time * 2.5 + phase + su * 5.0 + sv * 2.0) * 5.0 * 2.0 * su * strength * windDirection.x;
+    du.z += dWave * (uvMax.x - uvMin.x);
 
-    vec3 normal = normalize(cross(du, dv));
+    // Zdegenerowane platy (np. biegun czajnika) maja zerowa styczna
+    vec3 normal = cross(du, dv);
+    normal = dot(normal, normal) > 1e-12 ? normalize(normal) : vec3(0.0, 1.0, 0.0);
 
     // Transformacja do ukladu kamery
-    vec4 viewPos = view * model * vec4(pos, 1.0);
+    vec4 viewPos = view * tcModel * vec4(pos, 1.0);
     FragPos = viewPos.xyz;
-    Normal = normalize(normalMatrix * normal);
+    Normal = normalize(mat3(view) * (tcNormalMatrix * normal));
 
-    TexCoord = vec2(u, v);
+    TexCoord = surfaceUV;
 
     gl_Position = projection * viewPos;
 }
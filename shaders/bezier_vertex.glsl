@@ -1,10 +1,23 @@
 #version 410 core
 
+// Punkt kontrolny (wspolny dla platow) + dane egzemplarza powierzchni
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aUV;           // globalne UV powierzchni
+layout (location = 2) in mat4 aModel;        // 2..5
+layout (location = 6) in mat3 aNormalMatrix; // 6..8, w ukladzie swiata
+layout (location = 9) in vec2 aWind;         // x - sila, y - faza
 
 out vec3 vPos;
+out vec2 vUV;
+out mat4 vModel;
+out mat3 vNormalMatrix;
+out vec2 vWind;
 
 void main()
 {
     vPos = aPos;
+    vUV = aUV;
+    vModel = aModel;
+    vNormalMatrix = aNormalMatrix;
+    vWind = aWind;
 }
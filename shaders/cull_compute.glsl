@@ -0,0 +1,62 @@
+#version 430 core
+
+// Frustum culling obiektow statycznych na GPU (sciezka GPU-driven, GL 4.3+).
+// Watek na obiekt: test AABB z 6 plaszczyznami, a widoczny obiekt dopisuje
+// swoj indeks do zakresu swojej siatki i zwieksza instanceCount jej komendy.
+layout(local_size_x = 64) in;
+
+// Uklad std430 - patrz GpuObject
+struct ObjectData {
+    mat4 model;
+    vec4 normalMatrix[3];   // kolumny mat3, w ukladzie swiata
+    vec4 color;
+    vec4 boundsMin;         // AABB w ukladzie swiata, w = indeks siatki
+    vec4 boundsMax;
+};
+
+// Uklad wymagany przez glMultiDrawElementsIndirect
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;      // poczatek zakresu siatki w VisibleObjects
+};
+
+layout(std430, binding = 0) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+
+layout(std430, binding = 1) buffer DrawCommandBuffer {
+    DrawCommand commands[];
+};
+
+layout(std430, binding = 2) writeonly buffer VisibleObjects {
+    uint visibleObjects[];
+};
+
+uniform vec4 frustumPlanes[6];   // normalne do wewnatrz
+uniform int objectCount;
+uniform bool cullingEnabled;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(objectCount)) return;
+
+    ObjectData object = objects[index];
+    if (cullingEnabled) {
+        vec3 center = (object.boundsMin.xyz + object.boundsMax.xyz) * 0.5;
+        vec3 extent = (object.boundsMax.xyz - object.boundsMin.xyz) * 0.5;
+        for (int i = 0; i < 6; i++) {
+            vec4 plane = frustumPlanes[i];
+            float dist = dot(plane.xyz, center) + plane.w;
+            float radius = dot(abs(plane.xyz), extent);
+            if (dist + radius < 0.0) return;
+        }
+    }
+
+    uint mesh = uint(object.boundsMin.w);
+    uint slot = atomicAdd(commands[mesh].instanceCount, 1u);
+    visibleObjects[commands[mesh].baseInstance + slot] = index;
+}
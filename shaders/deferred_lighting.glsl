@@ -0,0 +1,278 @@
+#version 410 core
+
+// Przebieg oswietlenia trybu odroczonego: raz na piksel ekranu, ten sam model
+// swiatel co fragment.glsl/bezier_fragment.glsl (listy swiatel klastrow),
+// potem ambient dnia/nocy i mgla. Pozycja w ukladzie kamery odtwarzana
+// z glebokosci i macierzy projekcji.
+// Warianty programu (shader_variants.h): USE_BLINN, USE_FOG
+
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+// Swiatlo punktowe (uklad std140 - patrz PointLightStd140)
+struct PointLight {
+    vec3 position;  // w ukladzie kamery
+    float constant;
+    vec3 ambient;
+    float linear;
+    vec3 diffuse;
+    float quadratic;
+    vec3 specular;
+};
+
+// Reflektor (spotlight, uklad std140 - patrz SpotLightStd140)
+struct SpotLight {
+    vec3 position;      // w ukladzie kamery
+    float constant;
+    vec3 direction;     // w ukladzie kamery
+    float linear;
+    vec3 ambient;
+    float quadratic;
+    vec3 diffuse;
+    float cutOff;       // cos kata wewnetrznego
+    vec3 specular;
+    float outerCutOff;  // cos kata zewnetrznego
+};
+
+// Siatka klastrow - jak CLUSTER_X/Y/Z w light_clusters.h
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+
+// Dane klatki - wspolne dla wszystkich shaderow
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 fogColor;          // Mgla
+    float fogDensity;
+    float dayNightFactor;   // Dzien/Noc: 0.0 = noc, 1.0 = dzien
+    bool fogEnabled;
+    bool useBlinn;          // Phong vs Blinn
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    vec2 viewportSize;      // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+};
+
+// Swiatla w buforze tekstury: punktowe po 4 texele, za nimi reflektory po 5
+uniform samplerBuffer clusterLights;
+// Rekord klastra: x - poczatek listy, y - liczba punktowych | reflektorow << 16
+uniform usamplerBuffer clusterRecords;
+// Listy indeksow swiatel klastrow (punktowe, potem reflektory)
+uniform usamplerBuffer clusterLightIndices;
+
+// Mapy cieni dwoch pierwszych reflektorow i swiatel punktowych (shadow_maps.h)
+layout(std140) uniform ShadowData {
+    mat4 spotShadowMatrices[2]; // uklad kamery -> [0,1] mapy reflektora
+    mat4 viewToWorld;           // obrot ukladu kamery do swiata (kierunki kostek)
+    vec4 pointShadowDepth;      // (a, b) obu kostek: glebokosc = a + b / os glowna
+    int shadowedPointLights;    // swiatla 0..n-1 maja mapy (0 - cienie wylaczone)
+    int shadowedSpotLights;
+    float shadowNormalBias;     // przesuniecie wzdluz normalnej na jednostke odleglosci
+};
+uniform sampler2DArrayShadow spotShadowMaps;
+uniform samplerCubeArrayShadow pointShadowMaps;
+
+// G-buffer (uklad - patrz gbuffer_fragment.glsl)
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gSpecular;
+uniform sampler2D gDepth;
+
+// Parametry powierzchni odczytane z G-buffera
+struct Surface {
+    vec3 ambient;    // mnozone przez light.ambient
+    vec3 diffuse;    // mnozone przez light.diffuse * diff
+    vec3 specular;   // mnozone przez light.specular * spec
+    float shininess;
+};
+
+vec3 decodeNormal(vec2 e)
+{
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// Symetryczna perspektywa: z z glebokosci, x/y z NDC
+vec3 viewPosition(vec2 uv, float depth)
+{
+    vec3 ndc = vec3(uv, depth) * 2.0 - 1.0;
+    float z = -projection[3][2] / (ndc.z + projection[2][2]);
+    return vec3(ndc.x * -z / projection[0][0], ndc.y * -z / projection[1][1], z);
+}
+
+PointLight fetchPointLight(int index)
+{
+    int base = index * 4;
+    vec4 t0 = texelFetch(clusterLights, base);
+    vec4 t1 = texelFetch(clusterLights, base + 1);
+    vec4 t2 = texelFetch(clusterLights, base + 2);
+    vec4 t3 = texelFetch(clusterLights, base + 3);
+    return PointLight(t0.xyz, t0.w, t1.xyz, t1.w, t2.xyz, t2.w, t3.xyz);
+}
+
+SpotLight fetchSpotLight(int index)
+{
+    int base = numPointLights * 4 + index * 5;
+    vec4 t0 = texelFetch(clusterLights, base);
+    vec4 t1 = texelFetch(clusterLights, base + 1);
+    vec4 t2 = texelFetch(clusterLights, base + 2);
+    vec4 t3 = texelFetch(clusterLights, base + 3);
+    vec4 t4 = texelFetch(clusterLights, base + 4);
+    return SpotLight(t0.xyz, t0.w, t1.xyz, t1.w, t2.xyz, t2.w, t3.xyz, t3.w, t4.xyz, t4.w);
+}
+
+// Klaster fragmentu: kafelek ekranu i plasterek glebokosci (wykladniczy)
+int clusterIndex(vec3 fragPos)
+{
+    float slice = floor(log(max(-fragPos.z, 1e-4)) * clusterDepthScale - clusterDepthBias);
+    int z = int(clamp(slice, 0.0, float(CLUSTER_Z - 1)));
+    vec2 tile = clamp(floor(gl_FragCoord.xy / viewportSize * vec2(CLUSTER_X, CLUSTER_Y)),
+                      vec2(0.0), vec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+    return (z * CLUSTER_Y + int(tile.y)) * CLUSTER_X + int(tile.x);
+}
+
+float specularTerm(vec3 lightDir, vec3 normal, vec3 viewDir, float shininess)
+{
+#ifdef USE_BLINN
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    return pow(max(dot(normal, halfwayDir), 0.0), shininess * 2.0);
+#else
+    vec3 reflectDir = reflect(-lightDir, normal);
+    return pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+#endif
+}
+
+// Punkt przesuniety wzdluz normalnej w strone swiatla - bez "tradziku" cieni
+vec3 shadowOffsetPosition(vec3 lightPos, vec3 fragPos, vec3 normal)
+{
+    vec3 toLight = lightPos - fragPos;
+    float side = dot(normal, toLight) < 0.0 ? -1.0 : 1.0;
+    return fragPos + normal * side * shadowNormalBias * length(toLight);
+}
+
+// 1 - oswietlony, 0 - w cieniu (porownanie sprzetowe z filtrowaniem 2x2)
+float pointShadow(int index, vec3 lightPos, vec3 fragPos, vec3 normal)
+{
+    if(index >= shadowedPointLights) return 1.0;
+    vec3 direction = mat3(viewToWorld) * (shadowOffsetPosition(lightPos, fragPos, normal) - lightPos);
+    vec3 axes = abs(direction);
+    float majorAxis = max(axes.x, max(axes.y, axes.z));
+    vec2 depthCoeff = index == 0 ? pointShadowDepth.xy : pointShadowDepth.zw;
+    return texture(pointShadowMaps, vec4(direction, float(index)), depthCoeff.x + depthCoeff.y / majorAxis);
+}
+
+float spotShadow(int index, vec3 lightPos, vec3 fragPos, vec3 normal)
+{
+    if(index >= shadowedSpotLights) return 1.0;
+    vec4 coord = spotShadowMatrices[index] * vec4(shadowOffsetPosition(lightPos, fragPos, normal), 1.0);
+    if(coord.w <= 0.0) return 1.0;   // za reflektorem - i tak poza stozkiem
+    coord.xyz /= coord.w;
+    return texture(spotShadowMaps, vec4(coord.xy, float(index), coord.z));
+}
+
+vec3 calcPointLight(PointLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    float diff = max(dot(normal, lightDir), 0.0);
+    float spec = specularTerm(lightDir, normal, viewDir, surface.shininess);
+
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance +
+                               light.quadratic * distance * distance);
+
+    vec3 ambient = light.ambient * surface.ambient;
+    vec3 diffuse = light.diffuse * diff * surface.diffuse;
+    vec3 specular = light.specular * spec * surface.specular;
+
+    return (ambient + (diffuse + specular) * shadow) * attenuation;
+}
+
+vec3 calcSpotLight(SpotLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+
+    float diff = max(dot(normal, lightDir), 0.0);
+    float spec = specularTerm(lightDir, normal, viewDir, surface.shininess);
+
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance +
+                               light.quadratic * distance * distance);
+
+    vec3 ambient = light.ambient * surface.ambient;
+    vec3 diffuse = light.diffuse * diff * surface.diffuse;
+    vec3 specular = light.specular * spec * surface.specular;
+
+    return (ambient + (diffuse + specular) * intensity * shadow) * attenuation;
+}
+
+void main()
+{
+    float depth = texture(gDepth, TexCoord).r;
+    if(depth >= 1.0) discard;   // tlo - zostaje kolor czyszczenia
+
+    vec4 albedo = texture(gAlbedo, TexCoord);
+    vec4 normalData = texture(gNormal, TexCoord);
+    vec4 specularData = texture(gSpecular, TexCoord);
+
+    vec3 baseColor = albedo.rgb;
+    Surface surface;
+    surface.ambient = baseColor * albedo.a;
+    surface.diffuse = baseColor * normalData.b;
+    surface.specular = specularData.rgb;
+    surface.shininess = specularData.a * 255.0;
+
+    vec3 fragPos = viewPosition(TexCoord, depth);
+    vec3 norm = decodeNormal(normalData.rg);
+    vec3 viewDir = normalize(-fragPos);
+
+    vec3 result = vec3(0.0);
+
+    // Tylko swiatla z listy klastra piksela
+    uvec2 record = texelFetch(clusterRecords, clusterIndex(fragPos)).xy;
+    int first = int(record.x);
+    int pointCount = int(record.y & 0xFFFFu);
+    int spotCount = int(record.y >> 16);
+
+    for(int i = 0; i < pointCount; i++) {
+        int light = int(texelFetch(clusterLightIndices, first + i).r);
+        PointLight pointLight = fetchPointLight(light);
+        result += calcPointLight(pointLight, surface, norm, fragPos, viewDir,
+                                 pointShadow(light, pointLight.position, fragPos, norm));
+    }
+
+    for(int i = 0; i < spotCount; i++) {
+        int light = int(texelFetch(clusterLightIndices, first + pointCount + i).r);
+        SpotLight spotLight = fetchSpotLight(light);
+        result += calcSpotLight(spotLight, surface, norm, fragPos, viewDir,
+                                spotShadow(light, spotLight.position, fragPos, norm));
+    }
+
+    // Dzien/Noc ambient
+    vec3 dayAmbient = vec3(0.3);
+    vec3 nightAmbient = vec3(0.05);
+    vec3 ambientLight = mix(nightAmbient, dayAmbient, dayNightFactor);
+    result += baseColor * ambientLight;
+
+    // Mgla (exponential fog)
+#ifdef USE_FOG
+    float dist = length(fragPos);
+    float fogFactor = exp(-fogDensity * dist);
+    fogFactor = clamp(fogFactor, 0.0, 1.0);
+    vec3 currentFogColor = mix(vec3(0.1, 0.1, 0.15), fogColor, dayNightFactor);
+    result = mix(currentFogColor, result, fogFactor);
+#endif
+
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,7 @@
+#version 410 core
+
+// Przebieg glebokosci (mapy cieni) - cel nie ma bufora koloru,
+// zapisywana jest tylko glebokosc z rasteryzacji
+void main()
+{
+}
@@ -0,0 +1,36 @@
+#version 410 core
+
+// Pre-pass glebokosci i mapy cieni: sama pozycja, bez normalnych i UV
+layout (location = 0) in vec3 aPos;
+
+// Ta sama glebokosc co w vertex.glsl (test GL_EQUAL) - to samo wyrazenie
+invariant gl_Position;
+
+// Dane klatki - wspolne dla wszystkich shaderow
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 fogColor;          // Mgla
+    float fogDensity;
+    float dayNightFactor;   // Dzien/Noc: 0.0 = noc, 1.0 = dzien
+    bool fogEnabled;
+    bool useBlinn;          // Phong vs Blinn
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    vec2 viewportSize;      // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+};
+
+// Ten sam blok co w vertex.glsl - normalMatrix nieuzywana
+layout(std140) uniform ObjectData {
+    mat4 model;
+    mat3 normalMatrix;
+};
+
+void main()
+{
+    vec4 viewPos = view * model * vec4(aPos, 1.0);
+    gl_Position = projection * viewPos;
+}
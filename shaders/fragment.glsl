@@ -3,74 +3,158 @@
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
+in vec4 InstanceColor;  // a > 0 - kolor instancji zamiast material.objectColor
 
 out vec4 FragColor;
 
-// Material
-struct Material {
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float shininess;
-};
+// Warianty programu (shader_variants.h) - cechy wybierane przy kompilacji:
+// USE_BLINN, USE_FOG, USE_CHECKERBOARD, USE_TEXTURE
 
-// Swiatlo punktowe
+// Swiatlo punktowe (uklad std140 - patrz PointLightStd140)
 struct PointLight {
     vec3 position;  // w ukladzie kamery
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
     float constant;
+    vec3 ambient;
     float linear;
+    vec3 diffuse;
     float quadratic;
+    vec3 specular;
 };
 
-// Reflektor (spotlight)
+// Reflektor (spotlight, uklad std140 - patrz SpotLightStd140)
 struct SpotLight {
     vec3 position;      // w ukladzie kamery
-    vec3 direction;     // w ukladzie kamery
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
     float constant;
+    vec3 direction;     // w ukladzie kamery
     float linear;
+    vec3 ambient;
     float quadratic;
+    vec3 diffuse;
     float cutOff;       // cos kata wewnetrznego
+    vec3 specular;
     float outerCutOff;  // cos kata zewnetrznego
 };
 
-#define MAX_POINT_LIGHTS 4
-#define MAX_SPOT_LIGHTS 4
+// Siatka klastrow - jak CLUSTER_X/Y/Z w light_clusters.h
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+
+// Dane klatki - wspolne dla wszystkich shaderow
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 fogColor;          // Mgla
+    float fogDensity;
+    float dayNightFactor;   // Dzien/Noc: 0.0 = noc, 1.0 = dzien
+    bool fogEnabled;
+    bool useBlinn;          // Phong vs Blinn
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    vec2 viewportSize;      // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+};
 
-uniform Material material;
-uniform int numPointLights;
-uniform int numSpotLights;
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform SpotLight spotLights[MAX_SPOT_LIGHTS];
+// Swiatla w buforze tekstury: punktowe po 4 texele, za nimi reflektory po 5
+uniform samplerBuffer clusterLights;
+// Rekord klastra: x - poczatek listy, y - liczba punktowych | reflektorow << 16
+uniform usamplerBuffer clusterRecords;
+// Listy indeksow swiatel klastrow (punktowe, potem reflektory)
+uniform usamplerBuffer clusterLightIndices;
+
+// Mapy cieni dwoch pierwszych reflektorow i swiatel punktowych (shadow_maps.h)
+layout(std140) uniform ShadowData {
+    mat4 spotShadowMatrices[2]; // uklad kamery -> [0,1] mapy reflektora
+    mat4 viewToWorld;           // obrot ukladu kamery do swiata (kierunki kostek)
+    vec4 pointShadowDepth;      // (a, b) obu kostek: glebokosc = a + b / os glowna
+    int shadowedPointLights;    // swiatla 0..n-1 maja mapy (0 - cienie wylaczone)
+    int shadowedSpotLights;
+    float shadowNormalBias;     // przesuniecie wzdluz normalnej na jednostke odleglosci
+};
+uniform sampler2DArrayShadow spotShadowMaps;
+uniform samplerCubeArrayShadow pointShadowMaps;
 
-// Mgla
-uniform bool fogEnabled;
-uniform float fogDensity;
-uniform vec3 fogColor;
+// Material, kolor obiektu i szachownica dla podlogi
+layout(std140) uniform MaterialData {
+    vec3 ambient;
+    float shininess;
+    vec3 diffuse;
+    bool useTexture;
+    vec3 specular;
+    bool useCheckerboard;
+    vec3 objectColor;
+    float checkerScale;
+    vec3 checkerColor1;
+    bool useFlagColors;
+    vec3 checkerColor2;
+    vec3 flagColor1;
+    vec3 flagColor2;
+} material;
 
-// Dzien/Noc
-uniform float dayNightFactor; // 0.0 = noc, 1.0 = dzien
+uniform sampler2D textureDiffuse;
 
-// Phong vs Blinn
-uniform bool useBlinn;
+PointLight fetchPointLight(int index)
+{
+    int base = index * 4;
+    vec4 t0 = texelFetch(clusterLights, base);
+    vec4 t1 = texelFetch(clusterLights, base + 1);
+    vec4 t2 = texelFetch(clusterLights, base + 2);
+    vec4 t3 = texelFetch(clusterLights, base + 3);
+    return PointLight(t0.xyz, t0.w, t1.xyz, t1.w, t2.xyz, t2.w, t3.xyz);
+}
 
-// Kolor obiektu
-uniform vec3 objectColor;
-uniform bool useTexture;
-uniform sampler2D textureDiffuse;
+SpotLight fetchSpotLight(int index)
+{
+    int base = numPointLights * 4 + index * 5;
+    vec4 t0 = texelFetch(clusterLights, base);
+    vec4 t1 = texelFetch(clusterLights, base + 1);
+    vec4 t2 = texelFetch(clusterLights, base + 2);
+    vec4 t3 = texelFetch(clusterLights, base + 3);
+    vec4 t4 = texelFetch(clusterLights, base + 4);
+    return SpotLight(t0.xyz, t0.w, t1.xyz, t1.w, t2.xyz, t2.w, t3.xyz, t3.w, t4.xyz, t4.w);
+}
+
+// Klaster fragmentu: kafelek ekranu i plasterek glebokosci (wykladniczy)
+int clusterIndex(vec3 fragPos)
+{
+    float slice = floor(log(max(-fragPos.z, 1e-4)) * clusterDepthScale - clusterDepthBias);
+    int z = int(clamp(slice, 0.0, float(CLUSTER_Z - 1)));
+    vec2 tile = clamp(floor(gl_FragCoord.xy / viewportSize * vec2(CLUSTER_X, CLUSTER_Y)),
+                      vec2(0.0), vec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+    return (z * CLUSTER_Y + int(tile.y)) * CLUSTER_X + int(tile.x);
+}
 
-// Szachownica dla podlogi
-uniform bool useCheckerboard;
-uniform float checkerScale;
-uniform vec3 checkerColor1;
-uniform vec3 checkerColor2;
+// Punkt przesuniety wzdluz normalnej w strone swiatla - bez "tradziku" cieni
+vec3 shadowOffsetPosition(vec3 lightPos, vec3 fragPos, vec3 normal)
+{
+    vec3 toLight = lightPos - fragPos;
+    float side = dot(normal, toLight) < 0.0 ? -1.0 : 1.0;
+    return fragPos + normal * side * shadowNormalBias * length(toLight);
+}
 
-vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+// 1 - oswietlony, 0 - w cieniu (porownanie sprzetowe z filtrowaniem 2x2)
+float pointShadow(int index, vec3 lightPos, vec3 fragPos, vec3 normal)
+{
+    if(index >= shadowedPointLights) return 1.0;
+    vec3 direction = mat3(viewToWorld) * (shadowOffsetPosition(lightPos, fragPos, normal) - lightPos);
+    vec3 axes = abs(direction);
+    float majorAxis = max(axes.x, max(axes.y, axes.z));
+    vec2 depthCoeff = index == 0 ? pointShadowDepth.xy : pointShadowDepth.zw;
+    return texture(pointShadowMaps, vec4(direction, float(index)), depthCoeff.x + depthCoeff.y / majorAxis);
+}
+
+float spotShadow(int index, vec3 lightPos, vec3 fragPos, vec3 normal)
+{
+    if(index >= shadowedSpotLights) return 1.0;
+    vec4 coord = spotShadowMatrices[index] * vec4(shadowOffsetPosition(lightPos, fragPos, normal), 1.0);
+    if(coord.w <= 0.0) return 1.0;   // za reflektorem - i tak poza stozkiem
+    coord.xyz /= coord.w;
+    return texture(spotShadowMaps, vec4(coord.xy, float(index), coord.z));
+}
+
+vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
 {
     vec3 lightDir = normalize(light.position - fragPos);
 
@@ -78,14 +162,13 @@ vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
 
     // Specular (Phong lub Blinn)
-    float spec = 0.0;
-    if(useBlinn) {
-        vec3 halfwayDir = normalize(lightDir + viewDir);
-        spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess * 2.0);
-    } else {
-        vec3 reflectDir = reflect(-lightDir, normal);
-        spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    }
+#ifdef USE_BLINN
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess * 2.0);
+#else
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+#endif
 
     // Zanikanie
     float distance = length(light.position - fragPos);
@@ -96,10 +179,10 @@ vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     vec3 diffuse = light.diffuse * diff * material.diffuse;
     vec3 specular = light.specular * spec * material.specular;
 
-    return (ambient + diffuse + specular) * attenuation;
+    return (ambient + (diffuse + specular) * shadow) * attenuation;
 }
 
-vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
 {
     vec3 lightDir = normalize(light.position - fragPos);
 
@@ -112,14 +195,13 @@ vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
 
     // Specular (Phong lub Blinn)
-    float spec = 0.0;
-    if(useBlinn) {
-        vec3 halfwayDir = normalize(lightDir + viewDir);
-        spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess * 2.0);
-    } else {
-        vec3 reflectDir = reflect(-lightDir, normal);
-        spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    }
+#ifdef USE_BLINN
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess * 2.0);
+#else
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+#endif
 
     // Zanikanie
     float distance = length(light.position - fragPos);
@@ -130,7 +212,7 @@ vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     vec3 diffuse = light.diffuse * diff * material.diffuse;
     vec3 specular = light.specular * spec * material.specular;
 
-    return (ambient + (diffuse + specular) * intensity) * attenuation;
+    return (ambient + (diffuse + specular) * intensity * shadow) * attenuation;
 }
 
 void main()
@@ -138,31 +220,42 @@ void main()
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(-FragPos); // W ukladzie kamery, kamera jest w (0,0,0)
 
-    vec3 baseColor;
-    if(useCheckerboard) {
-        // Wzor szachownicy na podstawie wspolrzednych UV
-        float u = TexCoord.x * checkerScale;
-        float v = TexCoord.y * checkerScale;
-        int checkX = int(floor(u));
-        int checkY = int(floor(v));
-        bool isEven = ((checkX + checkY) % 2) == 0;
-        baseColor = isEven ? checkerColor1 : checkerColor2;
-    } else if(useTexture) {
-        baseColor = texture(textureDiffuse, TexCoord).rgb;
-    } else {
-        baseColor = objectColor;
-    }
+#if defined(USE_CHECKERBOARD)
+    // Wzor szachownicy na podstawie wspolrzednych UV
+    float u = TexCoord.x * material.checkerScale;
+    float v = TexCoord.y * material.checkerScale;
+    int checkX = int(floor(u));
+    int checkY = int(floor(v));
+    bool isEven = ((checkX + checkY) % 2) == 0;
+    vec3 baseColor = isEven ? material.checkerColor1 : material.checkerColor2;
+#elif defined(USE_TEXTURE)
+    vec3 baseColor = texture(textureDiffuse, TexCoord).rgb;
+#else
+    vec3 baseColor = InstanceColor.a > 0.0 ? InstanceColor.rgb : material.objectColor;
+#endif
 
     vec3 result = vec3(0.0);
 
+    // Tylko swiatla z listy klastra fragmentu
+    uvec2 record = texelFetch(clusterRecords, clusterIndex(FragPos)).xy;
+    int first = int(record.x);
+    int pointCount = int(record.y & 0xFFFFu);
+    int spotCount = int(record.y >> 16);
+
     // Swiatla punktowe
-    for(int i = 0; i < numPointLights && i < MAX_POINT_LIGHTS; i++) {
-        result += calcPointLight(pointLights[i], norm, FragPos, viewDir);
+    for(int i = 0; i < pointCount; i++) {
+        int light = int(texelFetch(clusterLightIndices, first + i).r);
+        PointLight pointLight = fetchPointLight(light);
+        result += calcPointLight(pointLight, norm, FragPos, viewDir,
+                                 pointShadow(light, pointLight.position, FragPos, norm));
     }
 
     // Reflektory
-    for(int i = 0; i < numSpotLights && i < MAX_SPOT_LIGHTS; i++) {
-        result += calcSpotLight(spotLights[i], norm, FragPos, viewDir);
+    for(int i = 0; i < spotCount; i++) {
+        int light = int(texelFetch(clusterLightIndices, first + pointCount + i).r);
+        SpotLight spotLight = fetchSpotLight(light);
+        result += calcSpotLight(spotLight, norm, FragPos, viewDir,
+                                spotShadow(light, spotLight.position, FragPos, norm));
     }
 
     // Zastosuj kolor obiektu
@@ -175,15 +268,15 @@ void main()
     result += baseColor * ambientLight;
 
     // Mgla (exponential fog)
-    if(fogEnabled) {
-        float dist = length(FragPos);
-        float fogFactor = exp(-fogDensity * dist);
-        fogFactor = clamp(fogFactor, 0.0, 1.0);
-
-        // Kolor mgly zalezy od dnia/nocy
-        vec3 currentFogColor = mix(vec3(0.1, 0.1, 0.15), fogColor, dayNightFactor);
-        result = mix(currentFogColor, result, fogFactor);
-    }
+#ifdef USE_FOG
+    float dist = length(FragPos);
+    float fogFactor = exp(-fogDensity * dist);
+    fogFactor = clamp(fogFactor, 0.0, 1.0);
+
+    // Kolor mgly zalezy od dnia/nocy
+    vec3 currentFogColor = mix(vec3(0.1, 0.1, 0.15), fogColor, dayNightFactor);
+    result = mix(currentFogColor, result, fogFactor);
+#endif
 
     FragColor = vec4(result, 1.0);
 }
@@ -0,0 +1,70 @@
+#version 410 core
+
+// Przebieg geometrii trybu odroczonego (deferred) dla obiektow glownego,
+// instancyjnego i GPU-driven shadera. Zamiast oswietlenia zapisuje G-buffer:
+//   0 (RGBA8)    - kolor bazowy, a = wspolczynnik ambient materialu
+//   1 (RGB10_A2) - normalna w ukladzie kamery (oktaedr), b = wspolczynnik diffuse
+//   2 (RGBA8)    - kolor specular, a = shininess / 255
+// Skladowe ambient/diffuse materialu zapisywane jako skalar (materialy sa szare).
+// Warianty programu (shader_variants.h): USE_CHECKERBOARD, USE_TEXTURE
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+in vec4 InstanceColor;  // a > 0 - kolor instancji zamiast material.objectColor
+
+layout (location = 0) out vec4 gAlbedoOut;
+layout (location = 1) out vec4 gNormalOut;
+layout (location = 2) out vec4 gSpecularOut;
+
+// Material, kolor obiektu i szachownica dla podlogi
+layout(std140) uniform MaterialData {
+    vec3 ambient;
+    float shininess;
+    vec3 diffuse;
+    bool useTexture;
+    vec3 specular;
+    bool useCheckerboard;
+    vec3 objectColor;
+    float checkerScale;
+    vec3 checkerColor1;
+    bool useFlagColors;
+    vec3 checkerColor2;
+    vec3 flagColor1;
+    vec3 flagColor2;
+} material;
+
+uniform sampler2D textureDiffuse;
+
+// Normalna na oktaedr rozwiniety do kwadratu [0,1]^2
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xy;
+    if(n.z < 0.0) {
+        e = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return e * 0.5 + 0.5;
+}
+
+void main()
+{
+#if defined(USE_CHECKERBOARD)
+    // Wzor szachownicy na podstawie wspolrzednych UV
+    float u = TexCoord.x * material.checkerScale;
+    float v = TexCoord.y * material.checkerScale;
+    int checkX = int(floor(u));
+    int checkY = int(floor(v));
+    bool isEven = ((checkX + checkY) % 2) == 0;
+    vec3 baseColor = isEven ? material.checkerColor1 : material.checkerColor2;
+#elif defined(USE_TEXTURE)
+    vec3 baseColor = texture(textureDiffuse, TexCoord).rgb;
+#else
+    vec3 baseColor = InstanceColor.a > 0.0 ? InstanceColor.rgb : material.objectColor;
+#endif
+
+    // Jak w fragment.glsl: caly wynik oswietlenia mnozony przez kolor bazowy
+    gAlbedoOut = vec4(baseColor, material.ambient.x);
+    gNormalOut = vec4(encodeNormal(normalize(Normal)), material.diffuse.x, 0.0);
+    gSpecularOut = vec4(material.specular * baseColor, material.shininess / 255.0);
+}
@@ -0,0 +1,63 @@
+#version 430 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+// Indeks obiektu z VisibleObjects (divisor 1, przesuniety przez baseInstance komendy)
+layout (location = 3) in uint aObjectIndex;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+out vec4 InstanceColor;
+// Ta sama glebokosc w pre-passie i przebiegu cieniowania (test GL_EQUAL)
+invariant gl_Position;
+
+// Uklad std430 - patrz GpuObject i cull_compute.glsl
+struct ObjectData {
+    mat4 model;
+    vec4 normalMatrix[3];
+    vec4 color;
+    vec4 boundsMin;
+    vec4 boundsMax;
+};
+
+layout(std430, binding = 0) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+
+// Dane klatki - wspolne dla wszystkich shaderow
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 fogColor;          // Mgla
+    float fogDensity;
+    float dayNightFactor;   // Dzien/Noc: 0.0 = noc, 1.0 = dzien
+    bool fogEnabled;
+    bool useBlinn;          // Phong vs Blinn
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    vec2 viewportSize;      // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+};
+
+void main()
+{
+    ObjectData object = objects[aObjectIndex];
+    mat3 normalMatrix = mat3(object.normalMatrix[0].xyz, object.normalMatrix[1].xyz,
+                             object.normalMatrix[2].xyz);
+
+    vec4 viewPos = view * object.model * vec4(aPos, 1.0);
+    FragPos = viewPos.xyz;
+
+    // Jak w instanced_vertex.glsl - normalna ze swiata do ukladu kamery
+    Normal = normalize(mat3(view) * (normalMatrix * aNormal));
+
+    TexCoord = aTexCoord;
+    InstanceColor = object.color;
+
+    gl_Position = projection * viewPos;
+}
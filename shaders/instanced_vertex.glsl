@@ -0,0 +1,49 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+// Dane instancji (patrz InstanceData) - divisor 1
+layout (location = 3) in mat4 aModel;         // 3..6
+layout (location = 7) in mat3 aNormalMatrix;  // 7..9, w ukladzie swiata
+layout (location = 10) in vec4 aColor;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+out vec4 InstanceColor;
+// Ta sama glebokosc w pre-passie i przebiegu cieniowania (test GL_EQUAL)
+invariant gl_Position;
+
+// Dane klatki - wspolne dla wszystkich shaderow
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 fogColor;          // Mgla
+    float fogDensity;
+    float dayNightFactor;   // Dzien/Noc: 0.0 = noc, 1.0 = dzien
+    bool fogEnabled;
+    bool useBlinn;          // Phong vs Blinn
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    vec2 viewportSize;      // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+};
+
+void main()
+{
+    vec4 viewPos = view * aModel * vec4(aPos, 1.0);
+    FragPos = viewPos.xyz;
+
+    // Kamera nie skaluje, wiec mat3(view) wystarcza do przeniesienia
+    // normalnej ze swiata do ukladu kamery
+    Normal = normalize(mat3(view) * (aNormalMatrix * aNormal));
+
+    TexCoord = aTexCoord;
+    InstanceColor = aColor;
+
+    gl_Position = projection * viewPos;
+}
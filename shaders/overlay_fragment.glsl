@@ -0,0 +1,15 @@
+#version 410 core
+
+in vec2 TexCoord;
+in vec4 Color;
+
+out vec4 FragColor;
+
+uniform sampler2D fontAtlas;
+
+void main()
+{
+    float coverage = texture(fontAtlas, TexCoord).r;
+    if (coverage < 0.5) discard;
+    FragColor = Color;
+}
@@ -0,0 +1,18 @@
+#version 410 core
+
+layout (location = 0) in vec2 aPos;      // piksele, (0,0) = lewy gorny rog
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+uniform vec2 screenSize;
+
+void main()
+{
+    vec2 ndc = aPos / screenSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Color = aColor;
+}
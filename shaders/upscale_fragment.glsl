@@ -0,0 +1,29 @@
+#version 410 core
+
+// Skalowanie celu dynamicznej rozdzielczosci na ekran: filtr dwuliniowy
+// z wyostrzeniem (unsharp mask z czterech sasiadow w odleglosci teksela
+// zrodla). Wynik ograniczony do zakresu sasiadow - bez obwodek na krawedziach.
+
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D sceneColor;
+uniform vec2 sourceTexel;   // 1 / rozmiar celu sceny
+uniform float sharpness;    // 0 = czysty filtr dwuliniowy
+
+void main()
+{
+    vec3 center = texture(sceneColor, TexCoord).rgb;
+    vec3 north = texture(sceneColor, TexCoord + vec2(0.0, sourceTexel.y)).rgb;
+    vec3 south = texture(sceneColor, TexCoord - vec2(0.0, sourceTexel.y)).rgb;
+    vec3 east = texture(sceneColor, TexCoord + vec2(sourceTexel.x, 0.0)).rgb;
+    vec3 west = texture(sceneColor, TexCoord - vec2(sourceTexel.x, 0.0)).rgb;
+
+    vec3 blurred = (north + south + east + west) * 0.25;
+    vec3 sharpened = center + (center - blurred) * sharpness;
+
+    vec3 lowest = min(center, min(min(north, south), min(east, west)));
+    vec3 highest = max(center, max(max(north, south), max(east, west)));
+    FragColor = vec4(clamp(sharpened, lowest, highest), 1.0);
+}
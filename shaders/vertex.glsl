@@ -7,11 +7,33 @@ layout (location = 2) in vec2 aTexCoord;
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
+out vec4 InstanceColor;
+// Ta sama glebokosc w pre-passie i przebiegu cieniowania (test GL_EQUAL)
+invariant gl_Position;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat3 normalMatrix;
+// Dane klatki - wspolne dla wszystkich shaderow
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 fogColor;          // Mgla
+    float fogDensity;
+    float dayNightFactor;   // Dzien/Noc: 0.0 = noc, 1.0 = dzien
+    bool fogEnabled;
+    bool useBlinn;          // Phong vs Blinn
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    vec2 viewportSize;      // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+};
+
+// Transformacja wezla - zakres bufora dynamicznego wskazany przed rysowaniem.
+// Macierz normalnych w ukladzie swiata (ten sam zakres dla kamery i map cieni).
+layout(std140) uniform ObjectData {
+    mat4 model;
+    mat3 normalMatrix;
+};
 
 void main()
 {
@@ -19,11 +41,12 @@ void main()
     vec4 viewPos = view * model * vec4(aPos, 1.0);
     FragPos = viewPos.xyz;
 
-    // Poprawne przeksztalcenie wektora normalnego
-    // normalMatrix = transpose(inverse(mat3(view * model)))
-    Normal = normalize(normalMatrix * aNormal);
+    // Kamera nie skaluje, wiec mat3(view) wystarcza do przeniesienia
+    // normalnej ze swiata do ukladu kamery
+    Normal = normalize(mat3(view) * (normalMatrix * aNormal));
 
     TexCoord = aTexCoord;
+    InstanceColor = vec4(0.0); // Kolor z materialu
 
     gl_Position = projection * viewPos;
 }
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ============== BENCHMARK (SKRYPTOWANA SCIEZKA KAMERY) ==============
+// Plik scenariusza - jedna komenda na linie, '#' rozpoczyna komentarz:
+//   duration <s>             dlugosc przebiegu
+//   step <s>                 staly krok czasu symulacji (domyslnie 1/60)
+//   warmup <klatki>          klatki pomijane w statystykach
+//   <t> camera <0|1|2>       przelaczenie kamery
+//   <t> object <x> <z> <kat> klatka kluczowa toru ruchomego obiektu
+//   <t> tess <poziom>        maksymalny poziom tessellation flagi
+//   <t> tessadaptive <on|off> poziomy z rozmiaru na ekranie (off - staly poziom)
+//   <t> tesspixels <px>      docelowa dlugosc krawedzi trojkata flagi
+//   <t> fog <on|off>         mgla
+//   <t> fogdensity <d>       gestosc mgly
+//   <t> daynight <0..1>      pora dnia
+//   <t> wind <sila>          sila wiatru
+//   <t> blinn <on|off>       Phong/Blinn
+//   <t> culling <on|off>     frustum culling
+//   <t> lod <on|off>         wybor poziomow LOD
+//   <t> deferred <on|off>    tryb odroczony (G-buffer) zamiast forward
+//   <t> shadows <on|off>     mapy cieni swiatel sceny
+//   <t> prepass <on|off>     pre-pass glebokosci, cieniowanie z GL_EQUAL
+//   <t> sort <on|off>        nieprzezroczyste od najblizszych kamery
+//   <t> statesort <on|off>   kolejka rysowania sortowana wg stanu GL
+//   <t> dynres <on|off>      skala rozdzielczosci z regulatora czasu klatki
+//   <t> renderscale <s>      stala skala rozdzielczosci (bez regulatora)
+//   <t> targetms <ms>        docelowy czas GPU klatki regulatora
+// Pozycja obiektu jest interpolowana liniowo miedzy klatkami kluczowymi.
+// Argumenty sprawdzane sa przy wczytywaniu (blad z plik:linia) - zdarzenia
+// niosa gotowe wartosci, odtwarzanie niczego juz nie parsuje.
+
+struct TimelineEvent {
+    float time;
+    std::string command;
+    std::vector<std::string> args;
+    float value = 0.0f;   // argument liczbowy albo 1/0 dla on/off
+};
+
+// Liczba bez smieci na koncu (std::stof przyjmuje "1.5abc" i rzuca wyjatki)
+inline bool parseTimelineNumber(const std::string& text, float& value) {
+    const char* begin = text.c_str();
+    char* end = NULL;
+    float parsed = std::strtof(begin, &end);
+    if (end == begin || *end != '\0' || !std::isfinite(parsed)) return false;
+    value = parsed;
+    return true;
+}
+
+enum TimelineArgument { TIMELINE_ARG_NUMBER, TIMELINE_ARG_SWITCH, TIMELINE_ARG_UNKNOWN };
+
+// Rodzaj argumentu komend z listy wyzej
+inline TimelineArgument timelineArgument(const std::string& command) {
+    static const char* numbers[] = {"camera", "tess", "tesspixels", "fogdensity", "daynight", "wind",
+                                    "renderscale", "targetms"};
+    static const char* switches[] = {"tessadaptive", "fog", "blinn", "culling", "lod", "deferred",
+                                     "shadows", "prepass", "sort", "statesort", "dynres"};
+    for (const char* name : numbers) {
+        if (command == name) return TIMELINE_ARG_NUMBER;
+    }
+    for (const char* name : switches) {
+        if (command == name) return TIMELINE_ARG_SWITCH;
+    }
+    return TIMELINE_ARG_UNKNOWN;
+}
+
+struct PathKey {
+    float time;
+    glm::vec3 position;
+    float angle;
+};
+
+class BenchmarkTimeline {
+public:
+    float duration;
+    float step;
+    int warmupFrames;
+    std::vector<TimelineEvent> events;
+    std::vector<PathKey> path;
+
+    BenchmarkTimeline() : duration(10.0f), step(1.0f / 60.0f), warmupFrames(30), nextEvent(0) {}
+
+    bool loadFromFile(const std::string& filePath) {
+        std::ifstream file(filePath);
+        if (!file.is_open()) {
+            std::cerr << "Nie mozna otworzyc scenariusza: " << filePath << std::endl;
+            return false;
+        }
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) line.erase(comment);
+
+            std::istringstream stream(line);
+            std::string first;
+            if (!(stream >> first)) continue;
+
+            if (first == "duration" || first == "step" || first == "warmup") {
+                std::string text;
+                float value = 0.0f;
+                if (!(stream >> text) || !parseTimelineNumber(text, value) || value < 0.0f ||
+                    (first == "warmup" && value != std::floor(value))) {
+                    std::cerr << filePath << ":" << lineNumber << ": niepoprawna wartosc " << first << " '"
+                              << text << "'" << std::endl;
+                    return false;
+                }
+                if (first == "duration") duration = value;
+                if (first == "step") step = value;
+                if (first == "warmup") warmupFrames = (int)value;
+                continue;
+            }
+
+            TimelineEvent event;
+            if (!parseTimelineNumber(first, event.time)) {
+                std::cerr << filePath << ":" << lineNumber << ": oczekiwano czasu, jest '"
+                          << first << "'" << std::endl;
+                return false;
+            }
+            if (!(stream >> event.command)) {
+                std::cerr << filePath << ":" << lineNumber << ": brak komendy" << std::endl;
+                return false;
+            }
+            std::string arg;
+            while (stream >> arg) event.args.push_back(arg);
+
+            if (event.command == "object") {
+                if (event.args.size() != 3) {
+                    std::cerr << filePath << ":" << lineNumber << ": object <x> <z> <kat>" << std::endl;
+                    return false;
+                }
+                float x = 0.0f, z = 0.0f, angle = 0.0f;
+                if (!parseTimelineNumber(event.args[0], x) || !parseTimelineNumber(event.args[1], z) ||
+                    !parseTimelineNumber(event.args[2], angle)) {
+                    std::cerr << filePath << ":" << lineNumber << ": object - oczekiwano liczb" << std::endl;
+                    return false;
+                }
+                PathKey key;
+                key.time = event.time;
+                key.position = glm::vec3(x, 0.5f, z);
+                key.angle = angle;
+                path.push_back(key);
+                continue;
+            }
+
+            TimelineArgument kind = timelineArgument(event.command);
+            if (kind == TIMELINE_ARG_UNKNOWN) {
+                std::cerr << filePath << ":" << lineNumber << ": nieznana komenda '" << event.command << "'"
+                          << std::endl;
+                return false;
+            }
+            bool valid = event.args.size() == 1;
+            if (valid && kind == TIMELINE_ARG_NUMBER) {
+                valid = parseTimelineNumber(event.args[0], event.value);
+            } else if (valid) {
+                const std::string& arg = event.args[0];
+                valid = arg == "on" || arg == "off" || arg == "1" || arg == "0";
+                event.value = (arg == "on" || arg == "1") ? 1.0f : 0.0f;
+            }
+            if (!valid) {
+                std::cerr << filePath << ":" << lineNumber << ": " << event.command
+                          << (kind == TIMELINE_ARG_NUMBER ? " <liczba>" : " <on|off>") << std::endl;
+                return false;
+            }
+            events.push_back(event);
+        }
+
+        auto byTime = [](const auto& a, const auto& b) { return a.time < b.time; };
+        std::stable_sort(events.begin(), events.end(), byTime);
+        std::stable_sort(path.begin(), path.end(), byTime);
+        if (step <= 0.0f || duration <= 0.0f) {
+            std::cerr << filePath << ": duration i step musza byc dodatnie" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int frameCount() const { return (int)std::ceil(duration / step); }
+
+    // Wywoluje apply dla kazdego zdarzenia o czasie <= time (kazde tylko raz)
+    template <typename ApplyFn>
+    void advance(float time, ApplyFn&& apply) {
+        while (nextEvent < events.size() && events[nextEvent].time <= time) {
+            apply(events[nextEvent]);
+            ++nextEvent;
+        }
+    }
+
+    // Pozycja i kat ruchomego obiektu w chwili time; false gdy brak toru
+    bool samplePath(float time, glm::vec3& position, float& angle) const {
+        if (path.empty()) return false;
+        if (time <= path.front().time) {
+            position = path.front().position;
+            angle = path.front().angle;
+            return true;
+        }
+        for (size_t i = 1; i < path.size(); ++i) {
+            if (time <= path[i].time) {
+                const PathKey& a = path[i - 1];
+                const PathKey& b = path[i];
+                float t = (b.time > a.time) ? (time - a.time) / (b.time - a.time) : 1.0f;
+                position = glm::mix(a.position, b.position, t);
+                angle = a.angle + (b.angle - a.angle) * t;
+                return true;
+            }
+        }
+        position = path.back().position;
+        angle = path.back().angle;
+        return true;
+    }
+
+private:
+    size_t nextEvent;
+};
+
+// ============== POMIAR CZASOW KLATEK ==============
+struct TimingSummary {
+    double min, median, p99, mean, max;
+};
+
+inline TimingSummary summarizeTimings(std::vector<double> values) {
+    TimingSummary s = {0.0, 0.0, 0.0, 0.0, 0.0};
+    if (values.empty()) return s;
+    std::sort(values.begin(), values.end());
+    // Percentyl metoda najblizszego rangi
+    auto percentile = [&values](double p) {
+        size_t rank = (size_t)std::ceil(p * values.size());
+        return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+    s.min = values.front();
+    s.max = values.back();
+    s.median = percentile(0.5);
+    s.p99 = percentile(0.99);
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    s.mean = sum / values.size();
+    return s;
+}
+
+// Czas CPU klatki z zegara, czas GPU z pary znacznikow GL_TIMESTAMP
+// (glQueryCounter) - nie GL_TIME_ELAPSED, bo wewnatrz klatki zakresy
+// profilera maja wlasne zapytania GL_TIME_ELAPSED, a aktywne moze byc tylko
+// jedno. Zapytania kraza w pierscieniu, wynik odczytywany jest kilka klatek
+// pozniej, wiec pomiar nie wymusza synchronizacji CPU z GPU.
+class FrameTimer {
+public:
+    std::vector<double> cpuMs;
+    std::vector<double> gpuMs;
+
+    FrameTimer() : frameIndex(0), pending{} {}
+
+    void init() {
+        glGenQueries(QUERY_RING * 2, queries);
+    }
+
+    void beginFrame() {
+        int slot = frameIndex % QUERY_RING;
+        if (pending[slot]) collect(slot);
+        cpuStart = std::chrono::steady_clock::now();
+        glQueryCounter(queries[slot * 2], GL_TIMESTAMP);
+    }
+
+    void endFrame() {
+        int slot = frameIndex % QUERY_RING;
+        glQueryCounter(queries[slot * 2 + 1], GL_TIMESTAMP);
+        auto cpuEnd = std::chrono::steady_clock::now();
+        cpuMs.push_back(std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count());
+        gpuMs.push_back(0.0);
+        pending[slot] = true;
+        pendingFrame[slot] = frameIndex;
+        ++frameIndex;
+    }
+
+    // Odbiera pozostale wyniki po ostatniej klatce
+    void finish() {
+        for (int i = 0; i < QUERY_RING; ++i) {
+            if (pending[i]) collect(i);
+        }
+    }
+
+    void destroy() {
+        glDeleteQueries(QUERY_RING * 2, queries);
+    }
+
+private:
+    static const int QUERY_RING = 4;
+
+    void collect(int slot) {
+        GLuint64 beginNs = 0, endNs = 0;
+        glGetQueryObjectui64v(queries[slot * 2], GL_QUERY_RESULT, &beginNs);
+        glGetQueryObjectui64v(queries[slot * 2 + 1], GL_QUERY_RESULT, &endNs);
+        gpuMs[pendingFrame[slot]] = endNs > beginNs ? (endNs - beginNs) / 1.0e6 : 0.0;
+        pending[slot] = false;
+    }
+
+    int frameIndex;
+    GLuint queries[QUERY_RING * 2];     // para znacznikow (poczatek, koniec) na klatke
+    bool pending[QUERY_RING];
+    int pendingFrame[QUERY_RING];
+    std::chrono::steady_clock::time_point cpuStart;
+};
+
+inline std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c < 0x20) continue;
+        out += c;
+    }
+    return out;
+}
+
+inline void writeTimingSummary(std::ostream& out, const char* name, const TimingSummary& s) {
+    out << "  \"" << name << "\": {\"min\": " << s.min << ", \"median\": " << s.median
+        << ", \"p99\": " << s.p99 << ", \"mean\": " << s.mean << ", \"max\": " << s.max << "}";
+}
+
+// Raport JSON - statystyki bez klatek rozgrzewki + surowe czasy wszystkich klatek.
+// width/height - rozdzielczosc wyjscia, renderSizes - rozmiar celu przebiegow 3D
+// kazdej klatki (dynamiczna rozdzielczosc; skala klatki = wysokosc celu / height)
+inline void writeBenchmarkJson(std::ostream& out, const FrameTimer& timer, int warmupFrames,
+                               int width, int height, const std::vector<glm::ivec2>& renderSizes) {
+    int warmup = std::min<int>(warmupFrames, (int)timer.cpuMs.size());
+    std::vector<double> cpu(timer.cpuMs.begin() + warmup, timer.cpuMs.end());
+    std::vector<double> gpu(timer.gpuMs.begin() + warmup, timer.gpuMs.end());
+
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version = (const char*)glGetString(GL_VERSION);
+
+    out << "{\n";
+    out << "  \"renderer\": \"" << jsonEscape(renderer ? renderer : "") << "\",\n";
+    out << "  \"gl_version\": \"" << jsonEscape(version ? version : "") << "\",\n";
+    out << "  \"resolution\": [" << width << ", " << height << "],\n";
+    // Skala jednakowa w obu osiach - najmniejszy/najwiekszy cel wg wysokosci
+    glm::ivec2 smallest(width, height), largest(width, height);
+    if (!renderSizes.empty()) smallest = largest = renderSizes[0];
+    for (const glm::ivec2& size : renderSizes) {
+        if (size.y < smallest.y) smallest = size;
+        if (size.y > largest.y) largest = size;
+    }
+    out << "  \"render_resolution\": {\"min\": [" << smallest.x << ", " << smallest.y << "], \"max\": ["
+        << largest.x << ", " << largest.y << "]},\n";
+    out << "  \"frames\": " << timer.cpuMs.size() << ",\n";
+    out << "  \"warmup_frames\": " << warmup << ",\n";
+    writeTimingSummary(out, "cpu_ms", summarizeTimings(cpu));
+    out << ",\n";
+    writeTimingSummary(out, "gpu_ms", summarizeTimings(gpu));
+    out << ",\n";
+    out << "  \"per_frame_fields\": [\"cpu_ms\", \"gpu_ms\", \"scale\"],\n";
+    out << "  \"per_frame\": [";
+    for (size_t i = 0; i < timer.cpuMs.size(); ++i) {
+        double scale = i < renderSizes.size() ? renderSizes[i].y / (double)std::max(height, 1) : 1.0;
+        if (i) out << ", ";
+        out << "[" << timer.cpuMs[i] << ", " << timer.gpuMs[i] << ", " << scale << "]";
+    }
+    out << "]\n";
+    out << "}\n";
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "culling.h"
+#include "gl_state.h"
+#include "profiler.h"
+#include "transforms.h"
+
+// ============== POWIERZCHNIE BEZIERA (WIELE PLATOW) ==============
+// Platy bikubiczne opisane indeksami 16 punktow kontrolnych we wspolnej
+// tablicy (jak w pliku Utah teapot) - sasiednie platy dziela punkty krawedzi.
+// Punkt kontrolny niesie globalne UV powierzchni: TES interpoluje je z narozy
+// platu, wiec wiatr i wzor flagi ciagna sie przez granice platow, a TCS liczy
+// te same przesuniecia dla wspolnych punktow (zgodne poziomy na krawedziach).
+// Wszystkie egzemplarze (macierz, sila i faza wiatru) rysowane sa jednym
+// glDrawElementsInstanced(GL_PATCHES) - bez zmiany shadera i VAO miedzy nimi.
+
+struct PatchVertex {
+    glm::vec3 position;
+    glm::vec2 uv;   // globalne UV powierzchni
+};
+
+struct PatchInstance {
+    glm::mat4 model;
+    glm::mat3 normalMatrix;   // w ukladzie swiata - shader mnozy przez mat3(view)
+    glm::vec2 wind;           // x - sila (0 = powierzchnia sztywna), y - faza
+};
+
+const unsigned int PATCH_ATTRIB_POSITION = 0;
+const unsigned int PATCH_ATTRIB_UV = 1;
+const unsigned int PATCH_ATTRIB_MODEL = 2;    // 4 kolumny: 2..5
+const unsigned int PATCH_ATTRIB_NORMAL = 6;   // 3 kolumny: 6..8
+const unsigned int PATCH_ATTRIB_WIND = 9;
+
+// Maksymalne wychylenie z fal TES (|wave1 + wave2 + wave3| <= 1.65) na jednostke sily
+const glm::vec3 PATCH_WIND_EXTENT(0.04f, 0.0f, 1.65f);
+
+class BezierSurface {
+public:
+    std::vector<PatchVertex> controlPoints;
+    std::vector<unsigned int> patchIndices;   // 16 na plat, [i * 4 + j], i wzdluz u
+    std::vector<PatchInstance> instances;
+
+    BezierSurface() : VAO(0), controlVBO(0), EBO(0), instanceVBO(0), capacity(0), dirty(false) {}
+
+    // Format Utah teapot: liczba platow, tyle linii po 16 indeksow (od 1),
+    // liczba punktow, tyle linii "x, y, z"; przecinki opcjonalne.
+    // Plik nie niesie UV - powierzchnia przeznaczona do rysowania bez wiatru.
+    bool loadFromFile(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Nie mozna otworzyc pliku platow: " << path << std::endl;
+            return false;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        std::string text = content.str();
+        std::replace(text.begin(), text.end(), ',', ' ');
+        std::istringstream in(text);
+
+        size_t patchCount = 0, pointCount = 0;
+        std::vector<unsigned int> indices;
+        if (!(in >> patchCount)) return fail(path);
+        indices.resize(patchCount * 16);
+        for (unsigned int& index : indices) {
+            if (!(in >> index) || index == 0) return fail(path);
+            --index;
+        }
+        if (!(in >> pointCount)) return fail(path);
+        std::vector<PatchVertex> points(pointCount);
+        for (PatchVertex& point : points) {
+            if (!(in >> point.position.x >> point.position.y >> point.position.z)) return fail(path);
+            point.uv = glm::vec2(0.0f);
+        }
+        for (unsigned int index : indices) {
+            if (index >= pointCount) return fail(path);
+        }
+
+        controlPoints = points;
+        patchIndices = indices;
+        std::cout << "Platy Beziera " << path << ": " << patchCount << " platow, " << pointCount << " punktow"
+                  << std::endl;
+        return true;
+    }
+
+    // Siatka (3 * patchesU + 1) x (3 * patchesV + 1) punktow, punkt [i * pointsV + j]
+    // (i wzdluz u); kazde 4x4 z zakladka 1 to plat. UV rowne polozeniu w siatce.
+    void setGrid(const std::vector<glm::vec3>& points, int patchesU, int patchesV) {
+        int pointsU = 3 * patchesU + 1, pointsV = 3 * patchesV + 1;
+        controlPoints.resize(points.size());
+        for (int i = 0; i < pointsU; ++i) {
+            for (int j = 0; j < pointsV; ++j) {
+                PatchVertex& point = controlPoints[i * pointsV + j];
+                point.position = points[i * pointsV + j];
+                point.uv = glm::vec2((float)i / (pointsU - 1), (float)j / (pointsV - 1));
+            }
+        }
+        patchIndices.clear();
+        for (int a = 0; a < patchesU; ++a) {
+            for (int b = 0; b < patchesV; ++b) {
+                for (int i = 0; i < 4; ++i) {
+                    for (int j = 0; j < 4; ++j) patchIndices.push_back((3 * a + i) * pointsV + 3 * b + j);
+                }
+            }
+        }
+    }
+
+    // Bufory punktow i indeksow + VAO z atrybutami instancji
+    void upload() {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &controlVBO);
+        glGenBuffers(1, &EBO);
+        glGenBuffers(1, &instanceVBO);
+        bindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, controlVBO);
+        glBufferData(GL_ARRAY_BUFFER, controlPoints.size() * sizeof(PatchVertex), controlPoints.data(),
+                     GL_STATIC_DRAW);
+        glVertexAttribPointer(PATCH_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(PatchVertex),
+                              (void*)offsetof(PatchVertex, position));
+        glEnableVertexAttribArray(PATCH_ATTRIB_POSITION);
+        glVertexAttribPointer(PATCH_ATTRIB_UV, 2, GL_FLOAT, GL_FALSE, sizeof(PatchVertex),
+                              (void*)offsetof(PatchVertex, uv));
+        glEnableVertexAttribArray(PATCH_ATTRIB_UV);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, patchIndices.size() * sizeof(unsigned int), patchIndices.data(),
+                     GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        const GLsizei stride = sizeof(PatchInstance);
+        for (unsigned int i = 0; i < 4; ++i) {
+            glVertexAttribPointer(PATCH_ATTRIB_MODEL + i, 4, GL_FLOAT, GL_FALSE, stride,
+                                  (void*)(offsetof(PatchInstance, model) + i * sizeof(glm::vec4)));
+        }
+        for (unsigned int i = 0; i < 3; ++i) {
+            glVertexAttribPointer(PATCH_ATTRIB_NORMAL + i, 3, GL_FLOAT, GL_FALSE, stride,
+                                  (void*)(offsetof(PatchInstance, normalMatrix) + i * sizeof(glm::vec3)));
+        }
+        glVertexAttribPointer(PATCH_ATTRIB_WIND, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PatchInstance, wind));
+        for (unsigned int attrib = PATCH_ATTRIB_MODEL; attrib <= PATCH_ATTRIB_WIND; ++attrib) {
+            glEnableVertexAttribArray(attrib);
+            glVertexAttribDivisor(attrib, 1);
+        }
+
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        dirty = true;
+    }
+
+    size_t add(const glm::mat4& model, const glm::vec2& wind) {
+        PatchInstance instance;
+        instance.model = model;
+        instance.normalMatrix = cofactorNormalMatrix(glm::mat3(model));
+        instance.wind = wind;
+        instances.push_back(instance);
+        dirty = true;
+        return instances.size() - 1;
+    }
+
+    // Bufor instancji wysylany tylko, gdy macierz faktycznie sie zmienila
+    void setModel(size_t index, const glm::mat4& model, const glm::mat3& normalMatrix) {
+        PatchInstance& instance = instances[index];
+        if (std::memcmp(&instance.model, &model, sizeof(model)) == 0) return;
+        instance.model = model;
+        instance.normalMatrix = normalMatrix;
+        dirty = true;
+    }
+
+    // Granice punktow kontrolnych (powierzchnia lezy w ich otoczce) + zapas na wiatr
+    AABB bounds(float windStrength) const {
+        AABB box = emptyAABB();
+        for (const PatchVertex& point : controlPoints) {
+            box.min = glm::min(box.min, point.position);
+            box.max = glm::max(box.max, point.position);
+        }
+        box.min -= PATCH_WIND_EXTENT * windStrength;
+        box.max += PATCH_WIND_EXTENT * windStrength;
+        return box;
+    }
+
+    size_t patchCount() const { return patchIndices.size() / 16; }
+
+    unsigned int vertexArray() const { return VAO; }
+
+    // Wszystkie platy wszystkich egzemplarzy; shader i uniformy ustawia wywolujacy
+    void draw() {
+        if (instances.empty() || patchIndices.empty()) return;
+        if (dirty) {
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            if (instances.size() > capacity) {
+                glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(PatchInstance), instances.data(),
+                             GL_DYNAMIC_DRAW);
+                capacity = instances.size();
+            } else {
+                glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(PatchInstance), instances.data());
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            countUniformUpload();
+            dirty = false;
+        }
+        bindVertexArray(VAO);
+        glPatchParameteri(GL_PATCH_VERTICES, 16);
+        glDrawElementsInstanced(GL_PATCHES, (GLsizei)patchIndices.size(), GL_UNSIGNED_INT, (void*)0,
+                                (GLsizei)instances.size());
+        countStateChange();
+        countDrawCall();
+    }
+
+    void destroy() {
+        deleteVertexArray(VAO);
+        glDeleteBuffers(1, &controlVBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteBuffers(1, &instanceVBO);
+        controlVBO = EBO = instanceVBO = 0;
+        capacity = 0;
+    }
+
+private:
+    bool fail(const std::string& path) {
+        std::cerr << "Bledny plik platow: " << path << std::endl;
+        return false;
+    }
+
+    unsigned int VAO, controlVBO, EBO, instanceVBO;
+    size_t capacity;
+    bool dirty;
+};
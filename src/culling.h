@@ -0,0 +1,276 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ============== FRUSTUM CULLING + BVH ==============
+// Prostopadlosciany otaczajace (AABB) obiektow w ukladzie swiata trzymane
+// w drzewie BVH. Zapytanie odrzuca cale poddrzewa poza frustum, a poddrzewa
+// w calosci wewnatrz przyjmuje bez dalszych testow. Obiekty ruchome
+// aktualizowane sa przez refit liscia i jego przodkow (bez przebudowy).
+
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+inline AABB emptyAABB() {
+    AABB box;
+    box.min = glm::vec3(FLT_MAX);
+    box.max = glm::vec3(-FLT_MAX);
+    return box;
+}
+
+inline AABB mergeAABB(const AABB& a, const AABB& b) {
+    AABB box;
+    box.min = glm::min(a.min, b.min);
+    box.max = glm::max(a.max, b.max);
+    return box;
+}
+
+inline bool sameAABB(const AABB& a, const AABB& b) {
+    return a.min == b.min && a.max == b.max;
+}
+
+// Granice z pozycji wierzcholkow (pierwsze 3 floaty, stride w floatach)
+inline AABB computeBounds(const float* vertices, size_t vertexCount, size_t stride) {
+    AABB box = emptyAABB();
+    for (size_t i = 0; i < vertexCount; ++i) {
+        glm::vec3 p(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]);
+        box.min = glm::min(box.min, p);
+        box.max = glm::max(box.max, p);
+    }
+    return box;
+}
+
+// AABB po przeksztalceniu (Arvo): srodek przez macierz, polowki przez |M|
+inline AABB transformAABB(const AABB& box, const glm::mat4& m) {
+    glm::vec3 center = (box.min + box.max) * 0.5f;
+    glm::vec3 extent = (box.max - box.min) * 0.5f;
+    glm::vec3 worldCenter = glm::vec3(m * glm::vec4(center, 1.0f));
+    glm::vec3 worldExtent = glm::abs(glm::vec3(m[0])) * extent.x +
+                            glm::abs(glm::vec3(m[1])) * extent.y +
+                            glm::abs(glm::vec3(m[2])) * extent.z;
+    AABB result;
+    result.min = worldCenter - worldExtent;
+    result.max = worldCenter + worldExtent;
+    return result;
+}
+
+enum FrustumTest {
+    FRUSTUM_OUTSIDE = 0,
+    FRUSTUM_INTERSECT = 1,
+    FRUSTUM_INSIDE = 2
+};
+
+class Frustum {
+public:
+    Frustum() {
+        for (int i = 0; i < 8; ++i) {
+            nx[i] = ny[i] = nz[i] = 0.0f;
+            d[i] = 1.0f;
+        }
+    }
+
+    // Plaszczyzny z macierzy projection * view (Gribb/Hartmann), normalne do wewnatrz.
+    // Plaszczyzny 6 i 7 to wypelnienie do dwoch rejestrow SSE - nigdy nie odrzucaja.
+    void extract(const glm::mat4& viewProjection) {
+        const glm::mat4& m = viewProjection;
+        glm::vec4 row[4];
+        for (int i = 0; i < 4; ++i) row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+        glm::vec4 planes[6] = {
+            row[3] + row[0], row[3] - row[0],   // lewa, prawa
+            row[3] + row[1], row[3] - row[1],   // dolna, gorna
+            row[3] + row[2], row[3] - row[2],   // bliska, daleka
+        };
+        for (int i = 0; i < 6; ++i) {
+            float length = glm::length(glm::vec3(planes[i]));
+            nx[i] = planes[i].x / length;
+            ny[i] = planes[i].y / length;
+            nz[i] = planes[i].z / length;
+            d[i] = planes[i].w / length;
+        }
+    }
+
+    // Plaszczyzna i (0..5) jako (normalna, d) - np. dla cullingu na GPU
+    glm::vec4 plane(int i) const {
+        return glm::vec4(nx[i], ny[i], nz[i], d[i]);
+    }
+
+    FrustumTest classify(const AABB& box) const {
+        float cx = (box.min.x + box.max.x) * 0.5f, ex = (box.max.x - box.min.x) * 0.5f;
+        float cy = (box.min.y + box.max.y) * 0.5f, ey = (box.max.y - box.min.y) * 0.5f;
+        float cz = (box.min.z + box.max.z) * 0.5f, ez = (box.max.z - box.min.z) * 0.5f;
+#if defined(__SSE2__)
+        // 4 plaszczyzny na rejestr: odleglosc srodka i "promien" pudelka wzdluz normalnej
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 vcx = _mm_set1_ps(cx), vcy = _mm_set1_ps(cy), vcz = _mm_set1_ps(cz);
+        __m128 vex = _mm_set1_ps(ex), vey = _mm_set1_ps(ey), vez = _mm_set1_ps(ez);
+        int outside = 0, intersect = 0;
+        for (int half = 0; half < 8; half += 4) {
+            __m128 px = _mm_loadu_ps(nx + half), py = _mm_loadu_ps(ny + half), pz = _mm_loadu_ps(nz + half);
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, vcx), _mm_mul_ps(py, vcy)),
+                                     _mm_add_ps(_mm_mul_ps(pz, vcz), _mm_loadu_ps(d + half)));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, px), vex),
+                                                  _mm_mul_ps(_mm_andnot_ps(signMask, py), vey)),
+                                       _mm_mul_ps(_mm_andnot_ps(signMask, pz), vez));
+            outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+            intersect |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(dist, radius), _mm_setzero_ps()));
+        }
+        if (outside) return FRUSTUM_OUTSIDE;
+        return intersect ? FRUSTUM_INTERSECT : FRUSTUM_INSIDE;
+#else
+        FrustumTest result = FRUSTUM_INSIDE;
+        for (int i = 0; i < 6; ++i) {
+            float dist = nx[i] * cx + ny[i] * cy + nz[i] * cz + d[i];
+            float radius = std::fabs(nx[i]) * ex + std::fabs(ny[i]) * ey + std::fabs(nz[i]) * ez;
+            if (dist + radius < 0.0f) return FRUSTUM_OUTSIDE;
+            if (dist - radius < 0.0f) result = FRUSTUM_INTERSECT;
+        }
+        return result;
+#endif
+    }
+
+private:
+    // Plaszczyzny w ukladzie SoA - jedna skladowa dla wszystkich plaszczyzn
+    float nx[8], ny[8], nz[8], d[8];
+};
+
+class Bvh {
+public:
+    // Kazdy wezel obejmuje ciagly zakres objectOrder[first, first + count)
+    struct Node {
+        AABB bounds;
+        int left, right;   // -1 w lisciu
+        int parent;
+        int first, count;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<AABB> objectBounds;
+    unsigned int nodesTested;   // wezly sprawdzone w ostatnim zapytaniu
+
+    Bvh() : nodesTested(0) {}
+
+    void build(const std::vector<AABB>& bounds) {
+        objectBounds = bounds;
+        nodes.clear();
+        objectOrder.resize(bounds.size());
+        leafOf.assign(bounds.size(), -1);
+        for (size_t i = 0; i < bounds.size(); ++i) objectOrder[i] = (int)i;
+        if (bounds.empty()) return;
+        nodes.reserve(2 * bounds.size() / LEAF_SIZE + 1);
+        buildNode(-1, 0, (int)bounds.size());
+    }
+
+    // Nowe granice obiektu - poprawia lisc i przodkow, konczy gdy granice sie nie zmieniaja
+    void refit(int object, const AABB& bounds) {
+        if (sameAABB(objectBounds[object], bounds)) return;
+        objectBounds[object] = bounds;
+
+        int index = leafOf[object];
+        Node& leaf = nodes[index];
+        leaf.bounds = emptyAABB();
+        for (int i = leaf.first; i < leaf.first + leaf.count; ++i) {
+            leaf.bounds = mergeAABB(leaf.bounds, objectBounds[objectOrder[i]]);
+        }
+        for (index = leaf.parent; index >= 0; index = nodes[index].parent) {
+            Node& node = nodes[index];
+            AABB merged = mergeAABB(nodes[node.left].bounds, nodes[node.right].bounds);
+            if (sameAABB(merged, node.bounds)) break;
+            node.bounds = merged;
+        }
+    }
+
+    // visible(obiekt) dla kazdego obiektu przecinajacego frustum
+    template <typename VisibleFn>
+    void query(const Frustum& frustum, VisibleFn&& visible) {
+        nodesTested = 0;
+        if (nodes.empty()) return;
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty()) {
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+            ++nodesTested;
+
+            FrustumTest test = frustum.classify(node.bounds);
+            if (test == FRUSTUM_OUTSIDE) continue;
+            if (test == FRUSTUM_INSIDE) {
+                // Cale poddrzewo widoczne - bez testowania potomkow
+                for (int i = node.first; i < node.first + node.count; ++i) visible(objectOrder[i]);
+            } else if (node.left < 0) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    int object = objectOrder[i];
+                    if (node.count == 1 || frustum.classify(objectBounds[object]) != FRUSTUM_OUTSIDE) {
+                        visible(object);
+                    }
+                }
+            } else {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+        }
+    }
+
+private:
+    static const int LEAF_SIZE = 4;
+
+    // Podzial po medianie srodkow wzdluz najdluzszej osi
+    int buildNode(int parent, int first, int count) {
+        int index = (int)nodes.size();
+        nodes.push_back(Node());
+        Node node;
+        node.parent = parent;
+        node.first = first;
+        node.count = count;
+        node.left = node.right = -1;
+
+        node.bounds = emptyAABB();
+        AABB centroids = emptyAABB();
+        for (int i = first; i < first + count; ++i) {
+            const AABB& box = objectBounds[objectOrder[i]];
+            node.bounds = mergeAABB(node.bounds, box);
+            glm::vec3 center = (box.min + box.max) * 0.5f;
+            centroids.min = glm::min(centroids.min, center);
+            centroids.max = glm::max(centroids.max, center);
+        }
+
+        if (count <= LEAF_SIZE) {
+            for (int i = first; i < first + count; ++i) leafOf[objectOrder[i]] = index;
+            nodes[index] = node;
+            return index;
+        }
+
+        glm::vec3 size = centroids.max - centroids.min;
+        int axis = (size.x > size.y && size.x > size.z) ? 0 : (size.y > size.z ? 1 : 2);
+        int half = count / 2;
+        const std::vector<AABB>& boxes = objectBounds;
+        std::nth_element(objectOrder.begin() + first, objectOrder.begin() + first + half,
+                         objectOrder.begin() + first + count,
+                         [&boxes, axis](int a, int b) {
+                             return boxes[a].min[axis] + boxes[a].max[axis] <
+                                    boxes[b].min[axis] + boxes[b].max[axis];
+                         });
+
+        nodes[index] = node;
+        int left = buildNode(index, first, half);
+        int right = buildNode(index, first + half, count - half);
+        nodes[index].left = left;
+        nodes[index].right = right;
+        return index;
+    }
+
+    std::vector<int> objectOrder;
+    std::vector<int> leafOf;
+    std::vector<int> stack;
+};
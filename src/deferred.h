@@ -0,0 +1,137 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+
+#include "gl_state.h"
+#include "profiler.h"
+#include "shader.h"
+#include "shader_variants.h"
+#include "uniform_buffers.h"
+
+// ============== TRYB ODROCZONY (DEFERRED SHADING) ==============
+// Przebieg geometrii rysuje scene programami G-buffera (gbuffer_fragment.glsl,
+// bezier_gbuffer_fragment.glsl) do trzech tekstur i glebokosci; przebieg
+// oswietlenia to jeden trojkat pelnoekranowy liczacy swiatla klastrow raz na
+// piksel. Koszt oswietlenia zalezy od liczby pikseli, nie obiektow - przysloniete
+// fragmenty placa tylko zapis G-buffera (12 B + glebokosc na piksel).
+// Przebieg oswietlenia ma warianty cech globalnych (Blinn, mgla).
+
+class DeferredRenderer {
+public:
+    DeferredRenderer() : width(0), height(0), framebuffer(0), albedoTexture(0), normalTexture(0),
+                         specularTexture(0), depthTexture(0), emptyVAO(0) {}
+
+    bool init(int targetWidth, int targetHeight) {
+        lightingShaders.setup("deferred_lighting", SHADER_FEATURES_GLOBAL, "shaders/fullscreen_vertex.glsl",
+                              "shaders/deferred_lighting.glsl");
+        ShaderBuilder shaders;
+        lightingShaders.addTo(shaders, {0u});
+        if (!shaders.build()) return false;
+        // Core profile wymaga VAO takze dla rysowania bez atrybutow
+        glGenVertexArrays(1, &emptyVAO);
+        return resize(targetWidth, targetHeight);
+    }
+
+    bool valid() const { return framebuffer != 0; }
+
+    // Tekstury odtwarzane tylko przy zmianie rozmiaru celu
+    bool resize(int targetWidth, int targetHeight) {
+        if (framebuffer && targetWidth == width && targetHeight == height) return true;
+        destroyTargets();
+        width = targetWidth;
+        height = targetHeight;
+
+        albedoTexture = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        normalTexture = createTarget(GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV);
+        specularTexture = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        depthTexture = createTarget(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, specularTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+        glDrawBuffers(3, drawBuffers);
+
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) {
+            std::cerr << "Niekompletny G-buffer " << width << "x" << height << std::endl;
+            destroyTargets();
+            return false;
+        }
+        return true;
+    }
+
+    // Cel przebiegu geometrii; tlo zostaje z glebokoscia 1 (pomijane przy oswietleniu)
+    void beginGeometry() {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        countStateChange();
+    }
+
+    // Oswietlenie do outputFramebuffer (juz wyczyszczonego kolorem tla) wariantem
+    // cech globalnych. Bufory swiatel klastrow musza byc podpiete (LightClusters::bind).
+    void light(unsigned int outputFramebuffer, unsigned int features) {
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+        lightingShaders.select(features).use();
+        bindTexture(TEXTURE_UNIT_GBUFFER_ALBEDO, albedoTexture);
+        bindTexture(TEXTURE_UNIT_GBUFFER_NORMAL, normalTexture);
+        bindTexture(TEXTURE_UNIT_GBUFFER_SPECULAR, specularTexture);
+        bindTexture(TEXTURE_UNIT_GBUFFER_DEPTH, depthTexture);
+        glActiveTexture(GL_TEXTURE0);
+
+        glDisable(GL_DEPTH_TEST);
+        bindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEnable(GL_DEPTH_TEST);
+        countStateChange(6);
+        countDrawCall();
+    }
+
+    void destroy() {
+        destroyTargets();
+        deleteVertexArray(emptyVAO);
+        lightingShaders.destroy();
+    }
+
+    void reportVariants(std::ostream& out) { lightingShaders.report(out); }
+
+private:
+    unsigned int createTarget(GLenum internalFormat, GLenum format, GLenum type) {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+        // Odczyt 1:1 z pikselem - bez filtrowania i mipmap
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    static void bindTexture(GLuint unit, unsigned int texture) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+
+    void destroyTargets() {
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+        unsigned int textures[] = {albedoTexture, normalTexture, specularTexture, depthTexture};
+        glDeleteTextures(4, textures);
+        framebuffer = albedoTexture = normalTexture = specularTexture = depthTexture = 0;
+    }
+
+    int width, height;
+    unsigned int framebuffer;
+    unsigned int albedoTexture, normalTexture, specularTexture, depthTexture;
+    unsigned int emptyVAO;
+    ShaderVariants lightingShaders;
+};
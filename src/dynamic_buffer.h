@@ -0,0 +1,170 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "profiler.h"
+
+// ============== PIERSCIEN DANYCH DYNAMICZNYCH ==============
+// Dane zmieniane co klatke (FrameData kamery i widokow swiatel, ShadowData,
+// transformacje wezlow, parametry powierzchni Beziera) leza w jednym buforze
+// uniform podzielonym na DYNAMIC_BUFFER_FRAMES obszarow: klatka pisze do
+// kolejnego obszaru, a rysowania wskazuja swoje dane offsetem
+// (glBindBufferRange) zamiast osobnych glUniform*.
+// Z ARB_buffer_storage (GL 4.4) bufor jest zmapowany raz, na stale i spojnie -
+// zapis to memcpy bez wywolan sterownika. Fence wstawiony na koncu klatki
+// wstrzymuje ponowny zapis obszaru, dopoki GPU go jeszcze czyta.
+// Bez rozszerzenia (GL 4.1): dane zbierane w pamieci CPU, bufor osierocany
+// raz na klatke, a niewyslana czesc idzie jednym glBufferSubData przed
+// najblizszym wiazaniem zakresu.
+
+const int DYNAMIC_BUFFER_FRAMES = 3;
+const size_t DYNAMIC_BUFFER_FULL = (size_t)-1;
+
+class DynamicBuffer {
+public:
+    DynamicBuffer() : buffer(0), mapped(NULL), regionSize(0), alignment(256), region(0), head(0), flushed(0),
+                      fences(), overflowReported(false), stallReported(false) {}
+
+    bool init(size_t bytesPerFrame) {
+        GLint offsetAlignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+        alignment = (size_t)offsetAlignment;
+        regionSize = alignUp(bytesPerFrame);
+
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            GLsizeiptr bytes = (GLsizeiptr)(regionSize * DYNAMIC_BUFFER_FRAMES);
+            glBufferStorage(GL_UNIFORM_BUFFER, bytes, NULL, flags);
+            mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, bytes, flags));
+            if (!mapped) {
+                // Bufor niezmiennego rozmiaru - fallback potrzebuje nowego
+                std::cerr << "Brak trwalego mapowania bufora - osierocanie (GL 4.1)" << std::endl;
+                glDeleteBuffers(1, &buffer);
+                glGenBuffers(1, &buffer);
+                glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            }
+        }
+        if (!mapped) {
+            glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)regionSize, NULL, GL_STREAM_DRAW);
+            staging.resize(regionSize);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        return glGetError() == GL_NO_ERROR;
+    }
+
+    bool persistent() const { return mapped != NULL; }
+
+    // Poczatek klatki, przed pierwszym push()
+    void beginFrame() {
+        if (mapped) {
+            region = (region + 1) % DYNAMIC_BUFFER_FRAMES;
+            if (fences[region]) {
+                // Czekamy tylko gdy CPU wyprzedza GPU o wszystkie obszary; bez
+                // sygnalu fence GPU moze jeszcze czytac obszar - nie wolno pisac
+                GLenum status;
+                while ((status = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT,
+                                                  FENCE_TIMEOUT_NS)) == GL_TIMEOUT_EXPIRED) {
+                    if (!stallReported) {
+                        std::cerr << "Obszar pierscienia zajety przez GPU ponad 1 s - czekamy dalej" << std::endl;
+                        stallReported = true;
+                    }
+                }
+                if (status == GL_WAIT_FAILED) {
+                    std::cerr << "Blad oczekiwania na fence pierscienia - glFinish" << std::endl;
+                    glFinish();
+                }
+                glDeleteSync(fences[region]);
+                fences[region] = 0;
+            }
+        } else {
+            // Osierocenie - poprzednie klatki czytaja stara pamiec bufora
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)regionSize, NULL, GL_STREAM_DRAW);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+        head = flushed = 0;
+    }
+
+    // Koniec klatki, po ostatnim rysowaniu czytajacym obszar
+    void endFrame() {
+        if (mapped) fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // Kopiuje dane do obszaru klatki; zwraca offset dla bind() albo
+    // DYNAMIC_BUFFER_FULL, gdy obszar sie skonczyl
+    size_t push(const void* data, size_t bytes) {
+        if (head + bytes > regionSize) {
+            if (!overflowReported) {
+                std::cerr << "Bufor danych dynamicznych pelny (" << regionSize << " B na klatke)" << std::endl;
+                overflowReported = true;
+            }
+            return DYNAMIC_BUFFER_FULL;
+        }
+        size_t offset = head;
+        std::memcpy((mapped ? mapped + region * regionSize : staging.data()) + offset, data, bytes);
+        head = alignUp(head + bytes);
+        return (mapped ? region * regionSize : 0) + offset;
+    }
+
+    template <typename T>
+    size_t push(const T& value) {
+        return push(&value, sizeof(T));
+    }
+
+    // Podpina zakres pod punkt wiazania bloku uniform
+    void bind(GLuint binding, size_t offset, size_t bytes) {
+        if (offset == DYNAMIC_BUFFER_FULL) return;
+        flush();
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, (GLintptr)offset, (GLsizeiptr)bytes);
+        countStateChange();
+    }
+
+    void destroy() {
+        for (GLsync& fence : fences) {
+            if (fence) glDeleteSync(fence);
+            fence = 0;
+        }
+        if (mapped) {
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            mapped = NULL;
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+
+private:
+    static const GLuint64 FENCE_TIMEOUT_NS = 1000000000ull;
+
+    size_t alignUp(size_t bytes) const { return (bytes + alignment - 1) / alignment * alignment; }
+
+    // Fallback: dane od ostatniego wyslania jednym glBufferSubData
+    void flush() {
+        if (mapped || head == flushed) return;
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)flushed, (GLsizeiptr)(head - flushed), staging.data() + flushed);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        countUniformUpload();
+        flushed = head;
+    }
+
+    unsigned int buffer;
+    unsigned char* mapped;              // NULL - fallback z osieracaniem
+    std::vector<unsigned char> staging; // kopia CPU obszaru (fallback)
+    size_t regionSize;
+    size_t alignment;
+    size_t region;                      // obszar biezacej klatki
+    size_t head;                        // zajete bajty obszaru
+    size_t flushed;                     // bajty juz wyslane (fallback)
+    GLsync fences[DYNAMIC_BUFFER_FRAMES];
+    bool overflowReported;
+    bool stallReported;
+};
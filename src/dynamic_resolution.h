@@ -0,0 +1,200 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "gl_state.h"
+#include "profiler.h"
+#include "shader.h"
+#include "uniform_buffers.h"
+
+// ============== DYNAMICZNA ROZDZIELCZOSC ==============
+// Przebiegi 3D (cienie poza tym - maja wlasne rozmiary map) rysuja do celu
+// o rozdzielczosci okna x skala, a przebieg skalowania rozciaga go na
+// framebuffer wyjsciowy filtrem dwuliniowym z wyostrzeniem. Nakladka idzie
+// juz w pelnej rozdzielczosci. Przy skali 1.0 cel jest pomijany - scena
+// trafia prosto do wyjscia, bez kosztu kopii.
+// Regulator porownuje czas GPU klatki z profilera (opozniony o
+// PROFILER_LATENCY klatek) z czasem docelowym: koszt cieniowania rosnie
+// z liczba pikseli, wiec skala zmienia sie o pierwiastek ze stosunku czasow.
+// Zmiany sa kwantowane (cel odtwarzany rzadko), obnizanie jest szybkie,
+// podnoszenie powolne i dopiero z zapasem - bez oscylacji na granicy celu.
+
+const float RESOLUTION_TARGET_MS_DEFAULT = 16.0f;
+const float RESOLUTION_MIN_SCALE_DEFAULT = 0.5f;
+const float RESOLUTION_MAX_SCALE_DEFAULT = 1.0f;
+const float RESOLUTION_SCALE_LIMIT = 0.25f;       // najnizsza dopuszczalna skala z opcji
+const float RESOLUTION_SCALE_STEP = 0.05f;
+const float RESOLUTION_MAX_DROP = 0.15f;          // najwieksza zmiana skali w dol na krok
+const float RESOLUTION_MAX_RAISE = 0.05f;         // i w gore
+const float RESOLUTION_RAISE_BELOW = 0.85f;       // podnoszenie ponizej 85% czasu docelowego
+const float RESOLUTION_SMOOTHING = 0.2f;          // waga nowej probki sredniej czasu
+const int RESOLUTION_MIN_SAMPLES = 4;             // probki przed pierwsza decyzja
+const int RESOLUTION_SETTLE_FRAMES = PROFILER_LATENCY + 2;   // pomiary sprzed zmiany sa pomijane
+const float RESOLUTION_SHARPNESS = 0.6f;          // sila wyostrzenia przy skali 0.5 i nizej
+
+class ResolutionController {
+public:
+    float targetMs;
+    float minScale, maxScale;
+
+    ResolutionController() : targetMs(RESOLUTION_TARGET_MS_DEFAULT), minScale(RESOLUTION_MIN_SCALE_DEFAULT),
+                             maxScale(RESOLUTION_MAX_SCALE_DEFAULT), current(RESOLUTION_MAX_SCALE_DEFAULT),
+                             averageMs(0.0), samples(0), settleFrames(0) {}
+
+    float scale() const { return current; }
+    double averageFrameMs() const { return averageMs; }
+
+    // Start od zadanej skali (np. po wlaczeniu regulatora), bez starych pomiarow
+    void reset(float scale) {
+        current = clampScale(scale);
+        averageMs = 0.0;
+        samples = 0;
+        settleFrames = RESOLUTION_SETTLE_FRAMES;
+    }
+
+    // Raz na klatke, gpuMs - czas GPU ostatniej odczytanej klatki; zwraca skale
+    float update(double gpuMs) {
+        if (gpuMs <= 0.0) return current;   // brak pomiaru (np. pierwsze klatki)
+        if (settleFrames > 0) {
+            --settleFrames;
+            return current;
+        }
+        averageMs = samples == 0 ? gpuMs : averageMs + (gpuMs - averageMs) * RESOLUTION_SMOOTHING;
+        if (++samples < RESOLUTION_MIN_SAMPLES) return current;
+
+        // W pasmie histerezy skala zostaje bez zmian (takze poza siatka kroku,
+        // np. --max-scale 0.93); kwantyzacja tylko przy zmianie: obnizenie do
+        // pelnego kroku w dol, podniesienie tylko gdy zapas starcza na caly krok
+        float ideal = current * std::sqrt(targetMs / (float)averageMs);
+        float next = current;
+        if (averageMs > targetMs) {
+            next = clampScale(quantize(std::max(ideal, current - RESOLUTION_MAX_DROP)));
+        } else if (averageMs < targetMs * RESOLUTION_RAISE_BELOW) {
+            float raised = quantize(std::min(ideal, current + RESOLUTION_MAX_RAISE));
+            if (raised > current) next = clampScale(raised);
+        }
+        if (next != current) {
+            current = next;
+            averageMs = 0.0;
+            samples = 0;
+            settleFrames = RESOLUTION_SETTLE_FRAMES;
+        }
+        return current;
+    }
+
+private:
+    float clampScale(float scale) const { return glm::clamp(scale, minScale, maxScale); }
+    static float quantize(float scale) {
+        return std::floor(scale / RESOLUTION_SCALE_STEP + 1e-3f) * RESOLUTION_SCALE_STEP;
+    }
+
+    float current;
+    double averageMs;
+    int samples;
+    int settleFrames;
+};
+
+class DynamicResolution {
+public:
+    ResolutionController controller;
+
+    DynamicResolution() : width(0), height(0), framebuffer(0), colorTexture(0), depthBuffer(0), emptyVAO(0) {}
+
+    bool init() {
+        if (!upscaleShader.loadFromFiles("shaders/fullscreen_vertex.glsl", "shaders/upscale_fragment.glsl")) {
+            return false;
+        }
+        // Core profile wymaga VAO takze dla rysowania bez atrybutow
+        glGenVertexArrays(1, &emptyVAO);
+        return true;
+    }
+
+    static int scaledSize(int size, float scale) { return std::max(1, (int)std::lround(size * scale)); }
+
+    int targetWidth() const { return width; }
+    int targetHeight() const { return height; }
+
+    // Cel odtwarzany tylko przy zmianie rozmiaru (skala kwantowana - rzadko);
+    // zwraca FBO celu albo 0, gdy nie udalo sie go utworzyc
+    unsigned int resize(int targetWidth, int targetHeight) {
+        if (framebuffer && targetWidth == width && targetHeight == height) return framebuffer;
+        destroyTarget();
+        width = targetWidth;
+        height = targetHeight;
+
+        glGenTextures(1, &colorTexture);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        // Filtrowanie dwuliniowe przy skalowaniu, bez mipmap
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) {
+            std::cerr << "Niekompletny cel skalowanej rozdzielczosci " << width << "x" << height << std::endl;
+            destroyTarget();
+            return 0;
+        }
+        return framebuffer;
+    }
+
+    // Skalowanie celu na outputFramebuffer; wyostrzenie rosnie ze stopniem
+    // powiekszenia (przy skali bliskiej 1.0 czysty filtr dwuliniowy)
+    void present(unsigned int outputFramebuffer, int outputWidth, int outputHeight) {
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+        glViewport(0, 0, outputWidth, outputHeight);
+        upscaleShader.use();
+        float magnification = (float)outputWidth / (float)width;
+        upscaleShader.setVec2("sourceTexel", glm::vec2(1.0f / width, 1.0f / height));
+        upscaleShader.setFloat("sharpness", RESOLUTION_SHARPNESS * glm::clamp(magnification - 1.0f, 0.0f, 1.0f));
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_SCENE_COLOR);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glActiveTexture(GL_TEXTURE0);
+
+        glDisable(GL_DEPTH_TEST);
+        bindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEnable(GL_DEPTH_TEST);
+        countStateChange(6);
+        countDrawCall();
+    }
+
+    void destroy() {
+        destroyTarget();
+        deleteVertexArray(emptyVAO);
+        deleteProgram(upscaleShader.ID);
+    }
+
+private:
+    void destroyTarget() {
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+        if (depthBuffer) glDeleteRenderbuffers(1, &depthBuffer);
+        if (colorTexture) glDeleteTextures(1, &colorTexture);
+        framebuffer = depthBuffer = colorTexture = 0;
+        width = height = 0;
+    }
+
+    int width, height;
+    unsigned int framebuffer, colorTexture, depthBuffer;
+    unsigned int emptyVAO;
+    Shader upscaleShader;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "profiler.h"
+
+// ============== SLEDZENIE STANU GL ==============
+// Zapamietane wiazania VAO i programu oraz przelaczniki GL_CULL_FACE/GL_BLEND -
+// powtorne ustawienie tej samej wartosci jest pomijane (w profilerze liczone
+// osobno jako pominiete). Wszystkie wiazania, przelaczenia i usuwanie tych
+// obiektow musza przechodzic przez te funkcje, inaczej zapamietany stan sie rozjedzie.
+
+inline unsigned int boundVertexArray = 0;
+inline unsigned int boundProgram = 0;
+inline bool cullFaceEnabled = false;   // domyslny stan kontekstu GL
+inline bool blendEnabled = false;
+
+inline void bindVertexArray(unsigned int vao) {
+    if (vao == boundVertexArray) {
+        countSkippedStateChange();
+        return;
+    }
+    glBindVertexArray(vao);
+    boundVertexArray = vao;
+    countStateChange();
+}
+
+inline void deleteVertexArray(unsigned int& vao) {
+    if (vao == 0) return;
+    // Usuniecie zwiazanego VAO przywraca wiazanie 0
+    if (vao == boundVertexArray) boundVertexArray = 0;
+    glDeleteVertexArrays(1, &vao);
+    vao = 0;
+}
+
+inline void useProgram(unsigned int program) {
+    if (program == boundProgram) {
+        countSkippedStateChange();
+        return;
+    }
+    glUseProgram(program);
+    boundProgram = program;
+    countStateChange();
+}
+
+inline void deleteProgram(unsigned int& program) {
+    if (program == 0) return;
+    // Usuniety program w uzyciu zyje do zmiany programu - identyfikator moze
+    // wrocic z glCreateProgram, wiec nie moze zostac w cache
+    if (program == boundProgram) {
+        glUseProgram(0);
+        boundProgram = 0;
+    }
+    glDeleteProgram(program);
+    program = 0;
+}
+
+inline void setCullFace(bool enabled) {
+    if (enabled == cullFaceEnabled) {
+        countSkippedStateChange();
+        return;
+    }
+    if (enabled) {
+        glEnable(GL_CULL_FACE);
+    } else {
+        glDisable(GL_CULL_FACE);
+    }
+    cullFaceEnabled = enabled;
+    countStateChange();
+}
+
+inline void setBlend(bool enabled) {
+    if (enabled == blendEnabled) {
+        countSkippedStateChange();
+        return;
+    }
+    if (enabled) {
+        glEnable(GL_BLEND);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    blendEnabled = enabled;
+    countStateChange();
+}
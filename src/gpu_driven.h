@@ -0,0 +1,233 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "culling.h"
+#include "gl_state.h"
+#include "instancing.h"
+#include "mesh.h"
+#include "profiler.h"
+#include "shader.h"
+#include "shader_variants.h"
+
+// ============== SCIEZKA GPU-DRIVEN (GL 4.3+) ==============
+// Obiekty statyczne (instancje) leza w SSBO. Compute shader co klatke
+// odrzuca je frustum cullingiem i wypelnia DrawElementsIndirectCommand
+// (jedna na siatke), a calosc rysuje jeden glMultiDrawElementsIndirect.
+// CPU nie dotyka pojedynczych obiektow. Indeks obiektu trafia do vertex
+// shadera przez atrybut z divisor 1, przesuwany przez baseInstance komendy
+// (bez gl_BaseInstance / ARB_shader_draw_parameters).
+// Bez GL 4.3 albo SSBO w vertex shaderze zostaje sciezka InstanceBatch.
+
+// Uklad std430 - patrz cull_compute.glsl i gpu_driven_vertex.glsl
+struct GpuObject {
+    glm::mat4 model;
+    glm::vec4 normalMatrix[3];   // kolumny mat3, w ukladzie swiata
+    glm::vec4 color;
+    glm::vec4 boundsMin;         // AABB w ukladzie swiata, w = indeks siatki
+    glm::vec4 boundsMax;
+};
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Program rysowania: oswietlenie forward, G-buffer albo sama glebokosc (mapy cieni)
+enum GpuDrawProgram {
+    GPU_DRAW_FORWARD = 0,
+    GPU_DRAW_GBUFFER = 1,
+    GPU_DRAW_DEPTH = 2
+};
+
+class GpuDrivenRenderer {
+public:
+    GpuDrivenRenderer() : objectBuffer(0), commandBuffer(0), visibleBuffer(0), VAO(0), objectCount(0) {}
+
+    static bool isSupported() {
+        if (!GLEW_VERSION_4_3) return false;
+        // SSBO w vertex shaderze nie jest wymagane przez specyfikacje
+        GLint vertexBlocks = 0;
+        glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &vertexBlocks);
+        return vertexBlocks > 0;
+    }
+
+    // batches[i] to instancje meshes[i]. Wszystkie siatki musza lezec w jednym
+    // bloku puli i miec ten sam typ indeksow - jedno VAO i jeden typ na wywolanie MDI.
+    // materialFeatures - cechy materialu wszystkich obiektow (warianty programow rysowania)
+    bool init(const std::vector<const Mesh*>& meshList, const std::vector<const InstanceBatch*>& batches,
+              unsigned int materialFeatures) {
+        meshes = meshList;
+        for (const Mesh* mesh : meshes) {
+            if (mesh->owner() != meshes[0]->owner() || mesh->range().block != meshes[0]->range().block ||
+                mesh->range().indexType != meshes[0]->range().indexType) {
+                std::cerr << "GPU-driven: siatki w roznych blokach geometrii lub z roznymi indeksami" << std::endl;
+                return false;
+            }
+        }
+
+        // Jedna partia - kompilacje wszystkich programow zlecone naraz;
+        // programy rysowania dla forward (warianty cech), G-buffera i przebiegow glebokosci
+        ShaderBuilder shaders;
+        shaders.addCompute(cullShader, "shaders/cull_compute.glsl");
+        drawShaders.setup("gpu_driven forward", SHADER_FEATURES_GLOBAL | SHADER_FEATURES_MATERIAL,
+                          "shaders/gpu_driven_vertex.glsl", "shaders/fragment.glsl");
+        gbufferShaders.setup("gpu_driven gbuffer", SHADER_FEATURES_MATERIAL, "shaders/gpu_driven_vertex.glsl",
+                             "shaders/gbuffer_fragment.glsl");
+        drawShaders.addTo(shaders, {materialFeatures});
+        gbufferShaders.addTo(shaders, {materialFeatures});
+        shaders.add(depthShader, "shaders/gpu_driven_vertex.glsl", "shaders/depth_fragment.glsl");
+        if (!shaders.build()) return false;
+
+        // Obiekty pogrupowane wg siatki - zakres siatki w VisibleObjects ma rozmiar grupy
+        std::vector<GpuObject> objects;
+        meshFirstObject.clear();
+        for (size_t m = 0; m < meshes.size(); ++m) {
+            meshFirstObject.push_back((GLuint)objects.size());
+            for (const InstanceData& instance : batches[m]->instances) {
+                AABB bounds = transformAABB(meshes[m]->bounds, instance.model);
+                GpuObject object;
+                object.model = instance.model;
+                for (int c = 0; c < 3; ++c) object.normalMatrix[c] = glm::vec4(instance.normalMatrix[c], 0.0f);
+                object.color = instance.color;
+                object.boundsMin = glm::vec4(bounds.min, (float)m);
+                object.boundsMax = glm::vec4(bounds.max, 0.0f);
+                objects.push_back(object);
+            }
+        }
+        objectCount = (GLuint)objects.size();
+        commands.resize(meshes.size());
+
+        glGenBuffers(1, &objectBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(objects.size(), 1) * sizeof(GpuObject),
+                     objects.data(), GL_STATIC_DRAW);
+
+        glGenBuffers(1, &commandBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), NULL,
+                     GL_DYNAMIC_DRAW);
+
+        glGenBuffers(1, &visibleBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<GLuint>(objectCount, 1) * sizeof(GLuint), NULL,
+                     GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        // VAO nad buforami puli + indeks obiektu jako atrybut instancji
+        VAO = meshes[0]->owner()->createVertexArray(meshes[0]->range().block);
+        glBindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        std::cout << "GPU-driven: " << objectCount << " obiektow, " << meshes.size() << " siatek" << std::endl;
+        return true;
+    }
+
+    // Zeruje liczniki komend i uruchamia culling; wynik widoczny dla draw()
+    void cull(const Frustum& frustum, bool cullingEnabled) {
+        if (objectCount == 0) return;
+
+        // Zakresy czytane co klatke - defragmentacja puli moze je przesunac
+        for (size_t m = 0; m < meshes.size(); ++m) {
+            const GeometryAllocation& range = meshes[m]->range();
+            DrawElementsIndirectCommand& command = commands[m];
+            command.count = (GLuint)range.indexCount;
+            command.instanceCount = 0;
+            command.firstIndex = (GLuint)(range.indexOffset / indexSize(range.indexType));
+            command.baseVertex = (GLint)range.firstVertex;
+            command.baseInstance = meshFirstObject[m];
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand),
+                        commands.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        glm::vec4 planes[6];
+        for (int i = 0; i < 6; ++i) planes[i] = frustum.plane(i);
+        cullShader.use();
+        cullShader.setVec4Array("frustumPlanes", planes, 6);
+        cullShader.setInt("objectCount", (int)objectCount);
+        cullShader.setBool("cullingEnabled", cullingEnabled);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visibleBuffer);
+        glDispatchCompute((objectCount + 63) / 64, 1, 1);
+        // Komendy czytane jako bufor posredni, indeksy obiektow jako atrybut
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+        countStateChange(3);
+    }
+
+    // features - cechy globalne i materialu (przebieg glebokosci ich nie ma)
+    Shader& drawProgram(GpuDrawProgram program, unsigned int features = 0) {
+        if (program == GPU_DRAW_FORWARD) return drawShaders.select(features);
+        if (program == GPU_DRAW_GBUFFER) return gbufferShaders.select(features);
+        return depthShader;
+    }
+
+    unsigned int vertexArray() const { return VAO; }
+
+    // Material i FrameData ustawia wywolujacy
+    void draw(GpuDrawProgram program = GPU_DRAW_FORWARD, unsigned int features = 0) {
+        if (objectCount == 0) return;
+        draw(drawProgram(program, features));
+    }
+
+    // Program wybrany wczesniej przez drawProgram() (kolejka rysowania)
+    void draw(Shader& program) {
+        if (objectCount == 0) return;
+        program.use();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer);
+        bindVertexArray(VAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, meshes[0]->range().indexType, (void*)0,
+                                   (GLsizei)commands.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        countStateChange(2);
+        countDrawCall();
+    }
+
+    GLuint size() const { return objectCount; }
+
+    void destroy() {
+        deleteVertexArray(VAO);
+        glDeleteBuffers(1, &objectBuffer);
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &visibleBuffer);
+        objectBuffer = commandBuffer = visibleBuffer = 0;
+        deleteProgram(cullShader.ID);
+        drawShaders.destroy();
+        gbufferShaders.destroy();
+        deleteProgram(depthShader.ID);
+        objectCount = 0;
+    }
+
+    void reportVariants(std::ostream& out) {
+        drawShaders.report(out);
+        gbufferShaders.report(out);
+    }
+
+private:
+    Shader cullShader;
+    ShaderVariants drawShaders;
+    ShaderVariants gbufferShaders;
+    Shader depthShader;
+    std::vector<const Mesh*> meshes;
+    std::vector<GLuint> meshFirstObject;
+    std::vector<DrawElementsIndirectCommand> commands;
+    unsigned int objectBuffer, commandBuffer, visibleBuffer;
+    unsigned int VAO;
+    GLuint objectCount;
+};
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "culling.h"
+#include "gl_state.h"
+#include "profiler.h"
+
+// ============== WSPOLNE BUFORY GEOMETRII ==============
+// Statyczna geometria wszystkich siatek lezy w kilku duzych blokach
+// (VBO + IBO + VAO na blok). Siatka to tylko zakres wierzcholkow i indeksow;
+// rysowanie przez glDrawElementsBaseVertex, wiec siatki z jednego bloku
+// nie wymagaja zmiany VAO. Indeksy sa lokalne dla siatki (16-bit dalej wystarcza).
+// Zwolnione zakresy wracaja na liste wolnych (first-fit ze scalaniem), a gdy
+// zaden nie miesci nowej siatki, blok jest defragmentowany na GPU.
+
+// Lista wolnych zakresow [offset, offset + size) posortowana po offsecie
+class RangeAllocator {
+public:
+    RangeAllocator() : capacity(0) {}
+
+    void init(size_t size) {
+        capacity = size;
+        freeRanges.clear();
+        if (size > 0) freeRanges.push_back({0, size});
+    }
+
+    // first-fit; offset wyrownany do alignment (wyrownanie tez zajmuje miejsce)
+    bool allocate(size_t size, size_t alignment, size_t& offset) {
+        for (size_t i = 0; i < freeRanges.size(); ++i) {
+            Range& range = freeRanges[i];
+            size_t aligned = (range.offset + alignment - 1) / alignment * alignment;
+            size_t padding = aligned - range.offset;
+            if (range.size < size + padding) continue;
+
+            offset = aligned;
+            if (padding > 0) {
+                // Wyrownanie zostaje wolne przed przydzielonym zakresem
+                Range tail = {aligned + size, range.size - size - padding};
+                range.size = padding;
+                if (tail.size > 0) freeRanges.insert(freeRanges.begin() + i + 1, tail);
+            } else {
+                range.offset += size;
+                range.size -= size;
+                if (range.size == 0) freeRanges.erase(freeRanges.begin() + i);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void free(size_t offset, size_t size) {
+        std::vector<Range>::iterator next = std::lower_bound(
+            freeRanges.begin(), freeRanges.end(), offset,
+            [](const Range& range, size_t value) { return range.offset < value; });
+        next = freeRanges.insert(next, {offset, size});
+
+        // Scalanie z nastepnym i poprzednim zakresem
+        if (next + 1 != freeRanges.end() && next->offset + next->size == (next + 1)->offset) {
+            next->size += (next + 1)->size;
+            freeRanges.erase(next + 1);
+        }
+        if (next != freeRanges.begin() && (next - 1)->offset + (next - 1)->size == next->offset) {
+            (next - 1)->size += next->size;
+            freeRanges.erase(next);
+        }
+    }
+
+    size_t freeBytes() const {
+        size_t total = 0;
+        for (const Range& range : freeRanges) total += range.size;
+        return total;
+    }
+
+    size_t largestFree() const {
+        size_t largest = 0;
+        for (const Range& range : freeRanges) largest = std::max(largest, range.size);
+        return largest;
+    }
+
+    size_t size() const { return capacity; }
+    size_t freeRangeCount() const { return freeRanges.size(); }
+
+private:
+    struct Range {
+        size_t offset;
+        size_t size;
+    };
+
+    size_t capacity;
+    std::vector<Range> freeRanges;
+};
+
+struct GeometryStats {
+    size_t vertexBytesUsed, vertexBytesCapacity;
+    size_t indexBytesUsed, indexBytesCapacity;
+    unsigned int blocks;
+    unsigned int liveAllocations;
+    unsigned int allocations;     // od uruchomienia
+    unsigned int frees;
+    unsigned int defragmentations;
+    size_t bytesMoved;            // przez defragmentacje
+    unsigned int freeRanges;      // fragmentacja - liczba dziur we wszystkich blokach
+};
+
+// Zakres jednej siatki w bloku
+struct GeometryAllocation {
+    int block;                 // -1 = wolny wpis
+    size_t firstVertex;        // w wierzcholkach (baseVertex)
+    size_t vertexCount;
+    size_t indexOffset;        // w bajtach
+    size_t indexCount;
+    GLenum indexType;
+};
+
+inline size_t indexSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+class GeometryPool {
+public:
+    // Domyslny rozmiar bloku; wieksze siatki dostaja wlasny blok
+    static const size_t BLOCK_VERTEX_BYTES = 8 * 1024 * 1024;
+    static const size_t BLOCK_INDEX_BYTES = 4 * 1024 * 1024;
+
+    GeometryPool() : stride(0), setupVertexAttributes(NULL), scratchBuffer(0), scratchSize(0) {
+        resetStats();
+    }
+
+    // setupAttributes ustawia atrybuty wierzcholka dla zwiazanego VAO i VBO
+    // (wywolywana dla kazdego nowego bloku i VAO instancji)
+    void init(size_t vertexStride, void (*setupAttributes)()) {
+        stride = vertexStride;
+        setupVertexAttributes = setupAttributes;
+    }
+
+    // Zwraca identyfikator zakresu lub -1. Dane wysylane od razu na GPU.
+    int allocate(const void* vertices, size_t vertexCount, const void* indices, size_t indexCount,
+                 GLenum indexType) {
+        size_t vertexBytes = vertexCount * stride;
+        size_t indexBytes = indexCount * indexSize(indexType);
+
+        GeometryAllocation allocation;
+        allocation.vertexCount = vertexCount;
+        allocation.indexCount = indexCount;
+        allocation.indexType = indexType;
+        allocation.block = findSpace(vertexCount, indexBytes, indexSize(indexType), allocation);
+        if (allocation.block < 0) {
+            // Defragmentacja tylko gdy wolne miejsce jest, ale w kawalkach
+            for (size_t b = 0; b < blocks.size() && allocation.block < 0; ++b) {
+                Block& block = blocks[b];
+                if (block.vertices.freeBytes() >= vertexCount &&
+                    block.indices.freeBytes() >= indexBytes + indexSize(indexType)) {
+                    defragment((int)b);
+                    allocation.block = findSpace(vertexCount, indexBytes, indexSize(indexType), allocation);
+                }
+            }
+        }
+        if (allocation.block < 0) {
+            if (!createBlock(std::max(BLOCK_VERTEX_BYTES / stride, vertexCount),
+                             std::max(BLOCK_INDEX_BYTES, indexBytes))) {
+                return -1;
+            }
+            allocation.block = findSpace(vertexCount, indexBytes, indexSize(indexType), allocation);
+            if (allocation.block < 0) return -1;
+        }
+
+        const Block& block = blocks[allocation.block];
+        // GL_COPY_WRITE_BUFFER - bez ruszania wiazania IBO w zwiazanym VAO
+        glBindBuffer(GL_COPY_WRITE_BUFFER, block.VBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.firstVertex * stride, vertexBytes, vertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, block.EBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.indexOffset, indexBytes, indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        int id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+            allocations[id] = allocation;
+        } else {
+            id = (int)allocations.size();
+            allocations.push_back(allocation);
+        }
+        ++stats.allocations;
+        return id;
+    }
+
+    void free(int id) {
+        // Pula moze byc juz zniszczona (uchwyty zwalniane po destroy)
+        if (id < 0 || id >= (int)allocations.size() || allocations[id].block < 0) return;
+        GeometryAllocation& allocation = allocations[id];
+        Block& block = blocks[allocation.block];
+        block.vertices.free(allocation.firstVertex, allocation.vertexCount);
+        block.indices.free(allocation.indexOffset, allocation.indexCount * indexSize(allocation.indexType));
+        allocation.block = -1;
+        freeIds.push_back(id);
+        ++stats.frees;
+    }
+
+    // Przesuwa zakresy bloku na poczatek buforow (kopie GPU-GPU przez bufor
+    // posredni - glCopyBufferSubData nie pozwala na nakladajace sie zakresy).
+    // Identyfikatory zostaja, zmieniaja sie tylko offsety.
+    void defragment(int blockIndex) {
+        Block& block = blocks[blockIndex];
+        std::vector<int> live;
+        for (size_t i = 0; i < allocations.size(); ++i) {
+            if (allocations[i].block == blockIndex) live.push_back((int)i);
+        }
+
+        std::sort(live.begin(), live.end(), [this](int a, int b) {
+            return allocations[a].firstVertex < allocations[b].firstVertex;
+        });
+        size_t nextVertex = 0;
+        for (int id : live) {
+            GeometryAllocation& allocation = allocations[id];
+            if (allocation.firstVertex != nextVertex) {
+                moveRange(block.VBO, allocation.firstVertex * stride, nextVertex * stride,
+                          allocation.vertexCount * stride);
+                allocation.firstVertex = nextVertex;
+            }
+            nextVertex += allocation.vertexCount;
+        }
+
+        std::sort(live.begin(), live.end(), [this](int a, int b) {
+            return allocations[a].indexOffset < allocations[b].indexOffset;
+        });
+        size_t nextIndex = 0;
+        for (int id : live) {
+            GeometryAllocation& allocation = allocations[id];
+            size_t alignment = indexSize(allocation.indexType);
+            nextIndex = (nextIndex + alignment - 1) / alignment * alignment;
+            size_t bytes = allocation.indexCount * alignment;
+            if (allocation.indexOffset != nextIndex) {
+                moveRange(block.EBO, allocation.indexOffset, nextIndex, bytes);
+                allocation.indexOffset = nextIndex;
+            }
+            nextIndex += bytes;
+        }
+
+        // Cala reszta bloku znow jest jednym wolnym zakresem
+        block.vertices.init(block.vertices.size());
+        block.indices.init(block.indices.size());
+        size_t offset;
+        if (nextVertex > 0) block.vertices.allocate(nextVertex, 1, offset);
+        if (nextIndex > 0) block.indices.allocate(nextIndex, 1, offset);
+        ++stats.defragmentations;
+    }
+
+    const GeometryAllocation& allocation(int id) const { return allocations[id]; }
+
+    unsigned int vertexArray(int block) const { return blocks[block].VAO; }
+
+    // Nowe VAO nad buforami bloku (np. dla instancji - wlasne atrybuty 3..10).
+    // Zwalnia je wywolujacy; VAO zostaje zwiazane.
+    unsigned int createVertexArray(int blockIndex) const {
+        const Block& block = blocks[blockIndex];
+        unsigned int vao;
+        glGenVertexArrays(1, &vao);
+        bindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, block.VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block.EBO);
+        setupVertexAttributes();
+        return vao;
+    }
+
+    GeometryStats getStats() const {
+        GeometryStats result = stats;
+        result.blocks = (unsigned int)blocks.size();
+        result.liveAllocations = (unsigned int)(allocations.size() - freeIds.size());
+        for (const Block& block : blocks) {
+            result.vertexBytesCapacity += block.vertices.size() * stride;
+            result.vertexBytesUsed += (block.vertices.size() - block.vertices.freeBytes()) * stride;
+            result.indexBytesCapacity += block.indices.size();
+            result.indexBytesUsed += block.indices.size() - block.indices.freeBytes();
+            result.freeRanges += (unsigned int)(block.vertices.freeRangeCount() + block.indices.freeRangeCount());
+        }
+        return result;
+    }
+
+    void printStats() const {
+        GeometryStats s = getStats();
+        std::cout << "Geometria: " << s.blocks << " blok(i), " << s.liveAllocations << " siatek, wierzcholki "
+                  << s.vertexBytesUsed / 1024 << "/" << s.vertexBytesCapacity / 1024 << " KB, indeksy "
+                  << s.indexBytesUsed / 1024 << "/" << s.indexBytesCapacity / 1024 << " KB, przydzialy "
+                  << s.allocations << ", zwolnienia " << s.frees << ", defragmentacje " << s.defragmentations
+                  << std::endl;
+    }
+
+    void destroy() {
+        for (Block& block : blocks) {
+            deleteVertexArray(block.VAO);
+            glDeleteBuffers(1, &block.VBO);
+            glDeleteBuffers(1, &block.EBO);
+        }
+        blocks.clear();
+        allocations.clear();
+        freeIds.clear();
+        if (scratchBuffer) glDeleteBuffers(1, &scratchBuffer);
+        scratchBuffer = 0;
+        scratchSize = 0;
+    }
+
+private:
+    struct Block {
+        unsigned int VAO, VBO, EBO;
+        RangeAllocator vertices;   // w wierzcholkach
+        RangeAllocator indices;    // w bajtach
+    };
+
+    int findSpace(size_t vertexCount, size_t indexBytes, size_t alignment, GeometryAllocation& allocation) {
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            Block& block = blocks[b];
+            size_t firstVertex, indexOffset;
+            if (!block.vertices.allocate(vertexCount, 1, firstVertex)) continue;
+            if (!block.indices.allocate(indexBytes, alignment, indexOffset)) {
+                block.vertices.free(firstVertex, vertexCount);
+                continue;
+            }
+            allocation.firstVertex = firstVertex;
+            allocation.indexOffset = indexOffset;
+            return (int)b;
+        }
+        return -1;
+    }
+
+    bool createBlock(size_t vertexCapacity, size_t indexBytes) {
+        Block block;
+        block.VAO = 0;
+        glGenBuffers(1, &block.VBO);
+        glGenBuffers(1, &block.EBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, block.VBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * stride, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, block.EBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, indexBytes, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        if (glGetError() == GL_OUT_OF_MEMORY) {
+            std::cerr << "Brak pamieci GPU na blok geometrii (" << (vertexCapacity * stride + indexBytes) / 1024
+                      << " KB)" << std::endl;
+            glDeleteBuffers(1, &block.VBO);
+            glDeleteBuffers(1, &block.EBO);
+            return false;
+        }
+        block.vertices.init(vertexCapacity);
+        block.indices.init(indexBytes);
+        blocks.push_back(block);
+        blocks.back().VAO = createVertexArray((int)blocks.size() - 1);
+        bindVertexArray(0);
+        return true;
+    }
+
+    void moveRange(unsigned int buffer, size_t from, size_t to, size_t bytes) {
+        if (bytes > scratchSize) {
+            if (scratchBuffer == 0) glGenBuffers(1, &scratchBuffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, scratchBuffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, bytes, NULL, GL_STREAM_COPY);
+            scratchSize = bytes;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, scratchBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from, 0, bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, scratchBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, to, bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        stats.bytesMoved += bytes;
+    }
+
+    void resetStats() {
+        stats = GeometryStats();
+    }
+
+    size_t stride;
+    void (*setupVertexAttributes)();
+    std::vector<Block> blocks;
+    std::vector<GeometryAllocation> allocations;
+    std::vector<int> freeIds;
+    GeometryStats stats;
+    unsigned int scratchBuffer;
+    size_t scratchSize;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+// ============== KONTEKST HEADLESS (EGL) ==============
+// Kontekst OpenGL bez okna i bez serwera wyswietlania: EGL na platformie
+// "surfaceless" (Mesa, np. llvmpipe w CI), a obraz trafia do FBO zamiast
+// do bufora okna. Dostepny tylko gdy CMake znalazl EGL (HAVE_EGL).
+
+#ifdef HAVE_EGL
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <iostream>
+
+class HeadlessContext {
+public:
+    unsigned int framebuffer;
+
+    HeadlessContext() : framebuffer(0), colorBuffer(0), depthBuffer(0),
+                        display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT) {}
+
+    // Tworzy kontekst 4.1 core i ustawia go jako biezacy
+    bool create() {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay) {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        }
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        EGLint major = 0, minor = 0;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            std::cerr << "Nie mozna zainicjalizowac EGL" << std::endl;
+            return false;
+        }
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            std::cerr << "EGL nie obsluguje desktopowego OpenGL" << std::endl;
+            return false;
+        }
+
+        const EGLint configAttribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+        };
+        EGLConfig config;
+        EGLint numConfigs = 0;
+        if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+            std::cerr << "Brak konfiguracji EGL dla OpenGL" << std::endl;
+            return false;
+        }
+
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, 1,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (context == EGL_NO_CONTEXT) {
+            std::cerr << "Nie mozna utworzyc kontekstu EGL 4.1 core" << std::endl;
+            return false;
+        }
+
+        // Bez powierzchni - wymaga EGL_KHR_surfaceless_context
+        if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+            std::cerr << "Nie mozna aktywowac kontekstu EGL bez powierzchni" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Cel renderowania zamiast bufora okna (po inicjalizacji GLEW)
+    bool createFramebuffer(int width, int height) {
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Niekompletny framebuffer headless" << std::endl;
+            return false;
+        }
+        glViewport(0, 0, width, height);
+        return true;
+    }
+
+    void destroy() {
+        if (framebuffer) {
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(1, &colorBuffer);
+            glDeleteRenderbuffers(1, &depthBuffer);
+            framebuffer = colorBuffer = depthBuffer = 0;
+        }
+        if (display != EGL_NO_DISPLAY) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+            eglTerminate(display);
+            display = EGL_NO_DISPLAY;
+            context = EGL_NO_CONTEXT;
+        }
+    }
+
+private:
+    unsigned int colorBuffer, depthBuffer;
+    EGLDisplay display;
+    EGLContext context;
+};
+
+#endif // HAVE_EGL
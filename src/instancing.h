@@ -0,0 +1,248 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "gl_state.h"
+#include "lod.h"
+#include "mesh.h"
+#include "profiler.h"
+#include "transforms.h"
+
+// ============== RENDEROWANIE INSTANCYJNE ==============
+// Wiele kopii jednej siatki rysowanych jednym glDrawElementsInstancedBaseVertex.
+// Dane instancji (macierz modelu, macierz normalnych, kolor) leza w osobnym
+// buforze podpietym jako atrybuty 3..10 z divisor = 1 do wlasnego VAO batcha
+// nad buforami bloku GeometryPool, w ktorym lezy siatka.
+// Z LodChain widoczne instancje sa dzielone wg poziomu (jedno wywolanie na
+// poziom); bez glDraw*BaseInstance (GL 4.2) poczatek grupy w buforze ustawiaja
+// przesuniete wskazniki atrybutow instancji.
+
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3 normalMatrix;  // w ukladzie swiata - shader mnozy przez mat3(view)
+    glm::vec4 color;         // a = 0 -> kolor z materialu
+};
+
+const unsigned int INSTANCE_ATTRIB_MODEL = 3;   // 4 kolumny: 3..6
+const unsigned int INSTANCE_ATTRIB_NORMAL = 7;  // 3 kolumny: 7..9
+const unsigned int INSTANCE_ATTRIB_COLOR = 10;
+
+inline InstanceData makeInstance(const glm::mat4& model, const glm::mat3& normalMatrix,
+                                 const glm::vec3& color) {
+    InstanceData instance;
+    instance.model = model;
+    instance.normalMatrix = normalMatrix;
+    instance.color = glm::vec4(color, 1.0f);
+    return instance;
+}
+
+// Macierz normalnych liczona raz przy dodaniu/zmianie instancji, nie co klatke
+inline InstanceData makeInstance(const glm::mat4& model, const glm::vec3& color) {
+    return makeInstance(model, cofactorNormalMatrix(glm::mat3(model)), color);
+}
+
+class InstanceBatch {
+public:
+    std::vector<InstanceData> instances;
+
+    InstanceBatch() : mesh(NULL), VAO(0), instanceVBO(0), capacity(0), attributeBase(0), dirty(false) {}
+
+    // Tworzy VAO z atrybutami siatki i instancji. Siatka musi zyc dluzej niz batch
+    // (zakres czytany przy kazdym rysowaniu - defragmentacja puli go przesuwa).
+    void init(const Mesh& instancedMesh) {
+        mesh = &instancedMesh;
+        VAO = mesh->owner()->createVertexArray(mesh->range().block);
+
+        glGenBuffers(1, &instanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        setInstanceAttributes(0);
+        for (unsigned int attrib = INSTANCE_ATTRIB_MODEL; attrib <= INSTANCE_ATTRIB_COLOR; ++attrib) {
+            glEnableVertexAttribArray(attrib);
+            glVertexAttribDivisor(attrib, 1);
+        }
+
+        bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    size_t add(const glm::mat4& model, const glm::vec3& color) {
+        instances.push_back(makeInstance(model, color));
+        dirty = true;
+        return instances.size() - 1;
+    }
+
+    // Wersja z gotowa macierza normalnych (np. z TransformStore)
+    size_t add(const glm::mat4& model, const glm::mat3& normalMatrix, const glm::vec3& color) {
+        instances.push_back(makeInstance(model, normalMatrix, color));
+        dirty = true;
+        return instances.size() - 1;
+    }
+
+    void setModel(size_t index, const glm::mat4& model) {
+        glm::vec3 color = glm::vec3(instances[index].color);
+        instances[index] = makeInstance(model, color);
+        dirty = true;
+    }
+
+    void clear() {
+        instances.clear();
+        dirty = true;
+    }
+
+    // Wysyla dane tylko po zmianie; bufor rosnie, nigdy sie nie zmniejsza
+    void upload() {
+        if (!dirty) return;
+        size_t bytes = instances.size() * sizeof(InstanceData);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (instances.size() > capacity) {
+            glBufferData(GL_ARRAY_BUFFER, bytes, instances.data(), GL_STATIC_DRAW);
+            capacity = instances.size();
+        } else if (bytes > 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        countUniformUpload();
+        dirty = false;
+    }
+
+    void draw() {
+        if (instances.empty()) return;
+        upload();
+        drawInstances(*mesh, 0, instances.size());
+    }
+
+    // Rysuje tylko wskazane instancje (np. po frustum cullingu). Widoczne dane
+    // sa kopiowane do bufora co klatke; pelny zestaw wraca przy nastepnym draw().
+    // keepOrder - kolejnosc z visible (sortowanie), bez skrotu do draw().
+    void drawVisible(const std::vector<unsigned int>& visible, bool keepOrder = false) {
+        if (visible.size() == instances.size() && !keepOrder) {
+            draw();
+            return;
+        }
+        if (visible.empty()) return;
+
+        visibleInstances.clear();
+        for (unsigned int index : visible) visibleInstances.push_back(instances[index]);
+        uploadVisible();
+        drawInstances(*mesh, 0, visibleInstances.size());
+    }
+
+    // Widoczne instancje pogrupowane wg poziomu LOD. Poziom 0 lancucha to
+    // siatka z init(); poziomy z innego bloku puli (inne VAO) zastepuje poziom 0.
+    void drawVisible(const std::vector<unsigned int>& visible, const LodChain& lods, const LodView& view,
+                     bool keepOrder = false) {
+        if (!view.enabled || lods.count() <= 1) {
+            drawVisible(visible, keepOrder);
+            return;
+        }
+        if (visible.empty()) return;
+
+        // Poziom per instancja pamietany miedzy klatkami (histereza)
+        lodLevels.resize(instances.size(), 0);
+        size_t levelCount[MAX_LOD_LEVELS] = {};
+        for (unsigned int index : visible) {
+            int level = lods.select(view, instances[index].model, lodLevels[index]);
+            if (lods.level(level).range().block != mesh->range().block) level = 0;
+            lodLevels[index] = (unsigned char)level;
+            ++levelCount[level];
+        }
+
+        // Sortowanie przez zliczanie - grupy poziomow ciagle w buforze
+        size_t levelStart[MAX_LOD_LEVELS];
+        size_t offset = 0;
+        for (int level = 0; level < MAX_LOD_LEVELS; ++level) {
+            levelStart[level] = offset;
+            offset += levelCount[level];
+        }
+        visibleInstances.resize(visible.size());
+        size_t fill[MAX_LOD_LEVELS];
+        std::copy(levelStart, levelStart + MAX_LOD_LEVELS, fill);
+        for (unsigned int index : visible) visibleInstances[fill[lodLevels[index]]++] = instances[index];
+        uploadVisible();
+
+        for (int level = 0; level < MAX_LOD_LEVELS; ++level) {
+            if (levelCount[level] > 0) drawInstances(lods.level(level), levelStart[level], levelCount[level]);
+        }
+    }
+
+    // Widoczne instancje od najblizszej kamery (glebokosc srodka w ukladzie widoku).
+    // Sortowanie przez zliczanie w drawVisible z LOD jest stabilne - grupy
+    // poziomow zachowuja te kolejnosc.
+    void sortFrontToBack(std::vector<unsigned int>& visible, const glm::mat4& view) {
+        depthKeys.resize(instances.size());
+        const glm::vec4 depthRow(view[0][2], view[1][2], view[2][2], view[3][2]);
+        for (unsigned int index : visible) depthKeys[index] = -glm::dot(depthRow, instances[index].model[3]);
+        std::sort(visible.begin(), visible.end(),
+                  [this](unsigned int a, unsigned int b) { return depthKeys[a] < depthKeys[b]; });
+    }
+
+    unsigned int vertexArray() const { return VAO; }
+
+    void destroy() {
+        deleteVertexArray(VAO);
+        glDeleteBuffers(1, &instanceVBO);
+        instanceVBO = 0;
+        capacity = 0;
+    }
+
+private:
+    // Wskazniki atrybutow 3..10 od instancji firstInstance (bufor instanceVBO zwiazany)
+    void setInstanceAttributes(size_t firstInstance) {
+        const GLsizei stride = sizeof(InstanceData);
+        size_t base = firstInstance * sizeof(InstanceData);
+        for (unsigned int i = 0; i < 4; ++i) {
+            glVertexAttribPointer(INSTANCE_ATTRIB_MODEL + i, 4, GL_FLOAT, GL_FALSE, stride,
+                                  (void*)(base + offsetof(InstanceData, model) + i * sizeof(glm::vec4)));
+        }
+        for (unsigned int i = 0; i < 3; ++i) {
+            glVertexAttribPointer(INSTANCE_ATTRIB_NORMAL + i, 3, GL_FLOAT, GL_FALSE, stride,
+                                  (void*)(base + offsetof(InstanceData, normalMatrix) + i * sizeof(glm::vec3)));
+        }
+        glVertexAttribPointer(INSTANCE_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void*)(base + offsetof(InstanceData, color)));
+        attributeBase = firstInstance;
+    }
+
+    // Widoczne dane wysylane co klatke; pelny zestaw wraca przy nastepnym draw()
+    void uploadVisible() {
+        size_t bytes = visibleInstances.size() * sizeof(InstanceData);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        // Osierocenie - nie czekamy az GPU skonczy poprzednia klatke
+        capacity = std::max(capacity, visibleInstances.size());
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, visibleInstances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        countUniformUpload();
+        dirty = true;
+    }
+
+    void drawInstances(const Mesh& drawnMesh, size_t first, size_t count) {
+        const GeometryAllocation& range = drawnMesh.range();
+        bindVertexArray(VAO);
+        if (first != attributeBase) {
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            setInstanceAttributes(first);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            countStateChange();
+        }
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)range.indexCount, range.indexType,
+                                          (void*)range.indexOffset, (GLsizei)count, (GLint)range.firstVertex);
+        countDrawCall();
+        countTriangles((unsigned int)(count * range.indexCount / 3));
+    }
+
+    const Mesh* mesh;
+    unsigned int VAO;
+    unsigned int instanceVBO;
+    size_t capacity;
+    size_t attributeBase;   // pierwsza instancja wskazywana przez atrybuty VAO
+    bool dirty;
+    std::vector<InstanceData> visibleInstances;
+    std::vector<unsigned char> lodLevels;
+    std::vector<float> depthKeys;   // glebokosc instancji w widoku (sortFrontToBack)
+};
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "profiler.h"
+#include "uniform_buffers.h"
+#include "worker_pool.h"
+
+// ============== OSWIETLENIE KLASTROWE (CLUSTERED FORWARD) ==============
+// Frustum kamery jest podzielony na CLUSTER_X x CLUSTER_Y kafelkow ekranu
+// i CLUSTER_Z plasterkow glebokosci (wykladniczo od CLUSTER_NEAR do
+// CLUSTER_FAR). Co klatke CPU przypisuje kazde swiatlo do klastrow, ktore
+// przecina jego sfera zasiegu, a fragment liczy tylko swiatla swojego klastra.
+// GL 4.1 nie ma SSBO - swiatla, rekordy klastrow i listy indeksow leza
+// w buforach tekstur (samplerBuffer / usamplerBuffer).
+// Przypisanie idzie rownolegle po plasterkach: kazdy plasterek ma wlasne listy,
+// wiec watki nie dziela zapisu; na koncu listy sa sklejane w jedna tablice.
+
+const int CLUSTER_X = 16;
+const int CLUSTER_Y = 9;
+const int CLUSTER_Z = 24;
+const int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+const int CLUSTER_TILES = CLUSTER_X * CLUSTER_Y;
+// Zakres glebokosci siatki - jak plaszczyzny projekcji sceny
+const float CLUSTER_NEAR = 0.1f;
+const float CLUSTER_FAR = 100.0f;
+// Zasieg swiatla: odleglosc, na ktorej jego wklad spada ponizej tej wartosci
+const float LIGHT_CUTOFF = 1.0f / 256.0f;
+
+// Swiatla w buforze tekstury RGBA32F: najpierw punktowe (4 texele - uklad
+// PointLightStd140), potem reflektory (5 texeli - uklad SpotLightStd140)
+const int POINT_LIGHT_TEXELS = sizeof(PointLightStd140) / 16;
+const int SPOT_LIGHT_TEXELS = sizeof(SpotLightStd140) / 16;
+
+// Parametry wyboru plasterka: slice = floor(log(glebokosc) * scale - bias)
+inline float clusterDepthScale() {
+    return CLUSTER_Z / std::log(CLUSTER_FAR / CLUSTER_NEAR);
+}
+inline float clusterDepthBias() {
+    return CLUSTER_Z * std::log(CLUSTER_NEAR) / std::log(CLUSTER_FAR / CLUSTER_NEAR);
+}
+
+// Zasieg z tlumienia 1 / (c + l*d + q*d^2) i najjasniejszej skladowej swiatla
+inline float lightRange(float constant, float linear, float quadratic, const glm::vec3& ambient,
+                        const glm::vec3& diffuse, const glm::vec3& specular) {
+    glm::vec3 sum = ambient + diffuse + specular;
+    float intensity = std::max(sum.x, std::max(sum.y, sum.z));
+    float target = intensity / LIGHT_CUTOFF - constant;
+    if (target <= 0.0f) return 0.0f;
+    if (quadratic > 0.0f) {
+        return (-linear + std::sqrt(linear * linear + 4.0f * quadratic * target)) / (2.0f * quadratic);
+    }
+    return linear > 0.0f ? target / linear : CLUSTER_FAR;
+}
+
+class LightClusters {
+public:
+    // Wypelniane co klatke przez scene, pozycje i kierunki w ukladzie kamery
+    std::vector<PointLightStd140> pointLights;
+    std::vector<SpotLightStd140> spotLights;
+
+    // Statystyki ostatniego build()
+    size_t indexCount;
+    unsigned int maxClusterLights;
+
+    LightClusters() : indexCount(0), maxClusterLights(0), lightBuffer(0), recordBuffer(0), indexBuffer(0),
+                      lightTexture(0), recordTexture(0), indexTexture(0), lightCapacity(0), indexCapacity(0),
+                      maxTexels(65536), truncated(false), records(CLUSTER_COUNT * 2, 0), slices(CLUSTER_Z) {}
+
+    bool init() {
+        GLint limit = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &limit);
+        if (limit > 0) maxTexels = (size_t)limit;
+
+        createBuffer(lightBuffer, lightTexture, GL_RGBA32F);
+        createBuffer(recordBuffer, recordTexture, GL_RG32UI);
+        createBuffer(indexBuffer, indexTexture, GL_R32UI);
+        glBindBuffer(GL_TEXTURE_BUFFER, recordBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, records.size() * sizeof(uint32_t), records.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        return glGetError() == GL_NO_ERROR;
+    }
+
+    void clear() {
+        pointLights.clear();
+        spotLights.clear();
+    }
+
+    // Przypisanie swiatel do klastrow dla danej projekcji (symetryczna perspektywa)
+    void build(const glm::mat4& projection, WorkerPool& pool) {
+        computeSpheres(projection);
+        pool.run(CLUSTER_Z, [this](size_t slice) { binSlice((int)slice); });
+
+        // Sklejenie list plasterkow; rekord: poczatek listy, punktowe | reflektory << 16
+        indexCount = 0;
+        maxClusterLights = 0;
+        for (int slice = 0; slice < CLUSTER_Z; ++slice) indexCount += slices[slice].indices.size();
+        indices.resize(indexCount);
+        size_t base = 0;
+        for (int slice = 0; slice < CLUSTER_Z; ++slice) {
+            SliceBins& bins = slices[slice];
+            std::copy(bins.indices.begin(), bins.indices.end(), indices.begin() + base);
+            for (int tile = 0; tile < CLUSTER_TILES; ++tile) {
+                uint32_t* record = &records[(slice * CLUSTER_TILES + tile) * 2];
+                record[0] = (uint32_t)(base + bins.offsets[tile]);
+                record[1] = bins.pointCounts[tile] | (bins.spotCounts[tile] << 16);
+                maxClusterLights = std::max(maxClusterLights, bins.pointCounts[tile] + bins.spotCounts[tile]);
+            }
+            base += bins.indices.size();
+        }
+
+        // Lista wieksza niz bufor tekstury - nadmiar obciety (ostatnie klastry traca swiatla)
+        if (indexCount > maxTexels) {
+            if (!truncated) {
+                std::cerr << "Listy swiatel klastrow (" << indexCount << ") przekraczaja GL_MAX_TEXTURE_BUFFER_SIZE ("
+                          << maxTexels << ")" << std::endl;
+                truncated = true;
+            }
+            for (int cluster = 0; cluster < CLUSTER_COUNT; ++cluster) {
+                uint32_t* record = &records[cluster * 2];
+                if (record[0] + (record[1] & 0xffffu) + (record[1] >> 16) > maxTexels) record[1] = 0;
+            }
+            indexCount = maxTexels;
+        }
+    }
+
+    // Swiatla i listy wysylane w calosci - pozycje w ukladzie kamery zmieniaja sie z kazdym ruchem
+    void upload() {
+        size_t pointBytes = pointLights.size() * sizeof(PointLightStd140);
+        size_t spotBytes = spotLights.size() * sizeof(SpotLightStd140);
+        glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+        lightCapacity = std::max(lightCapacity, std::max<size_t>(pointBytes + spotBytes, 16));
+        glBufferData(GL_TEXTURE_BUFFER, lightCapacity, NULL, GL_STREAM_DRAW);
+        if (pointBytes > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, pointBytes, pointLights.data());
+        if (spotBytes > 0) glBufferSubData(GL_TEXTURE_BUFFER, pointBytes, spotBytes, spotLights.data());
+
+        glBindBuffer(GL_TEXTURE_BUFFER, recordBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, records.size() * sizeof(uint32_t), records.data(), GL_STREAM_DRAW);
+
+        glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+        indexCapacity = std::max(indexCapacity, std::max<size_t>(indexCount, 1));
+        glBufferData(GL_TEXTURE_BUFFER, indexCapacity * sizeof(uint32_t), NULL, GL_STREAM_DRAW);
+        if (indexCount > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, indexCount * sizeof(uint32_t), indices.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        countUniformUpload(3);
+    }
+
+    // Tekstury buforow na jednostkach z uniform_buffers.h (samplery ustawia bindBlocks)
+    void bind() const {
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_LIGHTS);
+        glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_CLUSTERS);
+        glBindTexture(GL_TEXTURE_BUFFER, recordTexture);
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_LIGHT_INDICES);
+        glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+        glActiveTexture(GL_TEXTURE0);
+        countStateChange(3);
+    }
+
+    void destroy() {
+        glDeleteTextures(1, &lightTexture);
+        glDeleteTextures(1, &recordTexture);
+        glDeleteTextures(1, &indexTexture);
+        glDeleteBuffers(1, &lightBuffer);
+        glDeleteBuffers(1, &recordBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+        lightTexture = recordTexture = indexTexture = 0;
+        lightBuffer = recordBuffer = indexBuffer = 0;
+        lightCapacity = indexCapacity = 0;
+    }
+
+private:
+    // Sfera zasiegu w ukladzie kamery i zakres plasterkow, ktore przecina
+    struct LightSphere {
+        glm::vec3 center;
+        float radius;
+        int firstSlice, lastSlice;   // firstSlice > lastSlice - poza siatka
+    };
+
+    // Prostokat kafelkow swiatla w jednym plasterku
+    struct LightTiles {
+        uint32_t light;
+        int x0, x1, y0, y1;
+    };
+
+    struct SliceBins {
+        uint32_t offsets[CLUSTER_TILES];
+        uint32_t pointCounts[CLUSTER_TILES];
+        uint32_t spotCounts[CLUSTER_TILES];
+        std::vector<uint32_t> indices;
+        std::vector<LightTiles> lights;   // swiatla przecinajace plasterek
+    };
+
+    static void createBuffer(unsigned int& buffer, unsigned int& texture, GLenum format) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    static int sliceOf(float depth) {
+        float slice = std::floor(std::log(std::max(depth, CLUSTER_NEAR)) * clusterDepthScale() - clusterDepthBias());
+        return (int)std::min(std::max(slice, 0.0f), (float)(CLUSTER_Z - 1));
+    }
+
+    void addSphere(const glm::vec3& center, float radius) {
+        LightSphere sphere;
+        sphere.center = center;
+        sphere.radius = radius;
+        float depth = -center.z;
+        if (radius <= 0.0f || depth + radius < CLUSTER_NEAR || depth - radius > CLUSTER_FAR) {
+            sphere.firstSlice = 1;
+            sphere.lastSlice = 0;
+        } else {
+            sphere.firstSlice = sliceOf(depth - radius);
+            sphere.lastSlice = sliceOf(depth + radius);
+        }
+        spheres.push_back(sphere);
+    }
+
+    void computeSpheres(const glm::mat4& projection) {
+        projectionX = projection[0][0];
+        projectionY = projection[1][1];
+        spheres.clear();
+        for (const PointLightStd140& light : pointLights) {
+            addSphere(light.position, lightRange(light.constant, light.linear, light.quadratic, light.ambient,
+                                                 light.diffuse, light.specular));
+        }
+        for (const SpotLightStd140& light : spotLights) {
+            float range = lightRange(light.constant, light.linear, light.quadratic, light.ambient, light.diffuse,
+                                     light.specular);
+            // Bez skladowej ambient reflektor swieci tylko w stozku - sfera opisana
+            // na stozku; z ambient oswietla cale otoczenie (jak w shaderze)
+            bool coneOnly = glm::max(light.ambient.x, glm::max(light.ambient.y, light.ambient.z)) <= 0.0f;
+            float cosAngle = light.outerCutOff;
+            if (coneOnly && cosAngle > 0.0f) {
+                glm::vec3 direction = glm::normalize(light.direction);
+                if (cosAngle >= 0.70710678f) {
+                    float radius = range / (2.0f * cosAngle);
+                    addSphere(light.position + direction * radius, radius);
+                } else {
+                    float sinAngle = std::sqrt(std::max(0.0f, 1.0f - cosAngle * cosAngle));
+                    addSphere(light.position + direction * (cosAngle * range), sinAngle * range);
+                }
+            } else {
+                addSphere(light.position, range);
+            }
+        }
+    }
+
+    // Zakres NDC sfery (jej AABB) w przedziale glebokosci [nearDepth, farDepth]
+    static void projectedRange(float center, float radius, float scale, float nearDepth, float farDepth,
+                               float& low, float& high) {
+        float minimum = center - radius, maximum = center + radius;
+        low = scale * (minimum >= 0.0f ? minimum / farDepth : minimum / nearDepth);
+        high = scale * (maximum >= 0.0f ? maximum / nearDepth : maximum / farDepth);
+    }
+
+    static bool tileRange(float low, float high, int tiles, int& first, int& last) {
+        if (high < -1.0f || low > 1.0f) return false;
+        first = std::max(0, (int)std::floor((low * 0.5f + 0.5f) * tiles));
+        last = std::min(tiles - 1, (int)std::floor((high * 0.5f + 0.5f) * tiles));
+        return first <= last;
+    }
+
+    void binSlice(int slice) {
+        SliceBins& bins = slices[slice];
+        float sliceNear = CLUSTER_NEAR * std::pow(CLUSTER_FAR / CLUSTER_NEAR, (float)slice / CLUSTER_Z);
+        float sliceFar = CLUSTER_NEAR * std::pow(CLUSTER_FAR / CLUSTER_NEAR, (float)(slice + 1) / CLUSTER_Z);
+
+        std::fill(bins.pointCounts, bins.pointCounts + CLUSTER_TILES, 0u);
+        std::fill(bins.spotCounts, bins.spotCounts + CLUSTER_TILES, 0u);
+        bins.lights.clear();
+
+        // Przebieg 1: kafelki kazdego swiatla i liczniki klastrow
+        size_t pointCount = pointLights.size();
+        for (size_t i = 0; i < spheres.size(); ++i) {
+            const LightSphere& sphere = spheres[i];
+            if (slice < sphere.firstSlice || slice > sphere.lastSlice) continue;
+            float depth = -sphere.center.z;
+            float nearDepth = std::max(sliceNear, depth - sphere.radius);
+            float farDepth = std::min(sliceFar, depth + sphere.radius);
+
+            float low, high;
+            LightTiles tiles;
+            tiles.light = (uint32_t)i;
+            projectedRange(sphere.center.x, sphere.radius, projectionX, nearDepth, farDepth, low, high);
+            if (!tileRange(low, high, CLUSTER_X, tiles.x0, tiles.x1)) continue;
+            projectedRange(sphere.center.y, sphere.radius, projectionY, nearDepth, farDepth, low, high);
+            if (!tileRange(low, high, CLUSTER_Y, tiles.y0, tiles.y1)) continue;
+
+            uint32_t* counts = i < pointCount ? bins.pointCounts : bins.spotCounts;
+            for (int y = tiles.y0; y <= tiles.y1; ++y) {
+                for (int x = tiles.x0; x <= tiles.x1; ++x) ++counts[y * CLUSTER_X + x];
+            }
+            bins.lights.push_back(tiles);
+        }
+
+        // Przebieg 2: listy klastrow - punktowe, za nimi reflektory
+        uint32_t offset = 0;
+        uint32_t pointFill[CLUSTER_TILES], spotFill[CLUSTER_TILES];
+        for (int tile = 0; tile < CLUSTER_TILES; ++tile) {
+            bins.offsets[tile] = offset;
+            pointFill[tile] = offset;
+            spotFill[tile] = offset + bins.pointCounts[tile];
+            offset += bins.pointCounts[tile] + bins.spotCounts[tile];
+        }
+        bins.indices.resize(offset);
+        for (const LightTiles& tiles : bins.lights) {
+            bool point = tiles.light < pointCount;
+            uint32_t* fill = point ? pointFill : spotFill;
+            uint32_t index = point ? tiles.light : tiles.light - (uint32_t)pointCount;
+            for (int y = tiles.y0; y <= tiles.y1; ++y) {
+                for (int x = tiles.x0; x <= tiles.x1; ++x) bins.indices[fill[y * CLUSTER_X + x]++] = index;
+            }
+        }
+    }
+
+    unsigned int lightBuffer, recordBuffer, indexBuffer;
+    unsigned int lightTexture, recordTexture, indexTexture;
+    size_t lightCapacity;   // bajty
+    size_t indexCapacity;   // indeksy
+    size_t maxTexels;       // GL_MAX_TEXTURE_BUFFER_SIZE
+    bool truncated;
+    float projectionX, projectionY;
+
+    std::vector<LightSphere> spheres;
+    std::vector<uint32_t> records;   // 2 na klaster
+    std::vector<uint32_t> indices;
+    std::vector<SliceBins> slices;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "culling.h"
+#include "mesh.h"
+#include "mesh_simplifier.h"
+
+// ============== POZIOMY SZCZEGOLOWOSCI (LOD) ==============
+// LodChain: siatki od najdokladniejszej (0) do najprostszej. Poziom wybierany
+// co klatke z rozmiaru obiektu na ekranie - srednicy sfery otaczajacej po
+// rzutowaniu, jako ulamka wysokosci ekranu. Histereza: przejscie na
+// dokladniejszy poziom wymaga rozmiaru wiekszego od progu o LOD_HYSTERESIS,
+// na prostszy - mniejszego o tyle samo, wiec obiekt na granicy nie przeskakuje.
+// Generatory daja kolejne poziomy z rzadszej siatki, modele z pliku - z
+// simplifyMesh (mesh_simplifier.h).
+
+const int MAX_LOD_LEVELS = 4;
+// Minimalny rozmiar na ekranie poziomow 0..2 (ponizej ostatniego progu - poziom 3)
+const float LOD_SCREEN_SIZES[MAX_LOD_LEVELS - 1] = {0.25f, 0.08f, 0.025f};
+const float LOD_HYSTERESIS = 0.15f;
+// Uproszczenie: docelowa liczba trojkatow poziomow 1..3 wzgledem poziomu 0
+const float LOD_TRIANGLE_RATIOS[MAX_LOD_LEVELS - 1] = {0.5f, 0.25f, 0.1f};
+const float LOD_MAX_ERROR = 0.05f;   // ulamek przekatnej AABB
+
+// Kamera na potrzeby wyboru poziomu
+struct LodView {
+    glm::vec3 cameraPosition;
+    float projectionScale;   // projection[1][1] = ctg(fov/2)
+    bool enabled;            // false - zawsze poziom 0
+};
+
+inline LodView makeLodView(const glm::mat4& view, const glm::mat4& projection, bool enabled) {
+    LodView lodView;
+    // Pozycja kamery z macierzy widoku bez odwracania: -R^T * t
+    glm::mat3 rotation(view);
+    lodView.cameraPosition = -(glm::transpose(rotation) * glm::vec3(view[3]));
+    lodView.projectionScale = projection[1][1];
+    lodView.enabled = enabled;
+    return lodView;
+}
+
+class LodChain {
+public:
+    LodChain() : center(0.0f), radius(0.0f) {}
+
+    void add(Mesh&& mesh) {
+        if (levels.empty()) {
+            center = 0.5f * (mesh.bounds.min + mesh.bounds.max);
+            radius = 0.5f * glm::length(mesh.bounds.max - mesh.bounds.min);
+        }
+        levels.push_back(std::move(mesh));
+    }
+
+    int count() const { return (int)levels.size(); }
+    const Mesh& level(int i) const { return levels[std::min(i, count() - 1)]; }
+    // Granice poziomu 0 - wspolne dla cullingu wszystkich poziomow
+    const AABB& bounds() const { return levels[0].bounds; }
+
+    bool valid() const {
+        if (levels.empty()) return false;
+        for (const Mesh& mesh : levels) {
+            if (!mesh.valid()) return false;
+        }
+        return true;
+    }
+
+    void release() {
+        for (Mesh& mesh : levels) mesh.release();
+        levels.clear();
+    }
+
+    // Srednica sfery otaczajacej na ekranie (ulamek wysokosci)
+    float screenSize(const LodView& view, const glm::mat4& model) const {
+        glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+        float scale = std::max(glm::length(glm::vec3(model[0])),
+                               std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        float worldRadius = radius * scale;
+        float distance = glm::length(worldCenter - view.cameraPosition);
+        if (distance <= worldRadius) return std::numeric_limits<float>::max();
+        return worldRadius * view.projectionScale / distance;
+    }
+
+    // Poziom dla danego rozmiaru, z histereza wzgledem obecnego
+    int select(float size, int current) const {
+        int last = count() - 1;
+        current = std::min(current, last);
+        while (current > 0 && size > LOD_SCREEN_SIZES[current - 1] * (1.0f + LOD_HYSTERESIS)) --current;
+        while (current < last && size < LOD_SCREEN_SIZES[current] * (1.0f - LOD_HYSTERESIS)) ++current;
+        return current;
+    }
+
+    int select(const LodView& view, const glm::mat4& model, int current) const {
+        if (!view.enabled || count() <= 1) return 0;
+        return select(screenSize(view, model), current);
+    }
+
+private:
+    std::vector<Mesh> levels;
+    glm::vec3 center;   // sfera otaczajaca poziomu 0 (z AABB)
+    float radius;
+};
+
+// Indeksy poziomow 1.. z uproszczenia siatki (np. modelu z pliku). Konczy sie,
+// gdy kolejny poziom nie jest wyraznie prostszy - wtedy blad osiagnal limit.
+inline std::vector<std::vector<unsigned int>> generateLodIndices(const std::vector<float>& vertices,
+                                                                 const std::vector<unsigned int>& indices) {
+    std::vector<std::vector<unsigned int>> lods;
+    size_t previous = indices.size();
+    for (int level = 1; level < MAX_LOD_LEVELS; ++level) {
+        size_t target = (size_t)(indices.size() / 3 * LOD_TRIANGLE_RATIOS[level - 1]) * 3;
+        const std::vector<unsigned int>& source = lods.empty() ? indices : lods.back();
+        std::vector<unsigned int> simplified =
+            simplifyMesh(vertices, SOURCE_VERTEX_FLOATS, source, target, LOD_MAX_ERROR);
+        if (simplified.empty() || simplified.size() > previous * 3 / 4) break;
+        previous = simplified.size();
+        lods.push_back(std::move(simplified));
+    }
+    return lods;
+}
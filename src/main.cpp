@@ -2,27 +2,59 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <vector>
 #include <cmath>
+#include <random>
 #include <string>
 
+#include "benchmark.h"
+#include "bezier_surface.h"
+#include "culling.h"
+#include "deferred.h"
+#include "dynamic_resolution.h"
+#include "gpu_driven.h"
+#include "headless_context.h"
+#include "instancing.h"
+#include "light_clusters.h"
+#include "lod.h"
+#include "mesh.h"
+#include "model_loader.h"
+#include "overlay.h"
+#include "profiler.h"
+#include "render_queue.h"
+#include "shadow_maps.h"
+#include "shader.h"
+#include "shader_variants.h"
+#include "simulation.h"
+#include "texture_streaming.h"
+#include "transforms.h"
+#include "uniform_buffers.h"
+
 // Ustawienia okna
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 720;
+const char* const WINDOW_TITLE = "Grafika Komputerowa - Projekt";
+
+// Zakres glebokosci kamery (projekcja, glebokosc w kluczach kolejki rysowania)
+const float CAMERA_NEAR = 0.1f;
+const float CAMERA_FAR = 100.0f;
 
-// Zmienne globalne sterowania
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
+// Watek symulacji (tryb interaktywny); ponizsze zmienne stanu sceny to stan
+// interpolowany na biezaca klatke, w benchmarku ustawiany wprost
+SimulationThread simulation;
 
 // Pozycja i kierunek poruszajacego sie obiektu
 glm::vec3 movingObjectPos(0.0f, 0.5f, 0.0f);
 float movingObjectAngle = 0.0f;
-float movingObjectSpeed = 2.0f;
 
 // Kierunek reflektora na ruchomym obiekcie (wzgledem obiektu)
 float spotlightYaw = 0.0f;
@@ -40,177 +72,72 @@ bool useBlinn = false;
 // Sila wiatru dla flagi
 float windStrength = 0.3f;
 
-// Tessellation level
+// Tessellation: maksymalny poziom (T/G), adaptacyjnie z rozmiaru na ekranie
 int tessLevel = 16;
-
-// ============== SHADER CLASS ==============
-class Shader {
-public:
-    unsigned int ID;
-
-    Shader() : ID(0) {}
-
-    bool loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath,
-                       const std::string& tcsPath = "", const std::string& tesPath = "") {
-        std::string vertexCode, fragmentCode, tcsCode, tesCode;
-
-        // Wczytaj vertex shader
-        std::ifstream vShaderFile(vertexPath);
-        if (!vShaderFile.is_open()) {
-            std::cerr << "Nie mozna otworzyc: " << vertexPath << std::endl;
-            return false;
-        }
-        std::stringstream vShaderStream;
-        vShaderStream << vShaderFile.rdbuf();
-        vertexCode = vShaderStream.str();
-        vShaderFile.close();
-
-        // Wczytaj fragment shader
-        std::ifstream fShaderFile(fragmentPath);
-        if (!fShaderFile.is_open()) {
-            std::cerr << "Nie mozna otworzyc: " << fragmentPath << std::endl;
-            return false;
-        }
-        std::stringstream fShaderStream;
-        fShaderStream << fShaderFile.rdbuf();
-        fragmentCode = fShaderStream.str();
-        fShaderFile.close();
-
-        // Opcjonalne shadery tessellation
-        bool hasTessellation = !tcsPath.empty() && !tesPath.empty();
-        if (hasTessellation) {
-            std::ifstream tcsFile(tcsPath);
-            if (tcsFile.is_open()) {
-                std::stringstream tcsStream;
-                tcsStream << tcsFile.rdbuf();
-                tcsCode = tcsStream.str();
-                tcsFile.close();
-            }
-
-            std::ifstream tesFile(tesPath);
-            if (tesFile.is_open()) {
-                std::stringstream tesStream;
-                tesStream << tesFile.rdbuf();
-                tesCode = tesStream.str();
-                tesFile.close();
-            }
-        }
-
-        // Kompilacja
-        unsigned int vertex, fragment, tcs = 0, tes = 0;
-        int success;
-        char infoLog[512];
-
-        // Vertex
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        const char* vCode = vertexCode.c_str();
-        glShaderSource(vertex, 1, &vCode, NULL);
-        glCompileShader(vertex);
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-            std::cerr << "Blad vertex shader:\n" << infoLog << std::endl;
-            return false;
-        }
-
-        // Fragment
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        const char* fCode = fragmentCode.c_str();
-        glShaderSource(fragment, 1, &fCode, NULL);
-        glCompileShader(fragment);
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-            std::cerr << "Blad fragment shader:\n" << infoLog << std::endl;
-            return false;
-        }
-
-        // Tessellation Control
-        if (hasTessellation && !tcsCode.empty()) {
-            tcs = glCreateShader(GL_TESS_CONTROL_SHADER);
-            const char* tcsCodePtr = tcsCode.c_str();
-            glShaderSource(tcs, 1, &tcsCodePtr, NULL);
-            glCompileShader(tcs);
-            glGetShaderiv(tcs, GL_COMPILE_STATUS, &success);
-            if (!success) {
-                glGetShaderInfoLog(tcs, 512, NULL, infoLog);
-                std::cerr << "Blad TCS shader:\n" << infoLog << std::endl;
-                return false;
-            }
-        }
-
-        // Tessellation Evaluation
-        if (hasTessellation && !tesCode.empty()) {
-            tes = glCreateShader(GL_TESS_EVALUATION_SHADER);
-            const char* tesCodePtr = tesCode.c_str();
-            glShaderSource(tes, 1, &tesCodePtr, NULL);
-            glCompileShader(tes);
-            glGetShaderiv(tes, GL_COMPILE_STATUS, &success);
-            if (!success) {
-                glGetShaderInfoLog(tes, 512, NULL, infoLog);
-                std::cerr << "Blad TES shader:\n" << infoLog << std::endl;
-                return false;
-            }
-        }
-
-        // Linkowanie
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if (hasTessellation) {
-            if (tcs) glAttachShader(ID, tcs);
-            if (tes) glAttachShader(ID, tes);
-        }
-        glLinkProgram(ID);
-        glGetProgramiv(ID, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(ID, 512, NULL, infoLog);
-            std::cerr << "Blad linkowania:\n" << infoLog << std::endl;
-            return false;
-        }
-
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if (tcs) glDeleteShader(tcs);
-        if (tes) glDeleteShader(tes);
-
-        return true;
-    }
-
-    void use() { glUseProgram(ID); }
-
-    void setBool(const std::string& name, bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
-    }
-    void setInt(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-    }
-    void setFloat(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
-    }
-    void setVec2(const std::string& name, const glm::vec2& value) const {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
-    }
-    void setVec3(const std::string& name, const glm::vec3& value) const {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
-    }
-    void setMat3(const std::string& name, const glm::mat3& mat) const {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
-    }
-    void setMat4(const std::string& name, const glm::mat4& mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
-    }
-};
+bool adaptiveTessellation = true;
+float tessTriangleSize = 8.0f;   // docelowa dlugosc krawedzi trojkata w pikselach
+
+// Frustum culling (BVH)
+bool cullingEnabled = true;
+
+// Poziomy szczegolowosci wg rozmiaru na ekranie
+bool lodEnabled = true;
+
+// Tryb odroczony: przebieg geometrii do G-buffera + oswietlenie raz na piksel
+bool deferredShading = false;
+
+// Cienie dwoch pierwszych reflektorow i swiatel punktowych (mapy z cache)
+bool shadowsEnabled = true;
+
+// Pre-pass glebokosci (cieniowanie z GL_EQUAL) i sortowanie nieprzezroczystych od przodu
+bool depthPrepass = false;
+bool sortFrontToBack = false;
+
+// Budzet pamieci tekstur strumieniowanych (--texture-budget)
+size_t textureBudgetBytes = TEXTURE_BUDGET_DEFAULT;
+
+// Kolejka rysowania sortowana wg stanu (program, culling, VAO, material);
+// wylaczona - kolejnosc dodania (lub sama glebokosc przy sortFrontToBack).
+// Z sortFrontToBack zgrubna glebokosc idzie przed stanem (render_queue.h)
+bool stateSorting = true;
+
+// Czas animacji sceny - czas symulacji (interpolowany z taktow watku symulacji,
+// w benchmarku ze stalym krokiem skryptu)
+float sceneTime = 0.0f;
+
+// Docelowy framebuffer sceny: 0 = okno, w trybie headless - FBO
+unsigned int outputFramebuffer = 0;
+int viewportWidth = SCR_WIDTH;
+int viewportHeight = SCR_HEIGHT;
+
+// Cel przebiegow 3D klatki: outputFramebuffer albo cel dynamicznej
+// rozdzielczosci (rozmiar viewportu x skala) - ustawiane w renderScene
+unsigned int sceneFramebuffer = 0;
+int sceneWidth = SCR_WIDTH;
+int sceneHeight = SCR_HEIGHT;
+
+// Dynamiczna rozdzielczosc (U): skala z regulatora czasu GPU klatki w
+// granicach min/max; wylaczona - stala skala renderScale (1.0 = natywna)
+bool dynamicResolution = false;
+float renderScale = 1.0f;
+float resolutionTargetMs = RESOLUTION_TARGET_MS_DEFAULT;
+float resolutionMinScale = RESOLUTION_MIN_SCALE_DEFAULT;
+float resolutionMaxScale = RESOLUTION_MAX_SCALE_DEFAULT;
+
+// Profiler klatki i nakladka ze statystykami (F1), zapis trace (F2)
+FrameProfiler profiler;
+bool showOverlay = false;
+bool traceRequested = false;
+const int TRACE_CAPTURE_FRAMES = 120;
+const char* TRACE_PATH = "trace.json";
+// Raport kosztu wariantow shaderow (F3) - wypisywany z petli glownej
+bool shaderReportRequested = false;
 
 // ============== MESH DATA ==============
-struct Mesh {
-    unsigned int VAO, VBO, EBO;
-    unsigned int indexCount;
-};
-
+// Siatki trojkatow leza we wspolnej GeometryPool (uchwyty Mesh, patrz mesh.h).
+// Plat Beziera ma inny format (same punkty kontrolne, GL_PATCHES) - osobne VAO.
 // Generowanie kuli
-Mesh createSphere(int sectors, int stacks) {
-    Mesh mesh;
+Mesh createSphere(GeometryPool& pool, int sectors, int stacks) {
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
 
@@ -266,40 +193,13 @@ Mesh createSphere(int sectors, int stacks) {
         }
     }
 
-    mesh.indexCount = indices.size();
-
-    glGenVertexArrays(1, &mesh.VAO);
-    glGenBuffers(1, &mesh.VBO);
-    glGenBuffers(1, &mesh.EBO);
-
-    glBindVertexArray(mesh.VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    // Pozycja
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // Normalna
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // UV
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
-
-    return mesh;
+    return uploadMesh(pool, vertices, indices, "sfera");
 }
 
 // Generowanie szescianu
-Mesh createCube() {
-    Mesh mesh;
+Mesh createCube(GeometryPool& pool) {
 
-    float vertices[] = {
+    std::vector<float> vertices = {
         // Pozycja          Normalna           UV
         // Front
         -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 0.0f,
@@ -333,7 +233,7 @@ Mesh createCube() {
         -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
     };
 
-    unsigned int indices[] = {
+    std::vector<unsigned int> indices = {
         0, 1, 2, 2, 3, 0,       // Front
         4, 6, 5, 6, 4, 7,       // Back
         8, 9, 10, 10, 11, 8,    // Left
@@ -342,38 +242,14 @@ Mesh createCube() {
         20, 22, 21, 22, 20, 23  // Bottom
     };
 
-    mesh.indexCount = 36;
-
-    glGenVertexArrays(1, &mesh.VAO);
-    glGenBuffers(1, &mesh.VBO);
-    glGenBuffers(1, &mesh.EBO);
-
-    glBindVertexArray(mesh.VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
-
-    return mesh;
+    return uploadMesh(pool, vertices, indices, "szescian");
 }
 
 // Generowanie podlogi (plaski kwadrat)
-Mesh createPlane(float size) {
-    Mesh mesh;
+Mesh createPlane(GeometryPool& pool, float size) {
 
     float halfSize = size / 2.0f;
-    float vertices[] = {
+    std::vector<float> vertices = {
         // Pozycja              Normalna          UV (0-1)
         -halfSize, 0.0f, -halfSize,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f,
          halfSize, 0.0f, -halfSize,  0.0f, 1.0f, 0.0f,  1.0f, 0.0f,
@@ -381,39 +257,15 @@ Mesh createPlane(float size) {
         -halfSize, 0.0f,  halfSize,  0.0f, 1.0f, 0.0f,  0.0f, 1.0f,
     };
 
-    unsigned int indices[] = {
+    std::vector<unsigned int> indices = {
         0, 1, 2, 2, 3, 0
     };
 
-    mesh.indexCount = 6;
-
-    glGenVertexArrays(1, &mesh.VAO);
-    glGenBuffers(1, &mesh.VBO);
-    glGenBuffers(1, &mesh.EBO);
-
-    glBindVertexArray(mesh.VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
-
-    return mesh;
+    return uploadMesh(pool, vertices, indices, "podloga");
 }
 
 // Generowanie torusa
-Mesh createTorus(float innerRadius, float outerRadius, int rings, int sides) {
-    Mesh mesh;
+Mesh createTorus(GeometryPool& pool, float innerRadius, float outerRadius, int rings, int sides) {
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
 
@@ -465,88 +317,34 @@ Mesh createTorus(float innerRadius, float outerRadius, int rings, int sides) {
         }
     }
 
-    mesh.indexCount = indices.size();
-
-    glGenVertexArrays(1, &mesh.VAO);
-    glGenBuffers(1, &mesh.VBO);
-    glGenBuffers(1, &mesh.EBO);
-
-    glBindVertexArray(mesh.VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
-
-    return mesh;
+    return uploadMesh(pool, vertices, indices, "torus");
 }
 
 // Generowanie platu Beziera (16 punktow kontrolnych)
-Mesh createBezierPatch() {
-    Mesh mesh;
-
-    // 16 punktow kontrolnych dla platu bikubicznego Beziera (flaga)
-    // Flaga jest pionowa, przymocowana przy maszcie (x=0)
+void createFlagSurface(BezierSurface& surface) {
+    // Flaga z dwoch platow bikubicznych Beziera (siatka 7x4 punktow kontrolnych,
+    // srodkowa kolumna wspolna). Flaga jest pionowa, przymocowana przy maszcie (x=0)
     // u - kierunek poziomy (od masztu w prawo)
     // v - kierunek pionowy (od dolu do gory)
+    const int patchesU = 2, patchesV = 1;
+    const int pointsU = 3 * patchesU + 1, pointsV = 3 * patchesV + 1;
     float flagWidth = 1.5f;
     float flagHeight = 1.0f;
     float flagBottom = 2.3f;  // Wysokosc dolnej krawedzi flagi
 
-    std::vector<float> controlPoints = {
-        // Wiersz 0 (u=0 - przy maszcie)
-        0.0f, flagBottom + 0.0f * flagHeight / 3.0f, 0.0f,
-        0.0f, flagBottom + 1.0f * flagHeight / 3.0f, 0.0f,
-        0.0f, flagBottom + 2.0f * flagHeight / 3.0f, 0.0f,
-        0.0f, flagBottom + 3.0f * flagHeight / 3.0f, 0.0f,
-        // Wiersz 1
-        flagWidth / 3.0f, flagBottom + 0.0f * flagHeight / 3.0f, 0.0f,
-        flagWidth / 3.0f, flagBottom + 1.0f * flagHeight / 3.0f, 0.0f,
-        flagWidth / 3.0f, flagBottom + 2.0f * flagHeight / 3.0f, 0.0f,
-        flagWidth / 3.0f, flagBottom + 3.0f * flagHeight / 3.0f, 0.0f,
-        // Wiersz 2
-        2.0f * flagWidth / 3.0f, flagBottom + 0.0f * flagHeight / 3.0f, 0.0f,
-        2.0f * flagWidth / 3.0f, flagBottom + 1.0f * flagHeight / 3.0f, 0.0f,
-        2.0f * flagWidth / 3.0f, flagBottom + 2.0f * flagHeight / 3.0f, 0.0f,
-        2.0f * flagWidth / 3.0f, flagBottom + 3.0f * flagHeight / 3.0f, 0.0f,
-        // Wiersz 3 (u=1 - swobodna krawedz)
-        flagWidth, flagBottom + 0.0f * flagHeight / 3.0f, 0.0f,
-        flagWidth, flagBottom + 1.0f * flagHeight / 3.0f, 0.0f,
-        flagWidth, flagBottom + 2.0f * flagHeight / 3.0f, 0.0f,
-        flagWidth, flagBottom + 3.0f * flagHeight / 3.0f, 0.0f,
-    };
-
-    glGenVertexArrays(1, &mesh.VAO);
-    glGenBuffers(1, &mesh.VBO);
-
-    glBindVertexArray(mesh.VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, controlPoints.size() * sizeof(float), controlPoints.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindVertexArray(0);
-
-    mesh.indexCount = 16; // 16 punktow kontrolnych
-
-    return mesh;
+    std::vector<glm::vec3> points;
+    for (int i = 0; i < pointsU; ++i) {
+        for (int j = 0; j < pointsV; ++j) {
+            points.push_back(glm::vec3(flagWidth * i / (pointsU - 1),
+                                       flagBottom + flagHeight * j / (pointsV - 1), 0.0f));
+        }
+    }
+    surface.setGrid(points, patchesU, patchesV);
+    surface.upload();
 }
 
 // Generowanie masztu (cylinder)
-Mesh createCylinder(float radius, float height, int segments) {
-    Mesh mesh;
+Mesh createCylinder(GeometryPool& pool, float radius, float height, int segments) {
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
 
@@ -588,67 +386,167 @@ Mesh createCylinder(float radius, float height, int segments) {
         indices.push_back(base + 3);
     }
 
-    mesh.indexCount = indices.size();
+    return uploadMesh(pool, vertices, indices, "maszt");
+}
 
-    glGenVertexArrays(1, &mesh.VAO);
-    glGenBuffers(1, &mesh.VBO);
-    glGenBuffers(1, &mesh.EBO);
+// ============== LANCUCHY LOD GENERATOROW ==============
+// Kolejne poziomy z rzadszej siatki tego samego ksztaltu (progi w lod.h)
+LodChain createSphereLods(GeometryPool& pool) {
+    const int levels[][2] = {{32, 16}, {16, 8}, {10, 6}, {6, 4}};
+    LodChain lods;
+    for (const int* level : levels) lods.add(createSphere(pool, level[0], level[1]));
+    return lods;
+}
 
-    glBindVertexArray(mesh.VAO);
+LodChain createTorusLods(GeometryPool& pool) {
+    const int levels[][2] = {{32, 16}, {16, 8}, {10, 6}, {6, 4}};
+    LodChain lods;
+    for (const int* level : levels) lods.add(createTorus(pool, 0.3f, 0.8f, level[0], level[1]));
+    return lods;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+LodChain createCylinderLods(GeometryPool& pool) {
+    const int levels[] = {16, 8, 5};
+    LodChain lods;
+    for (int segments : levels) lods.add(createCylinder(pool, 0.05f, 3.5f, segments));
+    return lods;
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+// ============== DODATKOWE SWIATLA (--lights) ==============
+// Nocna ulica: latarnie na siatce wokol sceny i reflektory pojazdow jezdzacych
+// po okregach. Opis w ukladzie swiata, do ukladu kamery przeliczany co klatke.
+struct StreetLamp {
+    glm::vec3 position;
+    glm::vec3 color;
+};
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+struct Vehicle {
+    float radius;   // promien okregu wokol srodka sceny
+    float speed;    // rad/s, znak - kierunek jazdy
+    float phase;
+};
 
-    glBindVertexArray(0);
+struct StreetLights {
+    std::vector<StreetLamp> lamps;
+    std::vector<Vehicle> vehicles;
+};
 
-    return mesh;
+// Trzy czwarte latarni, reszta reflektorow; staly seed jak w scenie obciazeniowej
+void populateStreetLights(StreetLights& lights, int count) {
+    const float spacing = 4.0f;
+    std::mt19937 rng(2468);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    int lampCount = count - count / 4;
+    int side = (int)std::ceil(std::sqrt((float)lampCount));
+    float origin = -0.5f * (side - 1) * spacing;
+    for (int i = 0; i < lampCount; ++i) {
+        StreetLamp lamp;
+        lamp.position = glm::vec3(origin + (i % side) * spacing, 3.0f, origin + (i / side) * spacing);
+        lamp.color = glm::mix(glm::vec3(1.0f, 0.75f, 0.45f), glm::vec3(0.8f, 0.85f, 1.0f), unit(rng));
+        lights.lamps.push_back(lamp);
+    }
+    for (int i = lampCount; i < count; ++i) {
+        Vehicle vehicle;
+        vehicle.radius = 12.0f + std::floor(unit(rng) * 8.0f) * spacing;
+        vehicle.speed = (unit(rng) < 0.5f ? -1.0f : 1.0f) * (4.0f + 4.0f * unit(rng)) / vehicle.radius;
+        vehicle.phase = unit(rng) * 6.2831853f;
+        lights.vehicles.push_back(vehicle);
+    }
+    std::cout << "Swiatla: " << lights.lamps.size() << " latarni, " << lights.vehicles.size()
+              << " reflektorow pojazdow" << std::endl;
+}
+
+void addStreetLights(LightClusters& clusters, const StreetLights& street, const glm::mat4& view) {
+    for (const StreetLamp& lamp : street.lamps) {
+        PointLightStd140 light;
+        light.position = glm::vec3(view * glm::vec4(lamp.position, 1.0f));
+        light.ambient = glm::vec3(0.0f);
+        light.diffuse = lamp.color * 0.8f;
+        light.specular = glm::vec3(0.3f);
+        light.constant = 1.0f;
+        light.linear = 0.7f;
+        light.quadratic = 1.8f;
+        light._pad0 = 0.0f;
+        clusters.pointLights.push_back(light);
+    }
+    for (const Vehicle& vehicle : street.vehicles) {
+        float angle = vehicle.phase + sceneTime * vehicle.speed;
+        glm::vec3 position(vehicle.radius * std::cos(angle), 0.6f, vehicle.radius * std::sin(angle));
+        // Styczna do okregu w kierunku jazdy, lekko w dol
+        float forward = vehicle.speed < 0.0f ? -1.0f : 1.0f;
+        glm::vec3 direction = glm::normalize(glm::vec3(-std::sin(angle) * forward, -0.08f, std::cos(angle) * forward));
+
+        SpotLightStd140 light;
+        light.position = glm::vec3(view * glm::vec4(position, 1.0f));
+        light.direction = glm::vec3(view * glm::vec4(direction, 0.0f));
+        light.ambient = glm::vec3(0.0f);   // tylko stozek - ciasniejsza sfera klastrow
+        light.diffuse = glm::vec3(2.0f, 2.0f, 1.8f);
+        light.specular = glm::vec3(1.0f);
+        light.constant = 1.0f;
+        light.linear = 0.22f;
+        light.quadratic = 0.44f;
+        light.cutOff = glm::cos(glm::radians(20.0f));
+        light.outerCutOff = glm::cos(glm::radians(30.0f));
+        clusters.spotLights.push_back(light);
+    }
 }
 
 // ============== USTAWIANIE UNIFORMOW SWIATLA ==============
-void setLightUniforms(Shader& shader, const glm::mat4& view) {
-    shader.setInt("numPointLights", 2);
-    shader.setInt("numSpotLights", 2);
+// Wypelnia blok FrameData i listy swiatel klastrow; wysylanie odbywa sie
+// w UniformBuffers::upload i LightClusters::upload, raz na klatke dla
+// wszystkich shaderow.
+// Swiatla z mapami cieni (dwa pierwsze punktowe i reflektory) przekazuja tez
+// pozycje w ukladzie swiata do ShadowMaps - niezmieniony widok nie jest przerysowywany
+void updateFrameUniforms(UniformBuffers& ubo, LightClusters& clusters, ShadowMaps& shadows,
+                         const StreetLights& street, const glm::mat4& view, const glm::mat4& projection,
+                         const glm::vec3& headlightPos) {
+    FrameUniformsStd140& frame = ubo.frame;
+    frame.view = view;
+    frame.projection = projection;
+    frame.clusterDepthScale = clusterDepthScale();
+    frame.clusterDepthBias = clusterDepthBias();
+    clusters.clear();
 
-    // Material - nizszy shininess = wiekszy, bardziej rozproszony highlight
-    shader.setVec3("material.ambient", glm::vec3(0.25f));
-    shader.setVec3("material.diffuse", glm::vec3(0.9f));
-    shader.setVec3("material.specular", glm::vec3(0.6f));  // Mniej intensywny specular
-    shader.setFloat("material.shininess", 12.0f);          // Wiekszy highlight (bylo 32)
+    // Efekty
+    frame.fogEnabled = fogEnabled;
+    frame.fogDensity = fogDensity;
+    frame.fogColor = glm::vec3(0.5f, 0.6f, 0.7f);
+    frame.dayNightFactor = dayNightFactor;
+    frame.useBlinn = useBlinn;
+    frame.time = sceneTime;
+    frame.viewportSize = glm::vec2((float)sceneWidth, (float)sceneHeight);
 
     // Swiatlo punktowe 1 - stale (lampa uliczna)
+    PointLightStd140 pointLight1;
     glm::vec3 pointLight1Pos(3.0f, 4.0f, 3.0f);
-    glm::vec3 pointLight1PosView = glm::vec3(view * glm::vec4(pointLight1Pos, 1.0f));
-    shader.setVec3("pointLights[0].position", pointLight1PosView);
-    shader.setVec3("pointLights[0].ambient", glm::vec3(0.1f) * dayNightFactor);
-    shader.setVec3("pointLights[0].diffuse", glm::vec3(1.0f, 0.9f, 0.7f) * dayNightFactor);
-    shader.setVec3("pointLights[0].specular", glm::vec3(1.0f) * dayNightFactor);
-    shader.setFloat("pointLights[0].constant", 1.0f);
-    shader.setFloat("pointLights[0].linear", 0.22f);      // Szybsze zanikanie
-    shader.setFloat("pointLights[0].quadratic", 0.20f);   // Szybsze zanikanie
+    pointLight1.position = glm::vec3(view * glm::vec4(pointLight1Pos, 1.0f));
+    pointLight1.ambient = glm::vec3(0.1f) * dayNightFactor;
+    pointLight1.diffuse = glm::vec3(1.0f, 0.9f, 0.7f) * dayNightFactor;
+    pointLight1.specular = glm::vec3(1.0f) * dayNightFactor;
+    pointLight1.constant = 1.0f;
+    pointLight1.linear = 0.22f;      // Szybsze zanikanie
+    pointLight1.quadratic = 0.20f;   // Szybsze zanikanie
+    pointLight1._pad0 = 0.0f;
+    clusters.pointLights.push_back(pointLight1);
+    shadows.setPointLight(0, pointLight1Pos);
 
     // Swiatlo punktowe 2 - stale (druga lampa)
+    PointLightStd140 pointLight2;
     glm::vec3 pointLight2Pos(-4.0f, 3.0f, -2.0f);
-    glm::vec3 pointLight2PosView = glm::vec3(view * glm::vec4(pointLight2Pos, 1.0f));
-    shader.setVec3("pointLights[1].position", pointLight2PosView);
-    shader.setVec3("pointLights[1].ambient", glm::vec3(0.05f));
-    shader.setVec3("pointLights[1].diffuse", glm::vec3(0.5f, 0.5f, 1.0f));
-    shader.setVec3("pointLights[1].specular", glm::vec3(0.5f));
-    shader.setFloat("pointLights[1].constant", 1.0f);
-    shader.setFloat("pointLights[1].linear", 0.35f);      // Szybsze zanikanie
-    shader.setFloat("pointLights[1].quadratic", 0.44f);   // Szybsze zanikanie
+    pointLight2.position = glm::vec3(view * glm::vec4(pointLight2Pos, 1.0f));
+    pointLight2.ambient = glm::vec3(0.05f);
+    pointLight2.diffuse = glm::vec3(0.5f, 0.5f, 1.0f);
+    pointLight2.specular = glm::vec3(0.5f);
+    pointLight2.constant = 1.0f;
+    pointLight2.linear = 0.35f;      // Szybsze zanikanie
+    pointLight2.quadratic = 0.44f;   // Szybsze zanikanie
+    pointLight2._pad0 = 0.0f;
+    clusters.pointLights.push_back(pointLight2);
+    shadows.setPointLight(1, pointLight2Pos);
 
     // Reflektor 1 - na ruchomym obiekcie (reflektor samochodu)
-    glm::vec3 spotLightPos = movingObjectPos + glm::vec3(0.0f, 0.3f, 0.0f);
+    glm::vec3 spotLightPos = headlightPos;
 
     // Oblicz kierunek reflektora z uwzglednieniem kierunku obiektu i recznej regulacji
     float totalYaw = movingObjectAngle + spotlightYaw;
@@ -658,50 +556,48 @@ void setLightUniforms(Shader& shader, const glm::mat4& view) {
     spotLightDir.z = cos(glm::radians(spotlightPitch)) * cos(glm::radians(totalYaw));
     spotLightDir = glm::normalize(spotLightDir);
 
-    glm::vec3 spotLightPosView = glm::vec3(view * glm::vec4(spotLightPos, 1.0f));
-    glm::vec3 spotLightDirView = glm::normalize(glm::vec3(view * glm::vec4(spotLightDir, 0.0f)));
-
-    shader.setVec3("spotLights[0].position", spotLightPosView);
-    shader.setVec3("spotLights[0].direction", spotLightDirView);
-    shader.setVec3("spotLights[0].ambient", glm::vec3(0.05f));
-    shader.setVec3("spotLights[0].diffuse", glm::vec3(2.5f, 2.5f, 2.0f));  // Mocniejszy reflektor
-    shader.setVec3("spotLights[0].specular", glm::vec3(2.0f));              // Mocniejszy blask
-    shader.setFloat("spotLights[0].constant", 1.0f);
-    shader.setFloat("spotLights[0].linear", 0.14f);       // Umiarkowane zanikanie
-    shader.setFloat("spotLights[0].quadratic", 0.07f);    // Umiarkowane zanikanie
-    shader.setFloat("spotLights[0].cutOff", glm::cos(glm::radians(15.0f)));    // Szerszy stożek
-    shader.setFloat("spotLights[0].outerCutOff", glm::cos(glm::radians(25.0f))); // Szerszy stożek
+    SpotLightStd140 spotLight1;
+    spotLight1.position = glm::vec3(view * glm::vec4(spotLightPos, 1.0f));
+    spotLight1.direction = glm::normalize(glm::vec3(view * glm::vec4(spotLightDir, 0.0f)));
+    spotLight1.ambient = glm::vec3(0.05f);
+    spotLight1.diffuse = glm::vec3(2.5f, 2.5f, 2.0f);  // Mocniejszy reflektor
+    spotLight1.specular = glm::vec3(2.0f);             // Mocniejszy blask
+    spotLight1.constant = 1.0f;
+    spotLight1.linear = 0.14f;       // Umiarkowane zanikanie
+    spotLight1.quadratic = 0.07f;    // Umiarkowane zanikanie
+    spotLight1.cutOff = glm::cos(glm::radians(15.0f));      // Szerszy stożek
+    spotLight1.outerCutOff = glm::cos(glm::radians(25.0f)); // Szerszy stożek
+    clusters.spotLights.push_back(spotLight1);
+    shadows.setSpotLight(0, spotLightPos, spotLightDir, 25.0f);
 
     // Reflektor 2 - staly (reflektor sceny)
     glm::vec3 spotLight2Pos(0.0f, 6.0f, 0.0f);
     glm::vec3 spotLight2Dir(0.0f, -1.0f, 0.0f);
 
-    glm::vec3 spotLight2PosView = glm::vec3(view * glm::vec4(spotLight2Pos, 1.0f));
-    glm::vec3 spotLight2DirView = glm::normalize(glm::vec3(view * glm::vec4(spotLight2Dir, 0.0f)));
-
-    shader.setVec3("spotLights[1].position", spotLight2PosView);
-    shader.setVec3("spotLights[1].direction", spotLight2DirView);
-    shader.setVec3("spotLights[1].ambient", glm::vec3(0.0f));
-    shader.setVec3("spotLights[1].diffuse", glm::vec3(0.8f) * dayNightFactor);
-    shader.setVec3("spotLights[1].specular", glm::vec3(0.5f) * dayNightFactor);
-    shader.setFloat("spotLights[1].constant", 1.0f);
-    shader.setFloat("spotLights[1].linear", 0.045f);
-    shader.setFloat("spotLights[1].quadratic", 0.0075f);
-    shader.setFloat("spotLights[1].cutOff", glm::cos(glm::radians(25.0f)));
-    shader.setFloat("spotLights[1].outerCutOff", glm::cos(glm::radians(35.0f)));
-
-    // Efekty
-    shader.setBool("fogEnabled", fogEnabled);
-    shader.setFloat("fogDensity", fogDensity);
-    shader.setVec3("fogColor", glm::vec3(0.5f, 0.6f, 0.7f));
-    shader.setFloat("dayNightFactor", dayNightFactor);
-    shader.setBool("useBlinn", useBlinn);
-    shader.setBool("useTexture", false);
+    SpotLightStd140 spotLight2;
+    spotLight2.position = glm::vec3(view * glm::vec4(spotLight2Pos, 1.0f));
+    spotLight2.direction = glm::normalize(glm::vec3(view * glm::vec4(spotLight2Dir, 0.0f)));
+    spotLight2.ambient = glm::vec3(0.0f);
+    spotLight2.diffuse = glm::vec3(0.8f) * dayNightFactor;
+    spotLight2.specular = glm::vec3(0.5f) * dayNightFactor;
+    spotLight2.constant = 1.0f;
+    spotLight2.linear = 0.045f;
+    spotLight2.quadratic = 0.0075f;
+    spotLight2.cutOff = glm::cos(glm::radians(25.0f));
+    spotLight2.outerCutOff = glm::cos(glm::radians(35.0f));
+    clusters.spotLights.push_back(spotLight2);
+    shadows.setSpotLight(1, spotLight2Pos, spotLight2Dir, 35.0f);
+
+    addStreetLights(clusters, street, view);
+    frame.numPointLights = (int)clusters.pointLights.size();
+    frame.numSpotLights = (int)clusters.spotLights.size();
 }
 
 // ============== CALLBACK FUNKCJE ==============
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    viewportWidth = width;
+    viewportHeight = height;
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
@@ -731,8 +627,14 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                 std::cout << "Model: " << (useBlinn ? "Blinn-Phong" : "Phong") << std::endl;
                 break;
             case GLFW_KEY_N:
-                dayNightFactor = (dayNightFactor > 0.5f) ? 0.0f : 1.0f;
-                std::cout << "Pora dnia: " << (dayNightFactor > 0.5f ? "Dzien" : "Noc") << std::endl;
+                // Stan zmienia watek symulacji w najblizszym takcie
+                if (simulation.running()) {
+                    simulation.post(SIM_COMMAND_TOGGLE_DAY_NIGHT);
+                    std::cout << "Pora dnia: " << (dayNightFactor > 0.5f ? "Noc" : "Dzien") << std::endl;
+                } else {
+                    dayNightFactor = (dayNightFactor > 0.5f) ? 0.0f : 1.0f;
+                    std::cout << "Pora dnia: " << (dayNightFactor > 0.5f ? "Dzien" : "Noc") << std::endl;
+                }
                 break;
             case GLFW_KEY_KP_ADD:
             case GLFW_KEY_EQUAL:
@@ -752,6 +654,10 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                 tessLevel = std::max(tessLevel - 2, 2);
                 std::cout << "Tessellation level: " << tessLevel << std::endl;
                 break;
+            case GLFW_KEY_V:
+                adaptiveTessellation = !adaptiveTessellation;
+                std::cout << "Adaptacyjna tessellation: " << (adaptiveTessellation ? "ON" : "OFF") << std::endl;
+                break;
             case GLFW_KEY_Y:
                 windStrength = std::min(windStrength + 0.1f, 1.0f);
                 std::cout << "Sila wiatru: " << windStrength << std::endl;
@@ -760,351 +666,1675 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                 windStrength = std::max(windStrength - 0.1f, 0.0f);
                 std::cout << "Sila wiatru: " << windStrength << std::endl;
                 break;
+            case GLFW_KEY_C:
+                cullingEnabled = !cullingEnabled;
+                std::cout << "Frustum culling: " << (cullingEnabled ? "ON" : "OFF") << std::endl;
+                break;
+            case GLFW_KEY_L:
+                lodEnabled = !lodEnabled;
+                std::cout << "LOD: " << (lodEnabled ? "ON" : "OFF") << std::endl;
+                break;
+            case GLFW_KEY_R:
+                deferredShading = !deferredShading;
+                std::cout << "Cieniowanie: " << (deferredShading ? "DEFERRED" : "FORWARD") << std::endl;
+                break;
+            case GLFW_KEY_K:
+                shadowsEnabled = !shadowsEnabled;
+                std::cout << "Cienie: " << (shadowsEnabled ? "ON" : "OFF") << std::endl;
+                break;
+            case GLFW_KEY_Z:
+                depthPrepass = !depthPrepass;
+                std::cout << "Pre-pass glebokosci: " << (depthPrepass ? "ON" : "OFF") << std::endl;
+                break;
+            case GLFW_KEY_X:
+                sortFrontToBack = !sortFrontToBack;
+                std::cout << "Sortowanie od przodu: " << (sortFrontToBack ? "ON" : "OFF") << std::endl;
+                break;
+            case GLFW_KEY_Q:
+                stateSorting = !stateSorting;
+                std::cout << "Sortowanie wg stanu: " << (stateSorting ? "ON" : "OFF") << std::endl;
+                break;
+            case GLFW_KEY_U:
+                dynamicResolution = !dynamicResolution;
+                std::cout << "Dynamiczna rozdzielczosc: " << (dynamicResolution ? "ON" : "OFF") << std::endl;
+                break;
+            case GLFW_KEY_F1:
+                showOverlay = !showOverlay;
+                break;
+            case GLFW_KEY_F2:
+                if (!profiler.isCapturing()) {
+                    profiler.startCapture(TRACE_CAPTURE_FRAMES);
+                    traceRequested = true;
+                    std::cout << "Nagrywanie trace (" << TRACE_CAPTURE_FRAMES << " klatek)..." << std::endl;
+                }
+                break;
+            case GLFW_KEY_F3:
+                shaderReportRequested = true;
+                break;
         }
     }
 }
 
+// Wcisniete klawisze dla watku symulacji (glfwGetKey tylko z watku okna)
 void processInput(GLFWwindow* window) {
-    // Sterowanie ruchomym obiektem
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-        movingObjectPos.x += sin(glm::radians(movingObjectAngle)) * movingObjectSpeed * deltaTime;
-        movingObjectPos.z += cos(glm::radians(movingObjectAngle)) * movingObjectSpeed * deltaTime;
-    }
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-        movingObjectPos.x -= sin(glm::radians(movingObjectAngle)) * movingObjectSpeed * deltaTime;
-        movingObjectPos.z -= cos(glm::radians(movingObjectAngle)) * movingObjectSpeed * deltaTime;
-    }
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-        movingObjectAngle += 90.0f * deltaTime;
-    }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-        movingObjectAngle -= 90.0f * deltaTime;
+    static const struct {
+        int key;
+        SimulationInput input;
+    } bindings[] = {
+        {GLFW_KEY_W, SIM_INPUT_FORWARD},      {GLFW_KEY_S, SIM_INPUT_BACK},
+        {GLFW_KEY_A, SIM_INPUT_TURN_LEFT},    {GLFW_KEY_D, SIM_INPUT_TURN_RIGHT},
+        {GLFW_KEY_LEFT, SIM_INPUT_SPOT_LEFT}, {GLFW_KEY_RIGHT, SIM_INPUT_SPOT_RIGHT},
+        {GLFW_KEY_UP, SIM_INPUT_SPOT_UP},     {GLFW_KEY_DOWN, SIM_INPUT_SPOT_DOWN},
+        {GLFW_KEY_P, SIM_INPUT_DAY},          {GLFW_KEY_O, SIM_INPUT_NIGHT},
+    };
+    unsigned int mask = 0;
+    for (const auto& binding : bindings) {
+        if (glfwGetKey(window, binding.key) == GLFW_PRESS) mask |= binding.input;
     }
+    simulation.setInput(mask);
+}
 
-    // Sterowanie kierunkiem reflektora
-    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-        spotlightYaw += 45.0f * deltaTime;
-    }
-    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-        spotlightYaw -= 45.0f * deltaTime;
-    }
-    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-        spotlightPitch = std::min(spotlightPitch + 30.0f * deltaTime, 45.0f);
+SimulationState currentSimulationState() {
+    SimulationState state;
+    state.movingObjectPos = movingObjectPos;
+    state.movingObjectAngle = movingObjectAngle;
+    state.spotlightYaw = spotlightYaw;
+    state.spotlightPitch = spotlightPitch;
+    state.dayNightFactor = dayNightFactor;
+    state.time = sceneTime;
+    return state;
+}
+
+void applySimulationState(const SimulationState& state) {
+    movingObjectPos = state.movingObjectPos;
+    movingObjectAngle = state.movingObjectAngle;
+    spotlightYaw = state.spotlightYaw;
+    spotlightPitch = state.spotlightPitch;
+    dayNightFactor = state.dayNightFactor;
+    sceneTime = (float)state.time;
+}
+
+// ============== SCENA ==============
+// Obiekt w BVH: instancja jednego z batchy albo wezel TransformStore
+enum CullKind {
+    CULL_CUBE_INSTANCE = 0,
+    CULL_SPHERE_INSTANCE = 1,
+    CULL_TORUS_INSTANCE = 2,
+    CULL_NODE = 3
+};
+
+struct CullObject {
+    CullKind kind;
+    int index;          // indeks instancji albo wezla
+    AABB localBounds;   // tylko dla wezlow - granice siatki
+};
+
+// Wezel rysowany glownym programem: siatka po wyborze LOD i glebokosc srodka w widoku
+struct NodeDraw {
+    int node;
+    const Mesh* mesh;
+    int material;
+    bool twoSided;
+    float depth;
+};
+
+struct Scene {
+    // Programy cieniowania - warianty cech (shader_variants.h) wybierane per material
+    ShaderVariants mainShader;
+    ShaderVariants bezierShader;
+    ShaderVariants instancedShader;
+    // Programy przebiegu geometrii trybu odroczonego (G-buffer)
+    ShaderVariants mainGBufferShader;
+    ShaderVariants bezierGBufferShader;
+    ShaderVariants instancedGBufferShader;
+    DeferredRenderer deferred;
+    bool deferredAvailable = false;
+    // Cel skalowanej rozdzielczosci i regulator; resolutionControlled - regulator
+    // dzialal w poprzedniej klatce (po wlaczeniu startuje od nowa)
+    DynamicResolution resolution;
+    bool resolutionAvailable = false;
+    bool resolutionControlled = false;
+    // Programy przebiegu glebokosci (mapy cieni, pre-pass)
+    Shader mainDepthShader;
+    Shader instancedDepthShader;
+    Shader bezierDepthShader;
+    ShadowMaps shadows;
+    bool shadowsAvailable = false;
+    UniformBuffers uniformBuffers;
+    // Oswietlenie klastrowe - przypisanie swiatel rownolegle w puli watkow
+    LightClusters lightClusters;
+    StreetLights streetLights;
+    WorkerPool workers;
+    TextOverlay overlay;
+    unsigned int defaultTexture;
+    // Tekstury materialow wczytywane w tle (--texture); boundDiffuse - tekstura
+    // na jednostce 0 w biezacych przebiegach
+    TextureStreamer textures;
+    unsigned int boundDiffuse = 0;
+
+    // Pula przed uchwytami - niszczona po nich
+    GeometryPool geometry;
+    Mesh cube, plane;
+    LodChain sphere, torus, cylinder;
+    // Powierzchnie Beziera: flaga na maszcie + choragwie, plik platow (--patches)
+    BezierSurface flags;
+    BezierSurface patchSurface;
+    AABB flagBounds, patchBounds;
+    AABB flagsWorldBounds;   // wszystkie egzemplarze flag (wiatr - zapas jak w cullingu)
+    LodChain model;   // opcjonalny model z pliku OBJ (--model)
+
+    // Obiekty statyczne - jeden draw call na siatke
+    InstanceBatch cubeInstances, sphereInstances, torusInstances;
+    // Te same obiekty w sciezce GPU-driven (GL 4.3+), gdy useGpuDriven
+    GpuDrivenRenderer gpuDriven;
+    bool useGpuDriven = false;
+
+    // Hierarchia transformacji obiektow rysowanych pojedynczo
+    TransformStore transforms;
+    int floorNode, movingNode, movingBodyNode, headlightNode, torusNode, mastNode, flagNode;
+    int modelNode = -1;
+    int patchNode = -1;
+
+    // Frustum culling
+    std::vector<CullObject> cullObjects;
+    std::vector<int> dynamicCullObjects;   // obiekty wymagajace refitu co klatke
+    Bvh bvh;
+    Frustum frustum;
+    std::vector<unsigned int> visibleInstances[3];   // wg CullKind
+    std::vector<unsigned char> nodeVisible;
+    std::vector<unsigned char> nodeLod;   // biezacy poziom LOD wezla (histereza)
+    std::vector<NodeDraw> nodeDraws;      // widoczne wezly biezacej klatki
+    RenderQueue renderQueue;              // komendy przebiegow glebokosci i cieniowania
+
+    // Indeksy materialow w buforze MaterialData i ich cechy wariantow shaderow
+    int floorMat, movingMat, torusMat, mastMat, flagMat, instancedMat, modelMat;
+    std::vector<unsigned int> materialFeatures;
+    std::vector<int> materialTextures;   // uchwyt TextureStreamer, -1 - bez tekstury
+
+    // Offsety ObjectData wezlow i SurfaceData w pierscieniu danych dynamicznych
+    // (biezaca klatka)
+    std::vector<size_t> nodeData;
+    size_t surfaceData = DYNAMIC_BUFFER_FULL;
+
+    // Wyniki zapytan BVH widokow swiatel (bufory wielokrotnego uzytku)
+    std::vector<unsigned int> shadowInstances[3];
+    std::vector<int> shadowNodes;
+
+    glm::mat4 projection;
+};
+
+// Scena obciazeniowa: count statycznych obiektow na siatce wokol podlogi.
+// Staly seed - kazde uruchomienie (i benchmark) widzi te sama scene.
+void populateStressScene(Scene& scene, int count) {
+    const float spacing = 0.6f;
+    const float floorHalfSize = 10.5f;   // podloga 20x20 + margines
+
+    // Bok kwadratu tak, by poza podloga zmiescilo sie count komorek
+    float floorCells = (2.0f * floorHalfSize / spacing) * (2.0f * floorHalfSize / spacing);
+    int side = (int)std::ceil(std::sqrt(count + floorCells));
+    float origin = -0.5f * side * spacing;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> jitter(-0.2f * spacing, 0.2f * spacing);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    // Macierze liczone hurtem (SIMD) w tymczasowym TransformStore
+    TransformStore stressTransforms;
+    stressTransforms.reserve(count);
+    std::vector<glm::vec3> colors;
+    colors.reserve(count);
+
+    for (int i = 0; i < side * side && (int)colors.size() < count; ++i) {
+        float x = origin + (i % side + 0.5f) * spacing;
+        float z = origin + (i / side + 0.5f) * spacing;
+        if (std::fabs(x) < floorHalfSize && std::fabs(z) < floorHalfSize) continue;
+
+        float scale = 0.12f + 0.12f * unit(rng);
+        x += jitter(rng);
+        z += jitter(rng);
+        float yaw = unit(rng) * 6.2831853f;
+        float r = 0.3f + 0.6f * unit(rng);
+        float g = 0.3f + 0.6f * unit(rng);
+        float b = 0.3f + 0.6f * unit(rng);
+
+        stressTransforms.addNode(glm::vec3(x, scale, z), glm::angleAxis(yaw, glm::vec3(0.0f, 1.0f, 0.0f)),
+                                 glm::vec3(scale));
+        colors.push_back(glm::vec3(r, g, b));
     }
-    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-        spotlightPitch = std::max(spotlightPitch - 30.0f * deltaTime, -45.0f);
+    stressTransforms.update();
+
+    InstanceBatch* batches[] = {&scene.cubeInstances, &scene.sphereInstances, &scene.torusInstances};
+    for (size_t i = 0; i < colors.size(); ++i) {
+        batches[i % 3]->add(stressTransforms.world((int)i), stressTransforms.normalMatrix((int)i), colors[i]);
     }
+    std::cout << "Scena obciazeniowa: " << colors.size() << " obiektow" << std::endl;
+}
 
-    // Plynna zmiana dnia/nocy
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS) {
-        dayNightFactor = std::min(dayNightFactor + 0.5f * deltaTime, 1.0f);
+// BVH nad wszystkimi obiektami sceny (po pierwszym przeliczeniu transformacji)
+// W sciezce GPU-driven instancje odrzuca compute shader - w BVH zostaja same wezly.
+void buildCulling(Scene& scene) {
+    InstanceBatch* batches[] = {&scene.cubeInstances, &scene.sphereInstances, &scene.torusInstances};
+    const Mesh* batchMeshes[] = {&scene.cube, &scene.sphere.level(0), &scene.torus.level(0)};
+    std::vector<AABB> bounds;
+
+    for (int kind = 0; kind < 3 && !scene.useGpuDriven; ++kind) {
+        const std::vector<InstanceData>& instances = batches[kind]->instances;
+        for (size_t i = 0; i < instances.size(); ++i) {
+            scene.cullObjects.push_back({(CullKind)kind, (int)i, AABB()});
+            bounds.push_back(transformAABB(batchMeshes[kind]->bounds, instances[i].model));
+        }
     }
-    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS) {
-        dayNightFactor = std::max(dayNightFactor - 0.5f * deltaTime, 0.0f);
+
+    struct NodeObject { int node; const AABB* bounds; bool dynamic; };
+    std::vector<NodeObject> nodeObjects = {
+        {scene.floorNode, &scene.plane.bounds, false},
+        {scene.movingBodyNode, &scene.cube.bounds, true},
+        {scene.torusNode, &scene.torus.bounds(), true},
+        {scene.mastNode, &scene.cylinder.bounds(), false},
+        {scene.flagNode, &scene.flagBounds, false},
+    };
+    if (scene.modelNode >= 0) nodeObjects.push_back({scene.modelNode, &scene.model.bounds(), false});
+    if (scene.patchNode >= 0) nodeObjects.push_back({scene.patchNode, &scene.patchBounds, false});
+    for (const NodeObject& object : nodeObjects) {
+        if (object.dynamic) scene.dynamicCullObjects.push_back((int)scene.cullObjects.size());
+        scene.cullObjects.push_back({CULL_NODE, object.node, *object.bounds});
+        bounds.push_back(transformAABB(*object.bounds, scene.transforms.world(object.node)));
     }
+
+    scene.bvh.build(bounds);
+    scene.nodeVisible.assign(scene.transforms.size(), 0);
+    scene.nodeLod.assign(scene.transforms.size(), 0);
 }
 
-// ============== MAIN ==============
-int main() {
-    // Inicjalizacja GLFW
-    if (!glfwInit()) {
-        std::cerr << "Nie mozna zainicjalizowac GLFW" << std::endl;
-        return -1;
+// Refit obiektow ruchomych i zapytanie BVH; wynik w visibleInstances/nodeVisible
+void updateCulling(Scene& scene, const glm::mat4& viewProjection) {
+    for (int object : scene.dynamicCullObjects) {
+        const CullObject& cull = scene.cullObjects[object];
+        scene.bvh.refit(object, transformAABB(cull.localBounds, scene.transforms.world(cull.index)));
     }
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
+    for (std::vector<unsigned int>& visible : scene.visibleInstances) visible.clear();
+    std::fill(scene.nodeVisible.begin(), scene.nodeVisible.end(), 0);
 
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Grafika Komputerowa - Projekt", NULL, NULL);
-    if (!window) {
-        std::cerr << "Nie mozna utworzyc okna GLFW" << std::endl;
-        glfwTerminate();
-        return -1;
+    unsigned int visibleCount = 0;
+    auto markVisible = [&scene, &visibleCount](int object) {
+        const CullObject& cull = scene.cullObjects[object];
+        if (cull.kind == CULL_NODE) {
+            scene.nodeVisible[cull.index] = 1;
+        } else {
+            scene.visibleInstances[cull.kind].push_back(cull.index);
+        }
+        ++visibleCount;
+    };
+
+    if (cullingEnabled) {
+        scene.frustum.extract(viewProjection);
+        scene.bvh.query(scene.frustum, markVisible);
+    } else {
+        for (size_t i = 0; i < scene.cullObjects.size(); ++i) markVisible((int)i);
     }
 
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetKeyCallback(window, key_callback);
+    frameCounters.visibleObjects += visibleCount;
+    frameCounters.culledObjects += (unsigned int)scene.cullObjects.size() - visibleCount;
+}
 
-    // Inicjalizacja GLEW
-    glewExperimental = GL_TRUE;
-    if (glewInit() != GLEW_OK) {
-        std::cerr << "Nie mozna zainicjalizowac GLEW" << std::endl;
-        return -1;
+// Pole choragwi za masztem: egzemplarze powierzchni flagi z losowa faza wiatru,
+// rysowane tym samym wywolaniem co flaga na maszcie
+void populateBanners(Scene& scene, int count) {
+    const int perRow = 10;
+    const float spacing = 2.0f;
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < count; ++i) {
+        float x = (i % perRow - 0.5f * (perRow - 1)) * spacing;
+        float z = -8.0f - (i / perRow) * spacing;
+        float yaw = (unit(rng) - 0.5f) * 0.6f;
+        glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, z)), yaw,
+                                      glm::vec3(0.0f, 1.0f, 0.0f));
+        scene.flags.add(model, glm::vec2(0.6f + 0.4f * unit(rng), unit(rng) * 6.2831853f));
     }
+    std::cout << "Choragwie: " << count << " (" << scene.flags.patchCount() * (count + 1)
+              << " platow w jednym wywolaniu)" << std::endl;
+}
 
+// Klatka ladowania (bez shaderow): tlo i pasek postepu przez glScissor + glClear,
+// postep takze w tytule okna
+void drawLoadingFrame(GLFWwindow* window, size_t ready, size_t total) {
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glClearColor(0.02f, 0.02f, 0.05f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    float progress = total > 0 ? (float)ready / (float)total : 0.0f;
+    int barWidth = width / 2;
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(width / 4, height / 2 - 4, barWidth, 8);
+    glClearColor(0.15f, 0.15f, 0.2f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glScissor(width / 4, height / 2 - 4, (int)(barWidth * progress), 8);
+    glClearColor(0.3f, 0.8f, 0.4f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+
+    char title[128];
+    std::snprintf(title, sizeof(title), "%s - kompilacja shaderow %zu/%zu", WINDOW_TITLE, ready, total);
+    glfwSetWindowTitle(window, title);
+    glfwSwapBuffers(window);
+    glfwPollEvents();
+}
+
+// Material w MaterialData wraz z cechami wariantow shaderow; texture >= 0
+// wlacza probkowanie tekstury strumieniowanej
+int addSceneMaterial(Scene& scene, MaterialStd140 material, int texture = -1) {
+    if (texture >= 0) material.useTexture = true;
+    scene.materialFeatures.push_back(materialFeatures(material));
+    scene.materialTextures.push_back(texture);
+    return scene.uniformBuffers.addMaterial(material);
+}
+
+// window == NULL w trybie headless - bez klatek ladowania
+bool initScene(Scene& scene, GLFWwindow* window, int stressObjects, bool gpuDriven, const std::string& modelPath,
+               int banners, const std::string& patchPath, int streetLights, const std::string& texturePath) {
     // Konfiguracja OpenGL
     glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    setCullFace(true);
 
     // Utworz domyslna biala teksture 1x1 (zapobiega bledowi samplera)
-    unsigned int defaultTexture;
-    glGenTextures(1, &defaultTexture);
-    glBindTexture(GL_TEXTURE_2D, defaultTexture);
+    glGenTextures(1, &scene.defaultTexture);
+    glBindTexture(GL_TEXTURE_2D, scene.defaultTexture);
     unsigned char whitePixel[] = {255, 255, 255, 255};
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, whitePixel);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    // Wczytaj shadery
-    Shader mainShader;
-    if (!mainShader.loadFromFiles("shaders/vertex.glsl", "shaders/fragment.glsl")) {
+    // Bufory uniform wspolne dla obu programow
+    if (!scene.uniformBuffers.init(16)) {
+        std::cerr << "Blad tworzenia buforow uniform" << std::endl;
+        return false;
+    }
+
+    if (!scene.lightClusters.init()) {
+        std::cerr << "Blad tworzenia buforow swiatel" << std::endl;
+        return false;
+    }
+    if (streetLights > 0) populateStreetLights(scene.streetLights, streetLights);
+
+    // Tekstura torusa i modelu - wczytywanie w tle, do tego czasu tekstura domyslna
+    if (!scene.textures.init(textureBudgetBytes)) {
+        std::cerr << "Blad tworzenia bufora wysylania tekstur" << std::endl;
+        return false;
+    }
+    int diffuseTexture = texturePath.empty() ? -1 : scene.textures.load(texturePath);
+
+    // Materialy - wysylane raz, w petli tylko przelaczany zakres bufora
+    MaterialStd140 floorMaterial = makeMaterial(glm::vec3(1.0f));
+    floorMaterial.useCheckerboard = true;
+    floorMaterial.checkerScale = 10.0f;                        // 10x10 kratek
+    floorMaterial.checkerColor1 = glm::vec3(0.5f, 0.5f, 0.5f);   // Szary jasny
+    floorMaterial.checkerColor2 = glm::vec3(0.25f, 0.25f, 0.25f); // Szary ciemny
+    scene.floorMat = addSceneMaterial(scene, floorMaterial);
+    scene.movingMat = addSceneMaterial(scene, makeMaterial(glm::vec3(0.8f, 0.2f, 0.2f)));
+    scene.torusMat = addSceneMaterial(scene, makeMaterial(glm::vec3(0.8f, 0.6f, 0.2f)), diffuseTexture);
+    scene.mastMat = addSceneMaterial(scene, makeMaterial(glm::vec3(0.4f, 0.3f, 0.2f)));
+    MaterialStd140 flagMaterial = makeMaterial(glm::vec3(1.0f));
+    flagMaterial.useFlagColors = true;
+    flagMaterial.flagColor1 = glm::vec3(1.0f, 1.0f, 1.0f); // Bialy
+    flagMaterial.flagColor2 = glm::vec3(0.9f, 0.1f, 0.2f); // Czerwony
+    scene.flagMat = addSceneMaterial(scene, flagMaterial);
+    // Wspolny material instancji - kolor pochodzi z danych instancji
+    scene.instancedMat = addSceneMaterial(scene, makeMaterial(glm::vec3(1.0f)));
+    scene.modelMat = addSceneMaterial(scene, makeMaterial(glm::vec3(0.7f, 0.75f, 0.8f)), diffuseTexture);
+
+    // Shadery sceny jedna partia: zrodla czytane w watku roboczym, kompilacje
+    // i linkowania zlecone naraz, w oknie klatka ladowania do ich zakonczenia.
+    // Programy cieniowania - warianty cech globalnych z cechami materialow,
+    // ktore dany program rysuje
+    const unsigned int allFeatures = SHADER_FEATURES_GLOBAL | SHADER_FEATURES_MATERIAL;
+    const std::vector<unsigned int> nodeMaterials = {
+        scene.materialFeatures[scene.floorMat], scene.materialFeatures[scene.movingMat],
+        scene.materialFeatures[scene.torusMat], scene.materialFeatures[scene.mastMat],
+        scene.materialFeatures[scene.modelMat]};
+    const std::vector<unsigned int> instanceMaterials = {scene.materialFeatures[scene.instancedMat]};
+    const std::vector<unsigned int> surfaceMaterials = {scene.materialFeatures[scene.flagMat],
+                                                        scene.materialFeatures[scene.modelMat]};
+    ShaderBuilder shaders;
+    scene.mainShader.setup("main", allFeatures, "shaders/vertex.glsl", "shaders/fragment.glsl");
+    scene.bezierShader.setup("bezier", allFeatures, "shaders/bezier_vertex.glsl", "shaders/bezier_fragment.glsl",
+                             "shaders/bezier_tcs.glsl", "shaders/bezier_tes.glsl");
+    scene.instancedShader.setup("instanced", allFeatures, "shaders/instanced_vertex.glsl", "shaders/fragment.glsl");
+    // Programy przebiegu geometrii trybu odroczonego - te same shadery wierzcholkow,
+    // fragmenty zapisuja G-buffer zamiast liczyc swiatla (tylko cechy materialu)
+    scene.mainGBufferShader.setup("main gbuffer", SHADER_FEATURES_MATERIAL, "shaders/vertex.glsl",
+                                  "shaders/gbuffer_fragment.glsl");
+    scene.instancedGBufferShader.setup("instanced gbuffer", SHADER_FEATURES_MATERIAL,
+                                       "shaders/instanced_vertex.glsl", "shaders/gbuffer_fragment.glsl");
+    scene.bezierGBufferShader.setup("bezier gbuffer", SHADER_FEATURES_MATERIAL, "shaders/bezier_vertex.glsl",
+                                    "shaders/bezier_gbuffer_fragment.glsl", "shaders/bezier_tcs.glsl",
+                                    "shaders/bezier_tes.glsl");
+    scene.mainShader.addTo(shaders, nodeMaterials);
+    scene.bezierShader.addTo(shaders, surfaceMaterials);
+    scene.instancedShader.addTo(shaders, instanceMaterials);
+    scene.mainGBufferShader.addTo(shaders, nodeMaterials);
+    scene.instancedGBufferShader.addTo(shaders, instanceMaterials);
+    scene.bezierGBufferShader.addTo(shaders, surfaceMaterials);
+    // Przebiegi glebokosci (mapy cieni, pre-pass) - pusty fragment shader;
+    // obiekty pojedyncze z samej pozycji (depth_vertex.glsl), bez normalnych
+    shaders.add(scene.mainDepthShader, "shaders/depth_vertex.glsl", "shaders/depth_fragment.glsl");
+    shaders.add(scene.instancedDepthShader, "shaders/instanced_vertex.glsl", "shaders/depth_fragment.glsl");
+    shaders.add(scene.bezierDepthShader, "shaders/bezier_vertex.glsl", "shaders/depth_fragment.glsl",
+                "shaders/bezier_tcs.glsl", "shaders/bezier_tes.glsl");
+
+    auto loadingFrame = [window](size_t ready, size_t total) { drawLoadingFrame(window, ready, total); };
+    if (!shaders.build(window ? loadingFrame : std::function<void(size_t, size_t)>())) {
         std::cerr << "Blad wczytywania shader'ow" << std::endl;
-        return -1;
+        return false;
     }
+    if (window) glfwSetWindowTitle(window, WINDOW_TITLE);
 
-    Shader bezierShader;
-    if (!bezierShader.loadFromFiles("shaders/bezier_vertex.glsl", "shaders/bezier_fragment.glsl",
-                                     "shaders/bezier_tcs.glsl", "shaders/bezier_tes.glsl")) {
-        std::cerr << "Blad wczytywania shader'ow Beziera" << std::endl;
-        return -1;
+    if (!scene.overlay.init()) {
+        std::cerr << "Blad wczytywania shader'ow nakladki" << std::endl;
+        return false;
     }
+    profiler.init();
 
-    // Utworz geometrie
-    Mesh sphere = createSphere(32, 16);
-    Mesh cube = createCube();
-    Mesh plane = createPlane(20.0f);
-    Mesh torus = createTorus(0.3f, 0.8f, 32, 16);
-    Mesh bezierPatch = createBezierPatch();
-    Mesh cylinder = createCylinder(0.05f, 3.5f, 16);
+    // Bez map cieni (np. brak tablic kostek) scena jest oswietlona bez cieni
+    scene.shadowsAvailable = scene.shadows.init();
+    if (!scene.shadowsAvailable) {
+        std::cerr << "Mapy cieni niedostepne - renderowanie bez cieni" << std::endl;
+    }
+
+    // Brak G-buffera (np. limit rozmiaru tekstur) wylacza tylko tryb odroczony
+    scene.deferredAvailable = scene.deferred.init(viewportWidth, viewportHeight);
+    if (!scene.deferredAvailable) {
+        std::cerr << "Tryb odroczony niedostepny - renderowanie forward" << std::endl;
+    }
+    scene.resolutionAvailable = scene.resolution.init();
+    if (!scene.resolutionAvailable) {
+        std::cerr << "Dynamiczna rozdzielczosc niedostepna - renderowanie w natywnej" << std::endl;
+    }
+
+    // Utworz geometrie (siatki trojkatow we wspolnych buforach)
+    initGeometryPool(scene.geometry);
+    scene.sphere = createSphereLods(scene.geometry);
+    scene.cube = createCube(scene.geometry);
+    scene.plane = createPlane(scene.geometry, 20.0f);
+    scene.torus = createTorusLods(scene.geometry);
+    scene.cylinder = createCylinderLods(scene.geometry);
+    createFlagSurface(scene.flags);
+    // Granice do cullingu z zapasem na najsilniejszy wiatr (mnoznik do 1)
+    scene.flagBounds = scene.flags.bounds(1.0f);
+    if (!patchPath.empty() && scene.patchSurface.loadFromFile(patchPath)) {
+        scene.patchSurface.upload();
+        scene.patchBounds = scene.patchSurface.bounds(0.0f);
+    }
+    if (!scene.sphere.valid() || !scene.cube.valid() || !scene.plane.valid() || !scene.torus.valid() ||
+        !scene.cylinder.valid()) {
+        return false;
+    }
+    // Model z pliku - blad wczytania nie przerywa programu
+    if (!modelPath.empty()) scene.model = loadObjModel(scene.geometry, modelPath);
+    scene.geometry.printStats();
+
+    // Obiekty statyczne jako instancje
+    scene.cubeInstances.init(scene.cube);
+    scene.sphereInstances.init(scene.sphere.level(0));
+    scene.torusInstances.init(scene.torus.level(0));
+
+    // Kula (obiekt gladki)
+    scene.sphereInstances.add(glm::translate(glm::mat4(1.0f), glm::vec3(-3.0f, 1.0f, 2.0f)),
+                              glm::vec3(0.2f, 0.4f, 0.8f));
+    // Szescian statyczny 1
+    scene.cubeInstances.add(glm::translate(glm::mat4(1.0f), glm::vec3(-4.0f, 0.5f, -4.0f)),
+                            glm::vec3(0.5f, 0.5f, 0.5f));
+    // Szescian statyczny 2
+    scene.cubeInstances.add(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(4.0f, 0.75f, 2.0f)),
+                                       glm::vec3(1.5f)),
+                            glm::vec3(0.6f, 0.3f, 0.6f));
+
+    if (stressObjects > 0) populateStressScene(scene, stressObjects);
+
+    // Opcjonalna sciezka GPU-driven dla obiektow statycznych
+    if (gpuDriven) {
+        if (!GpuDrivenRenderer::isSupported()) {
+            std::cerr << "GPU-driven wymaga GL 4.3 (SSBO w vertex shaderze) - zostaje sciezka instancji"
+                      << std::endl;
+        } else {
+            scene.useGpuDriven =
+                scene.gpuDriven.init({&scene.cube, &scene.sphere.level(0), &scene.torus.level(0)},
+                                     {&scene.cubeInstances, &scene.sphereInstances, &scene.torusInstances},
+                                     scene.materialFeatures[scene.instancedMat]);
+        }
+    }
+
+    // Hierarchia: nadwozie i reflektor podpiete pod ruchomy obiekt, flaga pod maszt
+    const glm::vec3 up(0.0f, 1.0f, 0.0f);
+    TransformStore& transforms = scene.transforms;
+    scene.floorNode = transforms.addNode(glm::vec3(0.0f));
+    scene.movingNode = transforms.addNode(movingObjectPos, glm::angleAxis(glm::radians(movingObjectAngle), up));
+    scene.movingBodyNode = transforms.addNode(glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                                              glm::vec3(0.8f, 0.5f, 1.2f), scene.movingNode);
+    scene.headlightNode = transforms.addNode(glm::vec3(0.0f, 0.3f, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                                             glm::vec3(1.0f), scene.movingNode);
+    scene.torusNode = transforms.addNode(glm::vec3(3.0f, 0.5f, -3.0f));
+    scene.mastNode = transforms.addNode(glm::vec3(0.0f, 0.0f, -5.0f));
+    scene.flagNode = transforms.addNode(glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                                        glm::vec3(1.0f), scene.mastNode);
+    if (!scene.patchSurface.patchIndices.empty()) {
+        // Jak model z pliku: ~1.5 jednostki, na podlodze, po drugiej stronie
+        const AABB& bounds = scene.patchBounds;
+        glm::vec3 extent = bounds.max - bounds.min;
+        float scale = 1.5f / std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f));
+        glm::vec3 center = 0.5f * (bounds.min + bounds.max);
+        glm::vec3 position(1.5f - center.x * scale, -bounds.min.y * scale, 4.0f - center.z * scale);
+        scene.patchNode = transforms.addNode(position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(scale));
+    }
+    if (scene.model.valid()) {
+        // Przeskalowany do ~1.5 jednostki i postawiony na podlodze przed kamera
+        const AABB& bounds = scene.model.bounds();
+        glm::vec3 extent = bounds.max - bounds.min;
+        float scale = 1.5f / std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f));
+        glm::vec3 center = 0.5f * (bounds.min + bounds.max);
+        glm::vec3 position(-1.5f - center.x * scale, -bounds.min.y * scale, 4.0f - center.z * scale);
+        scene.modelNode = transforms.addNode(position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(scale));
+    }
+    transforms.update();
+    buildCulling(scene);
+
+    // Egzemplarz 0 flag - flaga na maszcie (macierz z wezla co klatke)
+    scene.flags.add(transforms.world(scene.flagNode), glm::vec2(1.0f, 0.0f));
+    if (banners > 0) populateBanners(scene, banners);
+    scene.flagsWorldBounds = emptyAABB();
+    for (const PatchInstance& instance : scene.flags.instances) {
+        scene.flagsWorldBounds = mergeAABB(scene.flagsWorldBounds, transformAABB(scene.flagBounds, instance.model));
+    }
+    if (scene.patchNode >= 0) scene.patchSurface.add(transforms.world(scene.patchNode), glm::vec2(0.0f));
 
     // Macierz projekcji
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f),
-                                            (float)SCR_WIDTH / (float)SCR_HEIGHT,
-                                            0.1f, 100.0f);
-
-    std::cout << "\n=== STEROWANIE ===" << std::endl;
-    std::cout << "WASD - ruch obiektu" << std::endl;
-    std::cout << "Strzalki - kierunek reflektora" << std::endl;
-    std::cout << "1/2/3 - przelaczanie kamer" << std::endl;
-    std::cout << "F - wlacz/wylacz mgle" << std::endl;
-    std::cout << "B - przelacz Phong/Blinn" << std::endl;
-    std::cout << "N - dzien/noc (szybkie)" << std::endl;
-    std::cout << "O/P - plynna zmiana dnia/nocy" << std::endl;
-    std::cout << "+/- - gestosc mgly" << std::endl;
-    std::cout << "T/G - poziom tessellation" << std::endl;
-    std::cout << "Y/H - sila wiatru" << std::endl;
-    std::cout << "ESC - wyjscie" << std::endl;
-    std::cout << "==================\n" << std::endl;
-
-    // Glowna petla renderowania
-    while (!glfwWindowShouldClose(window)) {
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        processInput(window);
-
-        // Czyszczenie
-        glm::vec3 clearColor = glm::mix(glm::vec3(0.02f, 0.02f, 0.05f),
-                                        glm::vec3(0.4f, 0.6f, 0.8f),
-                                        dayNightFactor);
-        glClearColor(clearColor.r, clearColor.g, clearColor.b, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Wybor kamery
-        glm::mat4 view;
-        glm::vec3 cameraPos;
-
-        switch (activeCamera) {
-            case 0: // Kamera statyczna
-                cameraPos = glm::vec3(8.0f, 6.0f, 8.0f);
-                view = glm::lookAt(cameraPos,
-                                   glm::vec3(0.0f, 0.0f, 0.0f),
-                                   glm::vec3(0.0f, 1.0f, 0.0f));
-                break;
-            case 1: // Kamera sledzaca
-                cameraPos = glm::vec3(8.0f, 6.0f, 8.0f);
+    scene.projection = glm::perspective(glm::radians(45.0f),
+                                        (float)SCR_WIDTH / (float)SCR_HEIGHT,
+                                        CAMERA_NEAR, CAMERA_FAR);
+
+    return true;
+}
+
+// Przenosi stan animacji do TransformStore i przelicza zmienione wezly
+void updateTransforms(Scene& scene) {
+    const glm::vec3 up(0.0f, 1.0f, 0.0f);
+    TransformStore& transforms = scene.transforms;
+    transforms.setPosition(scene.movingNode, movingObjectPos);
+    transforms.setRotation(scene.movingNode, glm::angleAxis(glm::radians(movingObjectAngle), up));
+    transforms.setRotation(scene.torusNode, glm::angleAxis(sceneTime * 0.5f, up));
+    transforms.update();
+    frameCounters.transformUpdates += transforms.updatedCount;
+}
+
+// Macierz widoku aktywnej kamery
+glm::mat4 computeView() {
+    glm::mat4 view;
+    glm::vec3 cameraPos;
+
+    switch (activeCamera) {
+        case 0: // Kamera statyczna
+            cameraPos = glm::vec3(8.0f, 6.0f, 8.0f);
+            view = glm::lookAt(cameraPos,
+                               glm::vec3(0.0f, 0.0f, 0.0f),
+                               glm::vec3(0.0f, 1.0f, 0.0f));
+            break;
+        case 1: // Kamera sledzaca
+            cameraPos = glm::vec3(8.0f, 6.0f, 8.0f);
+            view = glm::lookAt(cameraPos,
+                               movingObjectPos,
+                               glm::vec3(0.0f, 1.0f, 0.0f));
+            break;
+        case 2: // Kamera TPP
+            {
+                float camDistance = 4.0f;
+                float camHeight = 2.0f;
+                cameraPos = movingObjectPos - glm::vec3(
+                    sin(glm::radians(movingObjectAngle)) * camDistance,
+                    -camHeight,
+                    cos(glm::radians(movingObjectAngle)) * camDistance
+                );
                 view = glm::lookAt(cameraPos,
-                                   movingObjectPos,
+                                   movingObjectPos + glm::vec3(0.0f, 0.5f, 0.0f),
                                    glm::vec3(0.0f, 1.0f, 0.0f));
-                break;
-            case 2: // Kamera TPP
-                {
-                    float camDistance = 4.0f;
-                    float camHeight = 2.0f;
-                    cameraPos = movingObjectPos - glm::vec3(
-                        sin(glm::radians(movingObjectAngle)) * camDistance,
-                        -camHeight,
-                        cos(glm::radians(movingObjectAngle)) * camDistance
-                    );
-                    view = glm::lookAt(cameraPos,
-                                       movingObjectPos + glm::vec3(0.0f, 0.5f, 0.0f),
-                                       glm::vec3(0.0f, 1.0f, 0.0f));
-                }
-                break;
+            }
+            break;
+    }
+
+    return view;
+}
+
+// Nakladka ze statystykami profilera: czasy przebiegow (CPU/GPU) i liczniki.
+// Wyniki sa sprzed kilku klatek - profiler nie czeka na GPU.
+void drawStatsOverlay(TextOverlay& overlay, const GeometryStats& geometry) {
+    const float scale = 2.0f;
+    const float line = TextOverlay::lineHeight(scale);
+    const float msToPixels = 40.0f;
+    const glm::vec4 textColor(1.0f, 1.0f, 1.0f, 1.0f);
+    const glm::vec4 cpuBarColor(0.9f, 0.7f, 0.2f, 0.9f);
+    const glm::vec4 gpuBarColor(0.3f, 0.8f, 0.4f, 0.9f);
+    char text[128];
+
+    overlay.begin();
+    float rows = 15.0f + profiler.results.size();
+    overlay.addRect(8.0f, 8.0f, 440.0f, rows * line + 12.0f, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+
+    float x = 16.0f, y = 16.0f;
+    std::snprintf(text, sizeof(text), "KLATKA  CPU %6.2f MS  GPU %6.2f MS", profiler.frameCpuMs,
+                  profiler.frameGpuMs);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    int percent = (int)std::lround(100.0 * sceneHeight / std::max(viewportHeight, 1));
+    if (dynamicResolution) {
+        std::snprintf(text, sizeof(text), "ROZDZIELCZOSC %dX%d %d%%  CEL %.1f MS", sceneWidth, sceneHeight,
+                      percent, resolutionTargetMs);
+    } else {
+        std::snprintf(text, sizeof(text), "ROZDZIELCZOSC %dX%d %d%%", sceneWidth, sceneHeight, percent);
+    }
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    overlay.addText(x, y, "PRZEBIEG        CPU     GPU", textColor, scale);
+    y += line;
+
+    for (const ProfileResult& result : profiler.results) {
+        std::string name = std::string(result.depth * 2, ' ') + result.name;
+        if (result.gpuMs >= 0.0) {
+            std::snprintf(text, sizeof(text), "%-12s %6.2f  %6.2f", name.c_str(), result.cpuMs, result.gpuMs);
+        } else {
+            std::snprintf(text, sizeof(text), "%-12s %6.2f       -", name.c_str(), result.cpuMs);
+        }
+        overlay.addText(x, y, text, textColor, scale);
+
+        // Paski: gorny CPU, dolny GPU
+        float barX = x + 28.0f * 4.0f * scale;
+        float barMax = 440.0f - barX;
+        overlay.addRect(barX, y, std::min((float)result.cpuMs * msToPixels, barMax), 4.0f, cpuBarColor);
+        if (result.gpuMs >= 0.0) {
+            overlay.addRect(barX, y + 5.0f, std::min((float)result.gpuMs * msToPixels, barMax), 4.0f,
+                            gpuBarColor);
         }
+        y += line;
+    }
+
+    y += line * 0.5f;
+    const FrameCounters& counters = profiler.counters;
+    std::snprintf(text, sizeof(text), "DRAW CALLS      %u", counters.drawCalls);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "ZMIANY STANU    %u (POMINIETE %u)", counters.stateChanges,
+                  counters.skippedStateChanges);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "UNIFORMY        %u", counters.uniformUploads);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "TROJKATY TESS.  %u", counters.tessTriangles);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "TROJKATY SIATEK %u", counters.meshTriangles);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "TRANSFORMACJE   %u", counters.transformUpdates);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "WIDOCZNE/ODRZ.  %u/%u", counters.visibleObjects, counters.culledObjects);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "SWIATLA/KLASTER %u/%u", counters.lights, counters.maxClusterLights);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "CIENIE STAT/DYN %u/%u", counters.shadowStaticViews,
+                  counters.shadowSampledViews);
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    // Probki po tescie glebokosci na piksel przebiegow cieniowania (1.0 = bez overdraw)
+    std::snprintf(text, sizeof(text), "PROBKI/PIKSEL   %.2f",
+                  counters.shadedSamples / (double)(sceneWidth * sceneHeight));
+    overlay.addText(x, y, text, textColor, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "GEOMETRIA KB    %u/%u",
+                  (unsigned int)((geometry.vertexBytesUsed + geometry.indexBytesUsed) / 1024),
+                  (unsigned int)((geometry.vertexBytesCapacity + geometry.indexBytesCapacity) / 1024));
+    overlay.addText(x, y, text, textColor, scale);
+
+    overlay.draw();
+}
+
+// Dane zmieniane co klatke do pierscienia: transformacje wszystkich wezlow
+// (wspolne dla kamery i widokow swiatel) i parametry powierzchni Beziera
+void uploadDynamicData(Scene& scene) {
+    DynamicBuffer& dynamic = scene.uniformBuffers.dynamic;
+    const TransformStore& transforms = scene.transforms;
+    scene.nodeData.resize(transforms.size());
+    for (size_t node = 0; node < transforms.size(); ++node) {
+        scene.nodeData[node] = dynamic.push(makeObjectData(transforms.world((int)node),
+                                                           transforms.normalMatrix((int)node)));
+    }
 
-        // ====== RENDEROWANIE GLOWNYM SHADEREM ======
-        mainShader.use();
-        mainShader.setMat4("projection", projection);
-        mainShader.setMat4("view", view);
-        setLightUniforms(mainShader, view);
-
-        // Aktywuj domyslna teksture
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, defaultTexture);
-        mainShader.setInt("textureDiffuse", 0);
-        mainShader.setBool("useTexture", false);
-
-        // Podloga z wzorem szachownicy
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
-            mainShader.setMat4("model", model);
-            mainShader.setMat3("normalMatrix", normalMatrix);
-            mainShader.setBool("useCheckerboard", true);
-            mainShader.setFloat("checkerScale", 10.0f); // 10x10 kratek
-            mainShader.setVec3("checkerColor1", glm::vec3(0.5f, 0.5f, 0.5f)); // Szary jasny
-            mainShader.setVec3("checkerColor2", glm::vec3(0.25f, 0.25f, 0.25f)); // Szary ciemny
-            glDisable(GL_CULL_FACE); // Podloga widoczna z obu stron
-            glBindVertexArray(plane.VAO);
-            glDrawElements(GL_TRIANGLES, plane.indexCount, GL_UNSIGNED_INT, 0);
-            glEnable(GL_CULL_FACE);
-            mainShader.setBool("useCheckerboard", false); // Wylacz dla innych obiektow
+    SurfaceStd140 surface;
+    std::memset(static_cast<void*>(&surface), 0, sizeof(surface));
+    surface.windDirection = glm::vec2(1.0f, 0.3f);
+    surface.windStrength = windStrength;
+    surface.tessMaxLevel = (float)tessLevel;
+    surface.tessTriangleSize = tessTriangleSize;
+    surface.adaptiveTessellation = adaptiveTessellation;
+    surface.backfaceCulling = false;   // flagi dwustronne
+    scene.surfaceData = dynamic.push(surface);
+    dynamic.bind(UBO_BINDING_SURFACE, scene.surfaceData, sizeof(surface));
+}
+
+// ObjectData wezla - jedno wiazanie zakresu zamiast uniformow programu
+void setNodeTransform(Scene& scene, int node) {
+    scene.uniformBuffers.dynamic.bind(UBO_BINDING_OBJECT, scene.nodeData[node], sizeof(ObjectStd140));
+}
+
+// Geometria nieruchoma widoku swiatla (zapytanie BVH jego frustum).
+// Podloga nie zaslania niczego widocznego - nie rzuca cienia.
+void drawStaticShadowCasters(Scene& scene, const Frustum& frustum) {
+    for (std::vector<unsigned int>& instances : scene.shadowInstances) instances.clear();
+    scene.shadowNodes.clear();
+    scene.bvh.query(frustum, [&scene](int object) {
+        const CullObject& cull = scene.cullObjects[object];
+        if (cull.kind == CULL_NODE) {
+            scene.shadowNodes.push_back(cull.index);
+        } else {
+            scene.shadowInstances[cull.kind].push_back(cull.index);
+        }
+    });
+
+    bool drawPatches = false;
+    scene.mainDepthShader.use();
+    for (int node : scene.shadowNodes) {
+        if (node == scene.mastNode) {
+            setNodeTransform(scene, node);
+            drawMesh(scene.cylinder.level(0));
+        } else if (node == scene.modelNode) {
+            setNodeTransform(scene, node);
+            drawMesh(scene.model.level(0));
+        } else if (node == scene.patchNode) {
+            drawPatches = true;
         }
+    }
+
+    if (scene.useGpuDriven) {
+        scene.gpuDriven.cull(frustum, true);
+        scene.gpuDriven.draw(GPU_DRAW_DEPTH);
+    } else {
+        scene.instancedDepthShader.use();
+        scene.cubeInstances.drawVisible(scene.shadowInstances[CULL_CUBE_INSTANCE]);
+        scene.sphereInstances.drawVisible(scene.shadowInstances[CULL_SPHERE_INSTANCE]);
+        scene.torusInstances.drawVisible(scene.shadowInstances[CULL_TORUS_INSTANCE]);
+    }
 
-        // Ruchomy obiekt (samochod/szescian)
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, movingObjectPos);
-            model = glm::rotate(model, glm::radians(movingObjectAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.8f, 0.5f, 1.2f));
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
-            mainShader.setMat4("model", model);
-            mainShader.setMat3("normalMatrix", normalMatrix);
-            mainShader.setVec3("objectColor", glm::vec3(0.8f, 0.2f, 0.2f));
-            glBindVertexArray(cube.VAO);
-            glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, 0);
+    if (drawPatches) {
+        scene.bezierDepthShader.use();
+        setCullFace(false);
+        scene.patchSurface.draw();
+        setCullFace(true);
+    }
+}
+
+// Obiekty ruchome dorysowywane do kopii warstwy statycznej
+void drawDynamicShadowCasters(Scene& scene, bool vehicle, bool torus, bool flags) {
+    if (vehicle || torus) scene.mainDepthShader.use();
+    if (vehicle) {
+        setNodeTransform(scene, scene.movingBodyNode);
+        drawMesh(scene.cube);
+    }
+    if (torus) {
+        setNodeTransform(scene, scene.torusNode);
+        drawMesh(scene.torus.level(0));
+    }
+    if (flags) {
+        scene.bezierDepthShader.use();
+        setCullFace(false);
+        scene.flags.draw();
+        setCullFace(true);
+    }
+}
+
+// Mapy cieni: warstwa statyczna widoku tylko po zmianie jego macierzy,
+// kopia z obiektami ruchomymi tylko gdy ktorys z nich przecina widok
+void renderShadowMaps(Scene& scene, const glm::mat4& view) {
+    ShadowMaps& shadows = scene.shadows;
+    bool enabled = shadowsEnabled && scene.shadowsAvailable;
+    if (enabled) {
+        const TransformStore& transforms = scene.transforms;
+        AABB vehicleBounds = transformAABB(scene.cube.bounds, transforms.world(scene.movingBodyNode));
+        AABB torusBounds = transformAABB(scene.torus.bounds(), transforms.world(scene.torusNode));
+
+        shadows.beginPass();
+        for (int v = 0; v < shadows.viewCount(); ++v) {
+            const Frustum& frustum = shadows.viewFrustum(v);
+            if (!shadows.staticValid(v)) {
+                shadows.beginStatic(v, scene.uniformBuffers);
+                drawStaticShadowCasters(scene, frustum);
+            }
+            // Widok 0 to reflektor pojazdu - nie zaslania go nadwozie, w ktorym siedzi
+            bool vehicle = v != 0 && frustum.classify(vehicleBounds) != FRUSTUM_OUTSIDE;
+            bool torus = frustum.classify(torusBounds) != FRUSTUM_OUTSIDE;
+            bool flags = frustum.classify(scene.flagsWorldBounds) != FRUSTUM_OUTSIDE;
+            bool dynamic = vehicle || torus || flags;
+            if (!dynamic && !shadows.sampledDirty(v)) continue;
+            shadows.beginSampled(v, scene.uniformBuffers, dynamic);
+            if (dynamic) drawDynamicShadowCasters(scene, vehicle, torus, flags);
         }
+        shadows.endPass(sceneFramebuffer, sceneWidth, sceneHeight, scene.uniformBuffers);
+    }
+    shadows.upload(view, enabled, scene.uniformBuffers);
+    shadows.bind();
+}
+
+// Siatka wezla z lancucha LOD; poziom zapamietany w nodeLod
+const Mesh& selectNodeLod(Scene& scene, int node, const LodChain& lods, const LodView& lodView) {
+    int level = lods.select(lodView, scene.transforms.world(node), scene.nodeLod[node]);
+    scene.nodeLod[node] = (unsigned char)level;
+    return lods.level(level);
+}
+
+// Widoczne wezly z wybranym poziomem LOD, raz na klatke - pre-pass i cieniowanie
+// musza rysowac te same siatki (GL_EQUAL)
+void collectNodeDraws(Scene& scene, const glm::mat4& view, const LodView& lodView) {
+    std::vector<NodeDraw>& draws = scene.nodeDraws;
+    draws.clear();
+    auto add = [&scene, &view, &draws](int node, const Mesh& mesh, int material, bool twoSided) {
+        if (!mesh.valid()) return;
+        glm::vec4 center(0.5f * (mesh.bounds.min + mesh.bounds.max), 1.0f);
+        float depth = -(view * (scene.transforms.world(node) * center)).z;
+        draws.push_back({node, &mesh, material, twoSided, depth});
+    };
+    const std::vector<unsigned char>& visible = scene.nodeVisible;
+
+    // Podloga widoczna z obu stron
+    if (visible[scene.floorNode]) add(scene.floorNode, scene.plane, scene.floorMat, true);
+    if (visible[scene.movingBodyNode]) add(scene.movingBodyNode, scene.cube, scene.movingMat, false);
+    if (visible[scene.torusNode]) {
+        add(scene.torusNode, selectNodeLod(scene, scene.torusNode, scene.torus, lodView), scene.torusMat, false);
+    }
+    if (visible[scene.mastNode]) {
+        add(scene.mastNode, selectNodeLod(scene, scene.mastNode, scene.cylinder, lodView), scene.mastMat, false);
+    }
+    if (scene.modelNode >= 0 && visible[scene.modelNode]) {
+        add(scene.modelNode, selectNodeLod(scene, scene.modelNode, scene.model, lodView), scene.modelMat, false);
+    }
+}
+
+// Poziom mipmap tekstur widocznych wezlow: szerokosc tekstury rozciagnieta na
+// przekatnej obiektu na ekranie (przyblizenie - UV 0..1 na cala siatke)
+void requestNodeTextures(Scene& scene, const LodView& lodView) {
+    for (const NodeDraw& draw : scene.nodeDraws) {
+        int texture = scene.materialTextures[draw.material];
+        if (texture < 0) continue;
+        glm::vec3 extent(scene.transforms.world(draw.node) * glm::vec4(draw.mesh->bounds.max - draw.mesh->bounds.min,
+                                                                       0.0f));
+        float pixels = glm::length(extent) * lodView.projectionScale * 0.5f * sceneHeight /
+                       std::max(draw.depth, CAMERA_NEAR);
+        scene.textures.request(texture, scene.textures.levelForScreenSize(texture, pixels));
+    }
+}
 
-        // Kula (obiekt gladki)
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(-3.0f, 1.0f, 2.0f));
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
-            mainShader.setMat4("model", model);
-            mainShader.setMat3("normalMatrix", normalMatrix);
-            mainShader.setVec3("objectColor", glm::vec3(0.2f, 0.4f, 0.8f));
-            glBindVertexArray(sphere.VAO);
-            glDrawElements(GL_TRIANGLES, sphere.indexCount, GL_UNSIGNED_INT, 0);
+// Tekstura materialu na jednostce 0 - tylko przy zmianie (kolejka grupuje materialy)
+void bindMaterialTexture(Scene& scene, int material) {
+    int handle = scene.materialTextures[material];
+    if (handle < 0) return;
+    GLuint texture = scene.textures.texture(handle);
+    if (!texture) texture = scene.defaultTexture;
+    if (texture == scene.boundDiffuse) {
+        countSkippedStateChange();
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    scene.boundDiffuse = texture;
+    countStateChange();
+}
+
+// Instancje CPU od najblizszych; w sciezce GPU-driven kolejnosc ustala
+// kompakcja w cull_compute.glsl
+void sortVisibleInstances(Scene& scene, const glm::mat4& view) {
+    scene.cubeInstances.sortFrontToBack(scene.visibleInstances[CULL_CUBE_INSTANCE], view);
+    scene.sphereInstances.sortFrontToBack(scene.visibleInstances[CULL_SPHERE_INSTANCE], view);
+    scene.torusInstances.sortFrontToBack(scene.visibleInstances[CULL_TORUS_INSTANCE], view);
+}
+
+// Rodzaje komend kolejki rysowania sceny (RenderCommand::kind)
+enum SceneDrawKind {
+    SCENE_DRAW_NODE = 0,         // index - pozycja w nodeDraws
+    SCENE_DRAW_INSTANCES = 1,    // index - CullKind batcha instancji
+    SCENE_DRAW_GPU_DRIVEN = 2,   // index - GpuDrawProgram
+    SCENE_DRAW_FLAGS = 3,
+    SCENE_DRAW_PATCHES = 4
+};
+
+// Cechy wariantow shaderow przelaczane klawiszami - wspolne dla calej klatki
+unsigned int globalShaderFeatures() {
+    unsigned int features = 0;
+    if (useBlinn) features |= SHADER_FEATURE_BLINN;
+    if (fogEnabled) features |= SHADER_FEATURE_FOG;
+    return features;
+}
+
+// Komendy jednego wariantu programow (forward, G-buffer, glebokosc). Wariant
+// glebokosci trafia w calosci do przebiegu pre-passu, bez materialow.
+void submitSceneDraws(Scene& scene, GpuDrawProgram program, bool drawFlags, bool drawPatches) {
+    RenderQueue& queue = scene.renderQueue;
+    bool depthOnly = program == GPU_DRAW_DEPTH;
+    RenderPass meshPass = depthOnly ? RENDER_PASS_DEPTH : RENDER_PASS_OPAQUE;
+    RenderPass surfacePass = depthOnly ? RENDER_PASS_DEPTH : RENDER_PASS_SURFACES;
+    auto material = [depthOnly](int index) { return depthOnly ? -1 : index; };
+    // Wariant programu dla cech klatki i materialu; glebokosc bez wariantow
+    unsigned int frameFeatures = globalShaderFeatures();
+    auto variant = [&scene, program, frameFeatures](ShaderVariants& forward, ShaderVariants& gbuffer,
+                                                     Shader& depth, int materialIndex) -> Shader* {
+        if (program == GPU_DRAW_DEPTH) return &depth;
+        unsigned int features = frameFeatures | scene.materialFeatures[materialIndex];
+        return &(program == GPU_DRAW_FORWARD ? forward : gbuffer).select(features);
+    };
+
+    for (size_t i = 0; i < scene.nodeDraws.size(); ++i) {
+        const NodeDraw& draw = scene.nodeDraws[i];
+        unsigned int vao = draw.mesh->owner()->vertexArray(draw.mesh->range().block);
+        Shader* shader = variant(scene.mainShader, scene.mainGBufferShader, scene.mainDepthShader, draw.material);
+        queue.submit(meshPass, {shader, vao, material(draw.material),
+                                draw.twoSided ? RENDER_STATE_TWO_SIDED : 0u, SCENE_DRAW_NODE, (int)i},
+                     draw.depth);
+    }
+
+    // Batche instancji bez jednej glebokosci - przed wezlami o tym samym stanie
+    if (scene.useGpuDriven) {
+        unsigned int features = frameFeatures | scene.materialFeatures[scene.instancedMat];
+        queue.submit(meshPass, {&scene.gpuDriven.drawProgram(program, features), scene.gpuDriven.vertexArray(),
+                                material(scene.instancedMat), 0u, SCENE_DRAW_GPU_DRIVEN, program}, 0.0f);
+    } else {
+        InstanceBatch* batches[] = {&scene.cubeInstances, &scene.sphereInstances, &scene.torusInstances};
+        for (int kind = CULL_CUBE_INSTANCE; kind <= CULL_TORUS_INSTANCE; ++kind) {
+            if (scene.visibleInstances[kind].empty()) continue;
+            Shader* shader = variant(scene.instancedShader, scene.instancedGBufferShader, scene.instancedDepthShader,
+                                     scene.instancedMat);
+            queue.submit(meshPass, {shader, batches[kind]->vertexArray(),
+                                    material(scene.instancedMat), 0u, SCENE_DRAW_INSTANCES, kind}, 0.0f);
         }
+    }
+
+    // Flagi i platy widoczne z obu stron; parametry w SurfaceData (uploadDynamicData)
+    if (drawFlags) {
+        Shader* shader = variant(scene.bezierShader, scene.bezierGBufferShader, scene.bezierDepthShader, scene.flagMat);
+        queue.submit(surfacePass, {shader, scene.flags.vertexArray(), material(scene.flagMat),
+                                   RENDER_STATE_TWO_SIDED, SCENE_DRAW_FLAGS, 0}, 0.0f);
+    }
+    if (drawPatches) {
+        Shader* shader = variant(scene.bezierShader, scene.bezierGBufferShader, scene.bezierDepthShader,
+                                 scene.modelMat);
+        queue.submit(surfacePass, {shader, scene.patchSurface.vertexArray(),
+                                   material(scene.modelMat), RENDER_STATE_TWO_SIDED, SCENE_DRAW_PATCHES, 0},
+                     0.0f);
+    }
+}
 
-        // Torus
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(3.0f, 0.5f, -3.0f));
-            model = glm::rotate(model, (float)glfwGetTime() * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
-            mainShader.setMat4("model", model);
-            mainShader.setMat3("normalMatrix", normalMatrix);
-            mainShader.setVec3("objectColor", glm::vec3(0.8f, 0.6f, 0.2f));
-            glBindVertexArray(torus.VAO);
-            glDrawElements(GL_TRIANGLES, torus.indexCount, GL_UNSIGNED_INT, 0);
+// Rysowanie komendy kolejki - program, culling i material juz ustawione
+void drawSceneCommand(Scene& scene, const RenderCommand& command, const LodView& lodView) {
+    if (command.material >= 0) bindMaterialTexture(scene, command.material);
+    switch (command.kind) {
+        case SCENE_DRAW_NODE: {
+            const NodeDraw& draw = scene.nodeDraws[command.index];
+            setNodeTransform(scene, draw.node);
+            drawMesh(*draw.mesh);
+            break;
         }
+        case SCENE_DRAW_INSTANCES: {
+            const std::vector<unsigned int>& visible = scene.visibleInstances[command.index];
+            if (command.index == CULL_CUBE_INSTANCE) {
+                scene.cubeInstances.drawVisible(visible, sortFrontToBack);
+            } else if (command.index == CULL_SPHERE_INSTANCE) {
+                scene.sphereInstances.drawVisible(visible, scene.sphere, lodView, sortFrontToBack);
+            } else {
+                scene.torusInstances.drawVisible(visible, scene.torus, lodView, sortFrontToBack);
+            }
+            break;
+        }
+        case SCENE_DRAW_GPU_DRIVEN:
+            // Jeden glMultiDrawElementsIndirect programem wybranym przy zgloszeniu
+            scene.gpuDriven.draw(*command.shader);
+            break;
+        case SCENE_DRAW_FLAGS:
+            scene.flags.draw();
+            break;
+        case SCENE_DRAW_PATCHES:
+            scene.patchSurface.draw();
+            break;
+    }
+}
+
+// Skala rozdzielczosci klatki: regulator (po beginFrame profilera - czas GPU
+// ostatniej odczytanej klatki) albo stala skala
+float updateRenderScale(Scene& scene) {
+    ResolutionController& controller = scene.resolution.controller;
+    controller.targetMs = resolutionTargetMs;
+    controller.minScale = resolutionMinScale;
+    controller.maxScale = resolutionMaxScale;
+    if (!dynamicResolution) {
+        scene.resolutionControlled = false;
+        return renderScale;
+    }
+    // Po wlaczeniu od najwyzszej jakosci - regulator szybko obniza skale
+    if (!scene.resolutionControlled) controller.reset(resolutionMaxScale);
+    scene.resolutionControlled = true;
+    return controller.update(profiler.frameGpuMs);
+}
 
-        // Szescian statyczny 1
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(-4.0f, 0.5f, -4.0f));
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
-            mainShader.setMat4("model", model);
-            mainShader.setMat3("normalMatrix", normalMatrix);
-            mainShader.setVec3("objectColor", glm::vec3(0.5f, 0.5f, 0.5f));
-            glBindVertexArray(cube.VAO);
-            glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, 0);
+void renderScene(Scene& scene) {
+    profiler.beginFrame();
+
+    // Przebiegi 3D przy skali ponizej 1.0 do celu skalowanej rozdzielczosci,
+    // przeniesionego na outputFramebuffer przed nakladka
+    float scale = scene.resolutionAvailable ? updateRenderScale(scene) : 1.0f;
+    sceneFramebuffer = outputFramebuffer;
+    sceneWidth = viewportWidth;
+    sceneHeight = viewportHeight;
+    if (scale < 1.0f) {
+        int width = DynamicResolution::scaledSize(viewportWidth, scale);
+        int height = DynamicResolution::scaledSize(viewportHeight, scale);
+        unsigned int target = scene.resolution.resize(width, height);
+        if (target) {
+            sceneFramebuffer = target;
+            sceneWidth = width;
+            sceneHeight = height;
         }
+    }
+    bool upscale = sceneFramebuffer != outputFramebuffer;
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+    glViewport(0, 0, sceneWidth, sceneHeight);
+
+    // Czyszczenie
+    glm::vec3 clearColor = glm::mix(glm::vec3(0.02f, 0.02f, 0.05f),
+                                    glm::vec3(0.4f, 0.6f, 0.8f),
+                                    dayNightFactor);
+    glClearColor(clearColor.r, clearColor.g, clearColor.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // ====== RENDEROWANIE GLOWNYM SHADEREM ======
+    glm::mat4 view = computeView();
+    LodView lodView = makeLodView(view, scene.projection, lodEnabled);
+
+    {
+        ProfileScope scope(profiler, "Transformacje", PROFILE_CPU);
+        updateTransforms(scene);
+    }
+    {
+        ProfileScope scope(profiler, "Culling", PROFILE_CPU);
+        updateCulling(scene, scene.projection * view);
+    }
+
+    // Dane klatki, swiatel i wezlow zapisywane raz, wspolne dla wszystkich shaderow
+    // i przebiegow; obszar pierscienia czeka na GPU tylko gdy ten go jeszcze czyta
+    {
+        ProfileScope scope(profiler, "Uniformy", PROFILE_CPU);
+        scene.uniformBuffers.dynamic.beginFrame();
+        updateFrameUniforms(scene.uniformBuffers, scene.lightClusters, scene.shadows, scene.streetLights, view,
+                            scene.projection, scene.transforms.worldPosition(scene.headlightNode));
+        scene.uniformBuffers.upload();
+        uploadDynamicData(scene);
+        countUniformUpload(scene.uniformBuffers.uploadCount);
+        scene.uniformBuffers.resetStats();
+    }
+    {
+        ProfileScope scope(profiler, "Klastry", PROFILE_CPU);
+        scene.lightClusters.build(scene.projection, scene.workers);
+        scene.lightClusters.upload();
+        scene.lightClusters.bind();
+        frameCounters.lights += (unsigned int)(scene.lightClusters.pointLights.size() +
+                                               scene.lightClusters.spotLights.size());
+        frameCounters.maxClusterLights = std::max(frameCounters.maxClusterLights,
+                                                  scene.lightClusters.maxClusterLights);
+    }
+    {
+        ProfileScope scope(profiler, "Cienie");
+        renderShadowMaps(scene, view);
+    }
 
-        // Szescian statyczny 2
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(4.0f, 0.75f, 2.0f));
-            model = glm::scale(model, glm::vec3(1.5f));
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
-            mainShader.setMat4("model", model);
-            mainShader.setMat3("normalMatrix", normalMatrix);
-            mainShader.setVec3("objectColor", glm::vec3(0.6f, 0.3f, 0.6f));
-            glBindVertexArray(cube.VAO);
-            glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, 0);
+    // Tryb odroczony: geometria do G-buffera, oswietlenie jednym przebiegiem po ekranie
+    bool deferredPass = deferredShading && scene.deferredAvailable &&
+                        scene.deferred.resize(sceneWidth, sceneHeight);
+    if (deferredPass) scene.deferred.beginGeometry();
+
+    // Choragwie odrzuca per plat TCS - BVH decyduje tylko o samej fladze na maszcie
+    bool drawFlags = scene.nodeVisible[scene.flagNode] || scene.flags.instances.size() > 1;
+    bool drawPatches = scene.patchNode >= 0 && scene.nodeVisible[scene.patchNode];
+    if (drawFlags) {
+        scene.flags.setModel(0, scene.transforms.world(scene.flagNode),
+                             scene.transforms.normalMatrix(scene.flagNode));
+    }
+    if (drawPatches) {
+        scene.patchSurface.setModel(0, scene.transforms.world(scene.patchNode),
+                                    scene.transforms.normalMatrix(scene.patchNode));
+    }
+
+    // Kolejka rysowania: poziomy LOD i komendy raz na klatke (pre-pass i
+    // cieniowanie rysuja te same siatki), sortowanie wg klucza stanu
+    GpuDrawProgram shadingProgram = deferredPass ? GPU_DRAW_GBUFFER : GPU_DRAW_FORWARD;
+    {
+        ProfileScope scope(profiler, "Kolejka", PROFILE_CPU);
+        collectNodeDraws(scene, view, lodView);
+        if (sortFrontToBack && !scene.useGpuDriven) sortVisibleInstances(scene, view);
+        scene.renderQueue.begin(sortFrontToBack ? CAMERA_FAR : 0.0f, stateSorting);
+        if (depthPrepass) submitSceneDraws(scene, GPU_DRAW_DEPTH, drawFlags, drawPatches);
+        submitSceneDraws(scene, shadingProgram, drawFlags, drawPatches);
+        scene.renderQueue.sort();
+    }
+    // Poziomy tekstur wg rozmiaru na ekranie; wysylanie w ramach obszaru PBO klatki
+    {
+        ProfileScope scope(profiler, "Tekstury", PROFILE_CPU);
+        requestNodeTextures(scene, lodView);
+        scene.textures.update();
+    }
+    auto drawCommand = [&scene, &lodView](const RenderCommand& command) {
+        drawSceneCommand(scene, command, lodView);
+    };
+
+    // Culling i komendy GPU-driven raz na klatke - oba przebiegi rysuja ten sam bufor
+    if (scene.useGpuDriven) scene.gpuDriven.cull(scene.frustum, cullingEnabled);
+
+    // ====== PRE-PASS GLEBOKOSCI ======
+    // Sama glebokosc bez zapisu koloru; cieniowanie z GL_EQUAL liczy potem
+    // fragment tylko dla powierzchni widocznej w pikselu
+    if (depthPrepass) {
+        ProfileScope scope(profiler, "Pre-pass");
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        countStateChange();
+        scene.renderQueue.execute(RENDER_PASS_DEPTH, scene.uniformBuffers, drawCommand);
+
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_FALSE);
+        glDepthFunc(GL_EQUAL);
+        countStateChange(3);
+    }
+
+    // Tekstury materialow na jednostce 0, wiazane przy zmianie materialu
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, scene.defaultTexture);
+    scene.boundDiffuse = scene.defaultTexture;
+
+    // Siatki trojkatow: wezly (podloga, ruchomy obiekt, torus, maszt, model) i
+    // obiekty statyczne - jeden zakres dla calego przebiegu
+    {
+        ProfileScope scope(profiler, "Obiekty", PROFILE_GPU | PROFILE_SAMPLES);
+        scene.renderQueue.execute(RENDER_PASS_OPAQUE, scene.uniformBuffers, drawCommand);
+    }
+
+    // ====== POWIERZCHNIE BEZIERA (FLAGI, PLATY Z PLIKU) ======
+    if (drawFlags || drawPatches) {
+        ProfileScope scope(profiler, "Flaga", PROFILE_GPU | PROFILE_PRIMITIVES | PROFILE_SAMPLES);
+        scene.renderQueue.execute(RENDER_PASS_SURFACES, scene.uniformBuffers, drawCommand);
+    }
+
+    if (depthPrepass) {
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+        countStateChange(2);
+    }
+
+    // ====== OSWIETLENIE (TRYB ODROCZONY) ======
+    if (deferredPass) {
+        ProfileScope scope(profiler, "Oswietlenie");
+        scene.deferred.light(sceneFramebuffer, globalShaderFeatures());
+    }
+
+    // ====== SKALOWANIE DO ROZDZIELCZOSCI WYJSCIA ======
+    if (upscale) {
+        ProfileScope scope(profiler, "Skalowanie");
+        scene.resolution.present(outputFramebuffer, viewportWidth, viewportHeight);
+    }
+
+    if (showOverlay) {
+        ProfileScope scope(profiler, "Nakladka");
+        drawStatsOverlay(scene.overlay, scene.geometry.getStats());
+    }
+
+    scene.uniformBuffers.dynamic.endFrame();
+    profiler.endFrame();
+}
+
+void destroyScene(Scene& scene) {
+    scene.uniformBuffers.destroy();
+    scene.lightClusters.destroy();
+    scene.deferred.destroy();
+    scene.resolution.destroy();
+    scene.shadows.destroy();
+    scene.overlay.destroy();
+    scene.textures.destroy();
+    profiler.destroy();
+    scene.cubeInstances.destroy();
+    scene.sphereInstances.destroy();
+    scene.torusInstances.destroy();
+    scene.gpuDriven.destroy();
+    scene.mainShader.destroy();
+    scene.bezierShader.destroy();
+    scene.instancedShader.destroy();
+    scene.mainGBufferShader.destroy();
+    scene.bezierGBufferShader.destroy();
+    scene.instancedGBufferShader.destroy();
+    deleteProgram(scene.mainDepthShader.ID);
+    deleteProgram(scene.instancedDepthShader.ID);
+    deleteProgram(scene.bezierDepthShader.ID);
+
+    // Uchwyty zwalniaja zakresy, pula usuwa bufory
+    scene.sphere.release();
+    scene.cube.release();
+    scene.plane.release();
+    scene.torus.release();
+    scene.cylinder.release();
+    scene.model.release();
+    scene.geometry.destroy();
+
+    scene.flags.destroy();
+    scene.patchSurface.destroy();
+}
+
+// Koszt wariantow shaderow: rozmiar binarium, aktywne uniformy i liczba wyborow
+// od poprzedniego raportu (warianty nieuzywane maja 0)
+void printShaderReport(Scene& scene, std::ostream& out) {
+    out << "Warianty shaderow:" << std::endl;
+    out << "  " << std::left << std::setw(52) << "program [cechy]" << std::right << std::setw(11) << "binarium"
+        << std::setw(6) << "unif" << std::setw(10) << "wybory" << std::endl;
+    ShaderVariants* variants[] = {&scene.mainShader, &scene.instancedShader, &scene.bezierShader,
+                                  &scene.mainGBufferShader, &scene.instancedGBufferShader,
+                                  &scene.bezierGBufferShader};
+    for (ShaderVariants* set : variants) set->report(out);
+    scene.deferred.reportVariants(out);
+    if (scene.useGpuDriven) scene.gpuDriven.reportVariants(out);
+}
+
+// ============== TRYB BENCHMARKU ==============
+void applyTimelineEvent(const TimelineEvent& event) {
+    // Argument sprawdzony przy wczytywaniu scenariusza (BenchmarkTimeline::loadFromFile)
+    const float value = event.value;
+    const bool on = event.value != 0.0f;
+
+    if (event.command == "camera") {
+        activeCamera = std::max(0, std::min((int)value, 2));
+    } else if (event.command == "tess") {
+        tessLevel = std::max(2, std::min((int)value, 64));
+    } else if (event.command == "tessadaptive") {
+        adaptiveTessellation = on;
+    } else if (event.command == "tesspixels") {
+        tessTriangleSize = std::max(1.0f, value);
+    } else if (event.command == "fog") {
+        fogEnabled = on;
+    } else if (event.command == "fogdensity") {
+        fogDensity = value;
+    } else if (event.command == "daynight") {
+        dayNightFactor = glm::clamp(value, 0.0f, 1.0f);
+    } else if (event.command == "wind") {
+        windStrength = value;
+    } else if (event.command == "blinn") {
+        useBlinn = on;
+    } else if (event.command == "culling") {
+        cullingEnabled = on;
+    } else if (event.command == "lod") {
+        lodEnabled = on;
+    } else if (event.command == "deferred") {
+        deferredShading = on;
+    } else if (event.command == "shadows") {
+        shadowsEnabled = on;
+    } else if (event.command == "prepass") {
+        depthPrepass = on;
+    } else if (event.command == "sort") {
+        sortFrontToBack = on;
+    } else if (event.command == "statesort") {
+        stateSorting = on;
+    } else if (event.command == "dynres") {
+        dynamicResolution = on;
+    } else if (event.command == "renderscale") {
+        renderScale = glm::clamp(value, RESOLUTION_SCALE_LIMIT, 1.0f);
+    } else if (event.command == "targetms") {
+        resolutionTargetMs = std::max(1.0f, value);
+    } else {
+        std::cerr << "Benchmark: nieznana komenda '" << event.command << "'" << std::endl;
+    }
+}
+
+// Odtwarza scenariusz ze stalym krokiem czasu i zapisuje raport JSON.
+// window == NULL w trybie headless (bez swapBuffers i obslugi zdarzen).
+bool runBenchmark(Scene& scene, BenchmarkTimeline& timeline, GLFWwindow* window,
+                  const std::string& reportPath, const std::string& tracePath) {
+    FrameTimer timer;
+    timer.init();
+    std::vector<glm::ivec2> renderSizes;   // rozmiar celu przebiegow 3D kazdej klatki
+
+    int frames = timeline.frameCount();
+    std::cout << "Benchmark: " << frames << " klatek" << std::endl;
+    if (!tracePath.empty()) profiler.startCapture(frames);
+
+    for (int frame = 0; frame < frames; ++frame) {
+        if (window && glfwWindowShouldClose(window)) break;
+
+        sceneTime = frame * timeline.step;
+        timeline.advance(sceneTime, applyTimelineEvent);
+        timeline.samplePath(sceneTime, movingObjectPos, movingObjectAngle);
+
+        timer.beginFrame();
+        renderScene(scene);
+        timer.endFrame();
+        renderSizes.push_back(glm::ivec2(sceneWidth, sceneHeight));
+
+        if (window) {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
         }
+    }
+    glFinish();
+    timer.finish();
+    timer.destroy();
+    if (!tracePath.empty()) {
+        profiler.finish();
+        profiler.writeTrace(tracePath);
+    }
+
+    if (reportPath.empty() || reportPath == "-") {
+        writeBenchmarkJson(std::cout, timer, timeline.warmupFrames, SCR_WIDTH, SCR_HEIGHT, renderSizes);
+        return true;
+    }
+    std::ofstream report(reportPath);
+    if (!report.is_open()) {
+        std::cerr << "Nie mozna zapisac raportu: " << reportPath << std::endl;
+        return false;
+    }
+    writeBenchmarkJson(report, timer, timeline.warmupFrames, SCR_WIDTH, SCR_HEIGHT, renderSizes);
+    std::cout << "Raport benchmarku: " << reportPath << std::endl;
+    return true;
+}
 
-        // Maszt na flage
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, -5.0f));
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
-            mainShader.setMat4("model", model);
-            mainShader.setMat3("normalMatrix", normalMatrix);
-            mainShader.setVec3("objectColor", glm::vec3(0.4f, 0.3f, 0.2f));
-            glBindVertexArray(cylinder.VAO);
-            glDrawElements(GL_TRIANGLES, cylinder.indexCount, GL_UNSIGNED_INT, 0);
+// ============== MAIN ==============
+struct Options {
+    bool headless = false;
+    bool shaderCache = true;
+    std::string benchmarkPath;   // scenariusz benchmarku (pusty = tryb interaktywny)
+    std::string reportPath;      // raport JSON (pusty lub "-" = stdout)
+    std::string tracePath;       // trace profilera calego benchmarku (Chrome trace)
+    int stressObjects = 0;       // dodatkowe statyczne obiekty wokol podlogi
+    VertexLayout layout = vertexLayout;
+    bool gpuDriven = false;      // culling i MDI na GPU (GL 4.3+), inaczej instancje
+    std::string modelPath;       // model OBJ dodawany do sceny
+    bool meshCache = true;       // cache przetworzonych modeli (mesh_cache/)
+    bool lod = true;             // wybor poziomu LOD (wylaczony - zawsze poziom 0)
+    int banners = 0;             // dodatkowe flagi (egzemplarze powierzchni Beziera)
+    std::string patchPath;       // plik platow Beziera (format Utah teapot)
+    int streetLights = 0;        // dodatkowe swiatla: latarnie i reflektory pojazdow
+    bool deferred = false;       // tryb odroczony (G-buffer) od pierwszej klatki
+    bool shadows = true;         // mapy cieni swiatel sceny
+    bool depthPrepass = false;   // pre-pass glebokosci przed cieniowaniem
+    bool sort = false;           // sortowanie nieprzezroczystych od przodu
+    bool stateSort = true;       // kolejka rysowania sortowana wg stanu GL
+    int tickRate = SIMULATION_TICK_RATE;   // takty symulacji na sekunde (tryb interaktywny)
+    bool shaderReport = false;   // raport wariantow shaderow po zakonczeniu
+    std::string texturePath;     // tekstura torusa i modelu (PPM, TGA albo .tex)
+    size_t textureBudgetMB = TEXTURE_BUDGET_DEFAULT >> 20;   // budzet pamieci tekstur
+    bool textureCache = true;    // cache skompresowanych tekstur (texture_cache/)
+    bool dynamicResolution = false;                   // regulator skali rozdzielczosci od startu
+    float targetMs = RESOLUTION_TARGET_MS_DEFAULT;    // docelowy czas GPU klatki regulatora
+    float minScale = RESOLUTION_MIN_SCALE_DEFAULT;    // granice skali regulatora
+    float maxScale = RESOLUTION_MAX_SCALE_DEFAULT;
+    float renderScale = 1.0f;                         // stala skala bez regulatora
+};
+
+// compact - normalne 2_10_10_10 + UV half, unorm16 - UV jako ushort, float - 32 B i indeksy 32-bit
+bool parseVertexFormat(const std::string& name, VertexLayout& layout) {
+    bool optimize = layout.optimizeIndices;
+    if (name == "compact") {
+        layout.normals = NORMAL_PACKED;
+        layout.uvs = UV_HALF;
+        layout.shortIndices = true;
+    } else if (name == "unorm16") {
+        layout.normals = NORMAL_PACKED;
+        layout.uvs = UV_UNORM16;
+        layout.shortIndices = true;
+    } else if (name == "float") {
+        layout = floatVertexLayout();
+    } else {
+        std::cerr << "Nieznany format wierzcholkow: " << name << std::endl;
+        return false;
+    }
+    layout.optimizeIndices = optimize;
+    return true;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--no-shader-cache") {
+            options.shaderCache = false;
+        } else if (arg == "--benchmark" && i + 1 < argc) {
+            options.benchmarkPath = argv[++i];
+        } else if (arg == "--report" && i + 1 < argc) {
+            options.reportPath = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--stress" && i + 1 < argc) {
+            options.stressObjects = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--vertex-format" && i + 1 < argc) {
+            if (!parseVertexFormat(argv[++i], options.layout)) return false;
+        } else if (arg == "--no-mesh-opt") {
+            options.layout.optimizeIndices = false;
+        } else if (arg == "--gpu-driven") {
+            options.gpuDriven = true;
+        } else if (arg == "--model" && i + 1 < argc) {
+            options.modelPath = argv[++i];
+        } else if (arg == "--no-mesh-cache") {
+            options.meshCache = false;
+        } else if (arg == "--no-lod") {
+            options.lod = false;
+        } else if (arg == "--banners" && i + 1 < argc) {
+            options.banners = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--patches" && i + 1 < argc) {
+            options.patchPath = argv[++i];
+        } else if (arg == "--lights" && i + 1 < argc) {
+            options.streetLights = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--deferred") {
+            options.deferred = true;
+        } else if (arg == "--no-shadows") {
+            options.shadows = false;
+        } else if (arg == "--depth-prepass") {
+            options.depthPrepass = true;
+        } else if (arg == "--sort") {
+            options.sort = true;
+        } else if (arg == "--no-state-sort") {
+            options.stateSort = false;
+        } else if (arg == "--tick-rate" && i + 1 < argc) {
+            options.tickRate = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--shader-report") {
+            options.shaderReport = true;
+        } else if (arg == "--texture" && i + 1 < argc) {
+            options.texturePath = argv[++i];
+        } else if (arg == "--texture-budget" && i + 1 < argc) {
+            options.textureBudgetMB = (size_t)std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--no-texture-cache") {
+            options.textureCache = false;
+        } else if (arg == "--dynamic-resolution") {
+            options.dynamicResolution = true;
+        } else if (arg == "--target-ms" && i + 1 < argc) {
+            options.targetMs = std::max(1.0f, (float)std::atof(argv[++i]));
+        } else if (arg == "--min-scale" && i + 1 < argc) {
+            options.minScale = glm::clamp((float)std::atof(argv[++i]), RESOLUTION_SCALE_LIMIT, 1.0f);
+        } else if (arg == "--max-scale" && i + 1 < argc) {
+            options.maxScale = glm::clamp((float)std::atof(argv[++i]), RESOLUTION_SCALE_LIMIT, 1.0f);
+        } else if (arg == "--render-scale" && i + 1 < argc) {
+            options.renderScale = glm::clamp((float)std::atof(argv[++i]), RESOLUTION_SCALE_LIMIT, 1.0f);
+        } else {
+            std::cerr << "Uzycie: " << argv[0]
+                      << " [--headless] [--benchmark <scenariusz>] [--report <plik.json>]"
+                      << " [--trace <plik.json>] [--stress <liczba obiektow>] [--no-shader-cache]"
+                      << " [--vertex-format <compact|unorm16|float>] [--no-mesh-opt] [--gpu-driven]"
+                      << " [--model <plik.obj>] [--no-mesh-cache] [--no-lod]"
+                      << " [--banners <liczba>] [--patches <plik>] [--lights <liczba>]"
+                      << " [--deferred] [--no-shadows] [--depth-prepass] [--sort]"
+                      << " [--no-state-sort] [--tick-rate <hz>] [--shader-report]"
+                      << " [--texture <plik.ppm|tga|tex>] [--texture-budget <MB>] [--no-texture-cache]"
+                      << " [--dynamic-resolution] [--target-ms <ms>] [--min-scale <s>] [--max-scale <s>]"
+                      << " [--render-scale <s>]" << std::endl;
+            return false;
         }
+    }
+    if (options.minScale > options.maxScale) {
+        std::cerr << "--min-scale wieksze niz --max-scale - przyjeto " << options.maxScale << std::endl;
+        options.minScale = options.maxScale;
+    }
+    if (options.headless && options.benchmarkPath.empty()) {
+        options.benchmarkPath = "benchmarks/camera_path.txt";
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return -1;
+    shaderBinaryCache().setEnabled(options.shaderCache);
+    cookedMeshCache().setEnabled(options.meshCache);
+    cookedTextureCache().setEnabled(options.textureCache);
+    textureBudgetBytes = options.textureBudgetMB << 20;
+    lodEnabled = options.lod;
+    deferredShading = options.deferred;
+    shadowsEnabled = options.shadows;
+    depthPrepass = options.depthPrepass;
+    sortFrontToBack = options.sort;
+    stateSorting = options.stateSort;
+    dynamicResolution = options.dynamicResolution;
+    renderScale = options.renderScale;
+    resolutionTargetMs = options.targetMs;
+    resolutionMinScale = options.minScale;
+    resolutionMaxScale = options.maxScale;
+    vertexLayout = options.layout;
+
+    BenchmarkTimeline timeline;
+    if (!options.benchmarkPath.empty() && !timeline.loadFromFile(options.benchmarkPath)) {
+        return -1;
+    }
+
+    GLFWwindow* window = NULL;
+#ifdef HAVE_EGL
+    HeadlessContext headless;
+#endif
 
-        // ====== RENDEROWANIE FLAGI (BEZIER) ======
-        glDisable(GL_CULL_FACE); // Flaga jest widoczna z obu stron
-
-        bezierShader.use();
-        bezierShader.setMat4("projection", projection);
-        bezierShader.setMat4("view", view);
-        setLightUniforms(bezierShader, view);
-
-        // Ustawienia flagi
-        bezierShader.setFloat("time", (float)glfwGetTime());
-        bezierShader.setFloat("windStrength", windStrength);
-        bezierShader.setVec2("windDirection", glm::vec2(1.0f, 0.3f));
-        bezierShader.setInt("tessLevelOuter", tessLevel);
-        bezierShader.setInt("tessLevelInner", tessLevel);
-        bezierShader.setBool("useFlagColors", true);
-        bezierShader.setVec3("flagColor1", glm::vec3(1.0f, 1.0f, 1.0f)); // Bialy
-        bezierShader.setVec3("flagColor2", glm::vec3(0.9f, 0.1f, 0.2f)); // Czerwony
-
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, -5.0f));
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * model)));
-            bezierShader.setMat4("model", model);
-            bezierShader.setMat3("normalMatrix", normalMatrix);
-
-            glBindVertexArray(bezierPatch.VAO);
-            glPatchParameteri(GL_PATCH_VERTICES, 16);
-            glDrawArrays(GL_PATCHES, 0, 16);
+    if (options.headless) {
+#ifdef HAVE_EGL
+        if (!headless.create()) return -1;
+#else
+        std::cerr << "Tryb headless wymaga EGL (brak przy kompilacji)" << std::endl;
+        return -1;
+#endif
+    } else {
+        // Inicjalizacja GLFW
+        if (!glfwInit()) {
+            std::cerr << "Nie mozna zainicjalizowac GLFW" << std::endl;
+            return -1;
         }
 
-        glEnable(GL_CULL_FACE); // Przywroc culling
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
 
-        // Swap buffers
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, WINDOW_TITLE, NULL, NULL);
+        if (!window) {
+            std::cerr << "Nie mozna utworzyc okna GLFW" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
 
-    // Cleanup
-    glDeleteVertexArrays(1, &sphere.VAO);
-    glDeleteBuffers(1, &sphere.VBO);
-    glDeleteBuffers(1, &sphere.EBO);
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetKeyCallback(window, key_callback);
+    }
 
-    glDeleteVertexArrays(1, &cube.VAO);
-    glDeleteBuffers(1, &cube.VBO);
-    glDeleteBuffers(1, &cube.EBO);
+    // Inicjalizacja GLEW (bez okna tylko czesc kontekstowa - brak GLX)
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = options.headless ? glewContextInit() : glewInit();
+    if (glewStatus != GLEW_OK) {
+        std::cerr << "Nie mozna zainicjalizowac GLEW" << std::endl;
+        return -1;
+    }
 
-    glDeleteVertexArrays(1, &plane.VAO);
-    glDeleteBuffers(1, &plane.VBO);
-    glDeleteBuffers(1, &plane.EBO);
+#ifdef HAVE_EGL
+    if (options.headless) {
+        if (!headless.createFramebuffer(SCR_WIDTH, SCR_HEIGHT)) return -1;
+        outputFramebuffer = headless.framebuffer;
+    }
+#endif
 
-    glDeleteVertexArrays(1, &torus.VAO);
-    glDeleteBuffers(1, &torus.VBO);
-    glDeleteBuffers(1, &torus.EBO);
+    Scene scene;
+    if (!initScene(scene, window, options.stressObjects, options.gpuDriven, options.modelPath, options.banners,
+                   options.patchPath, options.streetLights, options.texturePath)) return -1;
+
+    int exitCode = 0;
+    if (!options.benchmarkPath.empty()) {
+        // Bez vsync - mierzymy czas renderowania, nie odswiezania ekranu
+        if (window) glfwSwapInterval(0);
+        // Tekstury wczytane przed pomiarem - czasy klatek bez wysylania w tle
+        scene.textures.finish();
+        if (!runBenchmark(scene, timeline, window, options.reportPath, options.tracePath)) exitCode = -1;
+    } else {
+        std::cout << "\n=== STEROWANIE ===" << std::endl;
+        std::cout << "WASD - ruch obiektu" << std::endl;
+        std::cout << "Strzalki - kierunek reflektora" << std::endl;
+        std::cout << "1/2/3 - przelaczanie kamer" << std::endl;
+        std::cout << "F - wlacz/wylacz mgle" << std::endl;
+        std::cout << "B - przelacz Phong/Blinn" << std::endl;
+        std::cout << "N - dzien/noc (szybkie)" << std::endl;
+        std::cout << "O/P - plynna zmiana dnia/nocy" << std::endl;
+        std::cout << "+/- - gestosc mgly" << std::endl;
+        std::cout << "T/G - poziom tessellation" << std::endl;
+        std::cout << "Y/H - sila wiatru" << std::endl;
+        std::cout << "C - frustum culling" << std::endl;
+        std::cout << "L - wybor poziomow LOD" << std::endl;
+        std::cout << "V - adaptacyjna tessellation" << std::endl;
+        std::cout << "R - tryb odroczony (deferred)" << std::endl;
+        std::cout << "K - mapy cieni" << std::endl;
+        std::cout << "Z/X - pre-pass glebokosci / sortowanie od przodu" << std::endl;
+        std::cout << "Q - sortowanie wg stanu" << std::endl;
+        std::cout << "F1 - statystyki profilera" << std::endl;
+        std::cout << "F2 - zapis trace (" << TRACE_PATH << ")" << std::endl;
+        std::cout << "F3 - raport wariantow shaderow" << std::endl;
+        std::cout << "U - dynamiczna rozdzielczosc" << std::endl;
+        std::cout << "ESC - wyjscie" << std::endl;
+        std::cout << "==================\n" << std::endl;
+
+        // Symulacja startuje po wczytaniu sceny - czas animacji od zera
+        sceneTime = 0.0f;
+        simulation.start(currentSimulationState(), options.tickRate);
+
+        // Glowna petla renderowania
+        while (!glfwWindowShouldClose(window)) {
+            processInput(window);
+            applySimulationState(simulation.sample());
+            renderScene(scene);
+
+            if (traceRequested && !profiler.isCapturing()) {
+                profiler.writeTrace(TRACE_PATH);
+                traceRequested = false;
+            }
+            if (shaderReportRequested) {
+                printShaderReport(scene, std::cout);
+                shaderReportRequested = false;
+            }
 
-    glDeleteVertexArrays(1, &bezierPatch.VAO);
-    glDeleteBuffers(1, &bezierPatch.VBO);
+            // Swap buffers
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        simulation.stop();
+    }
+    if (options.shaderReport) printShaderReport(scene, std::cout);
 
-    glDeleteVertexArrays(1, &cylinder.VAO);
-    glDeleteBuffers(1, &cylinder.VBO);
-    glDeleteBuffers(1, &cylinder.EBO);
+    // Cleanup
+    destroyScene(scene);
 
-    glfwTerminate();
-    return 0;
+#ifdef HAVE_EGL
+    headless.destroy();
+#endif
+    if (window) glfwTerminate();
+    return exitCode;
 }
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ============== PLIK ZMAPOWANY W PAMIECI ==============
+// Wspolny dla cache siatek (model_loader.h) i tekstur (texture_streaming.h):
+// gotowe dane czytane wprost z mapowania, bez kopiowania do buforow CPU.
+
+// Plik tylko do odczytu zmapowany w pamieci (bez mmap - wczytany w calosci)
+class MappedFile {
+public:
+    MappedFile() : address(NULL), length(0), mapped(false) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        length = (size_t)info.st_size;
+        if (length > 0) {
+            void* view = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            madvise(view, length, MADV_SEQUENTIAL);
+            address = (const char*)view;
+            mapped = true;
+        }
+        ::close(fd);   // mapowanie zostaje wazne po zamknieciu deskryptora
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        address = buffer.data();
+        length = buffer.size();
+        return true;
+#endif
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (mapped) munmap((void*)address, length);
+#endif
+        buffer.clear();
+        address = NULL;
+        length = 0;
+        mapped = false;
+    }
+
+    const char* data() const { return address; }
+    size_t size() const { return length; }
+
+private:
+    const char* address;
+    size_t length;
+    bool mapped;
+    std::vector<char> buffer;
+};
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "culling.h"
+#include "gl_state.h"
+#include "gpu_geometry.h"
+#include "mesh_optimizer.h"
+#include "profiler.h"
+
+// ============== SIATKI I FORMATY WIERZCHOLKOW ==============
+// Generatory oddaja wierzcholki jako 8 floatow (pozycja, normalna, UV) i indeksy
+// 32-bitowe. uploadMesh porzadkuje je pod cache wierzcholkow, pakuje do formatu
+// z vertexLayout i umieszcza we wspolnych buforach GeometryPool:
+//   pozycja  - 3 x float (12 B)
+//   normalna - 3 x float (12 B) lub GL_INT_2_10_10_10_REV (4 B)
+//   UV       - 2 x float (8 B), 2 x half (4 B) lub 2 x znormalizowany ushort (4 B)
+// Skompaktowany wierzcholek ma 20 B zamiast 32 B. Indeksy sa 16-bitowe,
+// jesli siatka ma najwyzej 65536 wierzcholkow.
+
+const size_t SOURCE_VERTEX_FLOATS = 8;
+
+enum NormalFormat {
+    NORMAL_FLOAT,
+    NORMAL_PACKED
+};
+
+enum UvFormat {
+    UV_FLOAT,
+    UV_HALF,
+    UV_UNORM16   // tylko UV w zakresie 0-1 (wartosci spoza sa obcinane)
+};
+
+struct VertexLayout {
+    NormalFormat normals;
+    UvFormat uvs;
+    bool shortIndices;
+    bool optimizeIndices;   // Forsyth + kolejnosc wierzcholkow wg uzycia
+};
+
+// Format uzywany przez wszystkie generatory (ustawiany z linii polecen)
+inline VertexLayout vertexLayout = {NORMAL_PACKED, UV_HALF, true, true};
+
+// Uklad sprzed kompaktowania - do porownan w benchmarku
+inline VertexLayout floatVertexLayout() {
+    VertexLayout layout = {NORMAL_FLOAT, UV_FLOAT, false, true};
+    return layout;
+}
+
+// Uchwyt siatki w GeometryPool - zwalnia swoj zakres w destruktorze.
+// Mozna go tylko przenosic; pula musi zyc dluzej niz uchwyty (po destroy()
+// zwalnianie jest bezpieczne i nic nie robi).
+class Mesh {
+public:
+    AABB bounds;   // w ukladzie modelu
+
+    Mesh() : bounds(emptyAABB()), pool(NULL), id(-1) {}
+    Mesh(GeometryPool* owner, int allocationId, const AABB& meshBounds)
+        : bounds(meshBounds), pool(owner), id(allocationId) {}
+    ~Mesh() { release(); }
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    Mesh(Mesh&& other) : bounds(other.bounds), pool(other.pool), id(other.id) {
+        other.pool = NULL;
+        other.id = -1;
+    }
+
+    Mesh& operator=(Mesh&& other) {
+        if (this != &other) {
+            release();
+            bounds = other.bounds;
+            pool = other.pool;
+            id = other.id;
+            other.pool = NULL;
+            other.id = -1;
+        }
+        return *this;
+    }
+
+    bool valid() const { return pool != NULL && id >= 0; }
+
+    void release() {
+        if (valid()) pool->free(id);
+        pool = NULL;
+        id = -1;
+    }
+
+    // Aktualny zakres - offsety moga sie zmienic po defragmentacji puli
+    const GeometryAllocation& range() const { return pool->allocation(id); }
+    GeometryPool* owner() const { return pool; }
+    unsigned int indexCount() const { return (unsigned int)range().indexCount; }
+    unsigned int vertexCount() const { return (unsigned int)range().vertexCount; }
+
+private:
+    GeometryPool* pool;
+    int id;
+};
+
+// Normalna na 10 bitow ze znakiem na skladowa, w = 0. Skala 511 wg GL 4.2+;
+// starsza konwersja (2c+1)/1023 daje przesuniecie < 0.001, ktore znika
+// po normalize() w shaderze.
+inline uint32_t packNormal(float x, float y, float z) {
+    auto pack10 = [](float v) {
+        int value = (int)std::lround(std::min(std::max(v, -1.0f), 1.0f) * 511.0f);
+        return (uint32_t)value & 0x3FFu;
+    };
+    return pack10(x) | (pack10(y) << 10) | (pack10(z) << 20);
+}
+
+// float -> half z zaokragleniem; wartosci ponizej ~6e-5 ida do zera (bez denormali)
+inline uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent <= 0) return (uint16_t)sign;
+    if (exponent >= 31) return (uint16_t)(sign | 0x7C00u);
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u) ++half;   // przeniesienie do wykladnika jest poprawne
+    return (uint16_t)half;
+}
+
+inline uint16_t floatToUnorm16(float value) {
+    return (uint16_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f);
+}
+
+inline size_t vertexStride(const VertexLayout& layout) {
+    size_t stride = 3 * sizeof(float);
+    stride += (layout.normals == NORMAL_PACKED) ? sizeof(uint32_t) : 3 * sizeof(float);
+    stride += (layout.uvs == UV_FLOAT) ? 2 * sizeof(float) : 2 * sizeof(uint16_t);
+    return stride;
+}
+
+// Pakuje wierzcholki zrodlowe (8 floatow) do bufora w danym ukladzie
+inline std::vector<unsigned char> packVertices(const std::vector<float>& vertices, const VertexLayout& layout) {
+    size_t count = vertices.size() / SOURCE_VERTEX_FLOATS;
+    size_t stride = vertexStride(layout);
+    std::vector<unsigned char> packed(count * stride);
+
+    for (size_t i = 0; i < count; ++i) {
+        const float* src = &vertices[i * SOURCE_VERTEX_FLOATS];
+        unsigned char* dst = &packed[i * stride];
+
+        std::memcpy(dst, src, 3 * sizeof(float));
+        dst += 3 * sizeof(float);
+
+        if (layout.normals == NORMAL_PACKED) {
+            uint32_t normal = packNormal(src[3], src[4], src[5]);
+            std::memcpy(dst, &normal, sizeof(normal));
+            dst += sizeof(normal);
+        } else {
+            std::memcpy(dst, src + 3, 3 * sizeof(float));
+            dst += 3 * sizeof(float);
+        }
+
+        if (layout.uvs == UV_FLOAT) {
+            std::memcpy(dst, src + 6, 2 * sizeof(float));
+        } else {
+            uint16_t uv[2];
+            for (int k = 0; k < 2; ++k) {
+                uv[k] = (layout.uvs == UV_HALF) ? floatToHalf(src[6 + k]) : floatToUnorm16(src[6 + k]);
+            }
+            std::memcpy(dst, uv, sizeof(uv));
+        }
+    }
+    return packed;
+}
+
+// Atrybuty 0..2 dla aktualnie zwiazanego VAO i VBO
+inline void setupVertexAttributes(const VertexLayout& layout) {
+    GLsizei stride = (GLsizei)vertexStride(layout);
+    size_t offset = 0;
+
+    // Pozycja
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    glEnableVertexAttribArray(0);
+    offset += 3 * sizeof(float);
+
+    // Normalna - spakowany format wymaga 4 skladowych, shader czyta vec3
+    if (layout.normals == NORMAL_PACKED) {
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offset);
+        offset += sizeof(uint32_t);
+    } else {
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        offset += 3 * sizeof(float);
+    }
+    glEnableVertexAttribArray(1);
+
+    // UV
+    if (layout.uvs == UV_HALF) {
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offset);
+    } else if (layout.uvs == UV_UNORM16) {
+        glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offset);
+    } else {
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    }
+    glEnableVertexAttribArray(2);
+}
+
+// Siatka gotowa do wyslania: wierzcholki w ukladzie GPU i indeksy w docelowym typie
+// (tez zawartosc pliku w cache siatek - patrz model_loader.h)
+struct PackedMesh {
+    std::vector<unsigned char> vertices;
+    std::vector<unsigned char> indices;
+    size_t vertexCount;
+    size_t indexCount;
+    GLenum indexType;
+    AABB bounds;
+};
+
+// Porzadkuje i pakuje siatke; wypisuje ACMR/ATVR przed i po optymalizacji.
+// vertices i indices moga zostac zmienione (nowa kolejnosc).
+inline PackedMesh packMesh(std::vector<float>& vertices, std::vector<unsigned int>& indices, const char* name,
+                           const VertexLayout& layout = vertexLayout) {
+    size_t vertexCount = vertices.size() / SOURCE_VERTEX_FLOATS;
+    VertexCacheStats before = analyzeVertexCache(indices, vertexCount);
+    if (layout.optimizeIndices) {
+        indices = optimizeVertexCache(indices, vertexCount);
+        optimizeVertexFetch(vertices, SOURCE_VERTEX_FLOATS, indices);
+        vertexCount = vertices.size() / SOURCE_VERTEX_FLOATS;
+    }
+    VertexCacheStats after = analyzeVertexCache(indices, vertexCount);
+
+    PackedMesh mesh;
+    mesh.vertexCount = vertexCount;
+    mesh.indexCount = indices.size();
+    mesh.indexType = (layout.shortIndices && vertexCount <= 65536) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    mesh.bounds = computeBounds(vertices.data(), vertexCount, SOURCE_VERTEX_FLOATS);
+    mesh.vertices = packVertices(vertices, layout);
+    if (mesh.indexType == GL_UNSIGNED_SHORT) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        mesh.indices.resize(shortIndices.size() * sizeof(uint16_t));
+        std::memcpy(mesh.indices.data(), shortIndices.data(), mesh.indices.size());
+    } else {
+        mesh.indices.resize(indices.size() * sizeof(unsigned int));
+        std::memcpy(mesh.indices.data(), indices.data(), mesh.indices.size());
+    }
+
+    std::cout << "Siatka " << name << ": " << vertexCount << " wierzcholkow x " << vertexStride(layout)
+              << " B, " << indices.size() / 3 << " trojkatow, indeksy "
+              << (mesh.indexType == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit, ACMR " << before.acmr << " -> "
+              << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+    return mesh;
+}
+
+// Jedno wyslanie gotowych danych do puli (np. prosto z pliku zmapowanego w pamieci)
+inline Mesh uploadPackedMesh(GeometryPool& pool, const void* vertices, size_t vertexCount, const void* indices,
+                             size_t indexCount, GLenum indexType, const AABB& bounds, const char* name) {
+    int id = pool.allocate(vertices, vertexCount, indices, indexCount, indexType);
+    if (id < 0) {
+        std::cerr << "Nie mozna umiescic siatki " << name << " w buforach geometrii" << std::endl;
+        return Mesh();
+    }
+    return Mesh(&pool, id, bounds);
+}
+
+// Porzadkuje, pakuje i umieszcza siatke w puli.
+// Pula musi byc zainicjalizowana z tym samym ukladem (initGeometryPool).
+inline Mesh uploadMesh(GeometryPool& pool, std::vector<float>& vertices, std::vector<unsigned int>& indices,
+                       const char* name, const VertexLayout& layout = vertexLayout) {
+    PackedMesh packed = packMesh(vertices, indices, name, layout);
+    return uploadPackedMesh(pool, packed.vertices.data(), packed.vertexCount, packed.indices.data(),
+                            packed.indexCount, packed.indexType, packed.bounds, name);
+}
+
+// Pula z atrybutami w ukladzie vertexLayout (ustalanym przed utworzeniem siatek)
+inline void initGeometryPool(GeometryPool& pool) {
+    pool.init(vertexStride(vertexLayout), []() { setupVertexAttributes(vertexLayout); });
+}
+
+// Rysowanie siatki z indeksami. Siatki jednego bloku puli dziela VAO,
+// wiec kolejne wywolania nie zmieniaja stanu.
+inline void drawMesh(const Mesh& mesh) {
+    if (!mesh.valid()) return;
+    const GeometryAllocation& range = mesh.range();
+    bindVertexArray(mesh.owner()->vertexArray(range.block));
+    glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)range.indexCount, range.indexType,
+                             (void*)range.indexOffset, (GLint)range.firstVertex);
+    countDrawCall();
+    countTriangles((unsigned int)(range.indexCount / 3));
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// ============== OPTYMALIZACJA BUFOROW INDEKSOW ==============
+// 1. Kolejnosc trojkatow pod cache wierzcholkow po transformacji
+//    (algorytm Forsytha, "Linear-Speed Vertex Cache Optimisation").
+// 2. Kolejnosc wierzcholkow wg pierwszego uzycia - odczyty z VBO ida
+//    mniej wiecej sekwencyjnie.
+// 3. Statystyki symulowanego cache FIFO:
+//    ACMR - chybienia na trojkat (1 = bez ponownego uzycia; ~0.5-0.7 dobrze),
+//    ATVR - chybienia na wierzcholek (1.0 = kazdy wierzcholek liczony raz).
+
+const int FORSYTH_CACHE_SIZE = 32;   // model LRU uzywany przy ocenie
+const int STATS_CACHE_SIZE = 16;     // FIFO do raportowania (typowe GPU)
+
+struct VertexCacheStats {
+    float acmr;
+    float atvr;
+};
+
+// Symulacja FIFO o danym rozmiarze
+inline VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount,
+                                           int cacheSize = STATS_CACHE_SIZE) {
+    VertexCacheStats stats = {0.0f, 0.0f};
+    if (indices.empty() || vertexCount == 0) return stats;
+
+    // Wierzcholek jest w cache, gdy od jego wczytania bylo mniej niz cacheSize chybien
+    // (loadedAt - numer chybienia, ktore go wczytalo, od 1; 0 - jeszcze nie wczytany)
+    std::vector<unsigned int> loadedAt(vertexCount, 0);
+    unsigned int misses = 0;
+    for (unsigned int index : indices) {
+        if (loadedAt[index] == 0 || misses - loadedAt[index] >= (unsigned int)cacheSize) {
+            ++misses;
+            loadedAt[index] = misses;
+        }
+    }
+    stats.acmr = (float)misses / (indices.size() / 3);
+    stats.atvr = (float)misses / vertexCount;
+    return stats;
+}
+
+inline float forsythVertexScore(int cachePosition, int remainingTriangles) {
+    if (remainingTriangles == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // Wierzcholki ostatniego trojkata - celowo nizej, zeby nie tworzyc pasow
+            score = 0.75f;
+        } else {
+            float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, 1.5f);
+        }
+    }
+    // Premia za malo pozostalych trojkatow - domykanie "wysp"
+    score += 2.0f * std::pow((float)remainingTriangles, -0.5f);
+    return score;
+}
+
+// Zwraca indeksy w nowej kolejnosci trojkatow (te same wierzcholki)
+inline std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    std::vector<unsigned int> result;
+    result.reserve(triangleCount * 3);
+    if (triangleCount == 0) return result;
+
+    // Lista trojkatow kazdego wierzcholka; remaining = liczba jeszcze nie wyemitowanych
+    std::vector<int> remaining(vertexCount, 0);
+    for (unsigned int index : indices) ++remaining[index];
+    std::vector<int> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + remaining[v];
+    std::vector<int> adjacency(indices.size());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = (int)t;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = forsythVertexScore(-1, remaining[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    int bestTriangle = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+                           vertexScore[indices[t * 3 + 2]];
+        if (triangleScore[t] > triangleScore[bestTriangle]) bestTriangle = (int)t;
+    }
+
+    std::vector<int> cache, newCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+    size_t scanCursor = 0;
+
+    for (size_t step = 0; step < triangleCount; ++step) {
+        if (bestTriangle < 0) {
+            // Brak kandydata w cache - pierwszy niewyemitowany trojkat
+            while (emitted[scanCursor]) ++scanCursor;
+            bestTriangle = (int)scanCursor;
+        }
+
+        const unsigned int* tri = &indices[bestTriangle * 3];
+        result.insert(result.end(), tri, tri + 3);
+        emitted[bestTriangle] = 1;
+
+        // Usun trojkat z list sasiedztwa jego wierzcholkow
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = tri[k];
+            int* list = &adjacency[offsets[v]];
+            for (int i = 0; i < remaining[v]; ++i) {
+                if (list[i] == bestTriangle) {
+                    std::swap(list[i], list[remaining[v] - 1]);
+                    break;
+                }
+            }
+            --remaining[v];
+        }
+
+        // LRU: wierzcholki trojkata na poczatek, reszta przesunieta
+        newCache.assign(tri, tri + 3);
+        for (int v : cache) {
+            if (v != (int)tri[0] && v != (int)tri[1] && v != (int)tri[2]) newCache.push_back(v);
+        }
+
+        // Nowe wyniki wierzcholkow w cache (i wypadajacych z niego) oraz ich trojkatow
+        for (size_t i = 0; i < newCache.size(); ++i) {
+            int v = newCache[i];
+            cachePosition[v] = (i < (size_t)FORSYTH_CACHE_SIZE) ? (int)i : -1;
+            vertexScore[v] = forsythVertexScore(cachePosition[v], remaining[v]);
+        }
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < newCache.size(); ++i) {
+            int v = newCache[i];
+            for (int j = 0; j < remaining[v]; ++j) {
+                int t = adjacency[offsets[v] + j];
+                float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+                              vertexScore[indices[t * 3 + 2]];
+                triangleScore[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (newCache.size() > (size_t)FORSYTH_CACHE_SIZE) newCache.resize(FORSYTH_CACHE_SIZE);
+        cache.swap(newCache);
+    }
+    return result;
+}
+
+// Przenumerowuje wierzcholki w kolejnosci pierwszego uzycia (indeksy poprawiane
+// w miejscu). Nieuzywane wierzcholki sa usuwane. stride w floatach.
+inline void optimizeVertexFetch(std::vector<float>& vertices, size_t stride, std::vector<unsigned int>& indices) {
+    size_t vertexCount = vertices.size() / stride;
+    const unsigned int unused = ~0u;
+    std::vector<unsigned int> remap(vertexCount, unused);
+    std::vector<float> reordered;
+    reordered.reserve(vertices.size());
+
+    unsigned int next = 0;
+    for (unsigned int& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = next++;
+            reordered.insert(reordered.end(), vertices.begin() + index * stride,
+                             vertices.begin() + (index + 1) * stride);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
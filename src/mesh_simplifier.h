@@ -0,0 +1,232 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+// ============== UPRASZCZANIE SIATEK ==============
+// Zwijanie krawedzi z metryka bledu kwadrykowego (Garland-Heckbert) w wersji
+// "half-edge collapse": wierzcholek przesuwany jest na istniejacego sasiada,
+// wiec uproszczona siatka to tylko nowe indeksy do tych samych wierzcholkow.
+// Wierzcholki na szwach atrybutow (ta sama pozycja, rozne normalne/UV) i na
+// brzegach siatki sa zablokowane - ich zwiniecie otwieraloby dziury.
+// Kazdy przebieg zwija niezalezne krawedzie od najtanszych; sasiedztwo
+// zwinietego wierzcholka czeka do nastepnego przebiegu (aktualne kwadryki).
+
+// Symetryczna macierz 4x4 bledu: a2 ab ac ad b2 bc bd c2 cd d2, weight - suma pol
+struct Quadric {
+    double m[10];
+    double weight;
+};
+
+inline Quadric planeQuadric(const glm::vec3& normal, double d, double weight) {
+    Quadric q;
+    q.m[0] = normal.x * normal.x * weight;
+    q.m[1] = normal.x * normal.y * weight;
+    q.m[2] = normal.x * normal.z * weight;
+    q.m[3] = normal.x * d * weight;
+    q.m[4] = normal.y * normal.y * weight;
+    q.m[5] = normal.y * normal.z * weight;
+    q.m[6] = normal.y * d * weight;
+    q.m[7] = normal.z * normal.z * weight;
+    q.m[8] = normal.z * d * weight;
+    q.m[9] = d * d * weight;
+    q.weight = weight;
+    return q;
+}
+
+inline void addQuadric(Quadric& target, const Quadric& q) {
+    for (int i = 0; i < 10; ++i) target.m[i] += q.m[i];
+    target.weight += q.weight;
+}
+
+// Sredni (wazony polem) kwadrat odleglosci od plaszczyzn kwadryki
+inline double quadricError(const Quadric& q, const glm::vec3& p) {
+    double x = p.x, y = p.y, z = p.z;
+    double error = q.m[0] * x * x + 2.0 * q.m[1] * x * y + 2.0 * q.m[2] * x * z + 2.0 * q.m[3] * x +
+                   q.m[4] * y * y + 2.0 * q.m[5] * y * z + 2.0 * q.m[6] * y + q.m[7] * z * z +
+                   2.0 * q.m[8] * z + q.m[9];
+    return q.weight > 0.0 ? std::max(error, 0.0) / q.weight : 0.0;
+}
+
+// Upraszcza siatke do najwyzej targetIndexCount indeksow, o ile blad nie
+// przekroczy targetError (ulamek przekatnej AABB). Zwraca nowe indeksy do tych
+// samych wierzcholkow; osiagniety blad (w tej samej skali) w resultError.
+inline std::vector<unsigned int> simplifyMesh(const std::vector<float>& vertices, size_t strideFloats,
+                                              const std::vector<unsigned int>& indices, size_t targetIndexCount,
+                                              float targetError, float* resultError = NULL) {
+    size_t vertexCount = vertices.size() / strideFloats;
+    auto positionAt = [&vertices, strideFloats](unsigned int v) {
+        const float* p = &vertices[v * strideFloats];
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    // Reprezentant pozycji - pierwszy wierzcholek o tych samych wspolrzednych
+    struct PositionKey {
+        uint32_t bits[3];
+        bool operator==(const PositionKey& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+    };
+    struct PositionHash {
+        size_t operator()(const PositionKey& key) const {
+            return (size_t)((key.bits[0] * 73856093u) ^ (key.bits[1] * 19349663u) ^ (key.bits[2] * 83492791u));
+        }
+    };
+    std::unordered_map<PositionKey, unsigned int, PositionHash> firstAt;
+    firstAt.reserve(vertexCount);
+    std::vector<unsigned int> positionOf(vertexCount);
+    std::vector<unsigned char> locked(vertexCount, 0);
+    glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        PositionKey key;
+        std::memcpy(key.bits, &vertices[v * strideFloats], sizeof(key.bits));
+        std::pair<std::unordered_map<PositionKey, unsigned int, PositionHash>::iterator, bool> inserted =
+            firstAt.emplace(key, (unsigned int)v);
+        positionOf[v] = inserted.first->second;
+        if (!inserted.second) locked[positionOf[v]] = 1;   // szew
+        glm::vec3 p = positionAt((unsigned int)v);
+        boundsMin = v == 0 ? p : glm::min(boundsMin, p);
+        boundsMax = v == 0 ? p : glm::max(boundsMax, p);
+    }
+
+    // Brzegi: krawedz uzyta przez jeden trojkat (albo wiecej niz dwa)
+    std::unordered_map<uint64_t, int> edgeUse;
+    edgeUse.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = positionOf[indices[i + e]], b = positionOf[indices[i + (e + 1) % 3]];
+            ++edgeUse[((uint64_t)std::min(a, b) << 32) | std::max(a, b)];
+        }
+    }
+    for (const std::pair<const uint64_t, int>& edge : edgeUse) {
+        if (edge.second != 2) {
+            locked[edge.first >> 32] = 1;
+            locked[edge.first & 0xffffffffu] = 1;
+        }
+    }
+
+    // Kwadryki plaszczyzn trojkatow wazone polem
+    std::vector<Quadric> quadrics(vertexCount, Quadric());
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        glm::vec3 p0 = positionAt(indices[i]), p1 = positionAt(indices[i + 1]), p2 = positionAt(indices[i + 2]);
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        if (length == 0.0f) continue;
+        normal /= length;
+        Quadric q = planeQuadric(normal, -glm::dot(normal, p0), 0.5 * length);
+        for (int k = 0; k < 3; ++k) addQuadric(quadrics[positionOf[indices[i + k]]], q);
+    }
+
+    double scale = std::max((double)glm::length(boundsMax - boundsMin), 1e-12);
+    double errorLimit = (double)targetError * targetError * scale * scale;
+    double maxError = 0.0;
+
+    std::vector<unsigned int> result = indices;
+    struct Collapse {
+        unsigned int from, to;   // wierzcholki (to - konkretna kopia na szwie)
+        double cost;
+    };
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<unsigned char> touched(vertexCount);
+    std::vector<unsigned int> triangleStart(vertexCount + 1), triangleList;
+
+    while (result.size() > targetIndexCount) {
+        // Trojkaty wokol kazdej pozycji (CSR)
+        std::fill(triangleStart.begin(), triangleStart.end(), 0);
+        for (unsigned int v : result) ++triangleStart[positionOf[v] + 1];
+        for (size_t v = 0; v < vertexCount; ++v) triangleStart[v + 1] += triangleStart[v];
+        triangleList.resize(result.size());
+        std::vector<unsigned int> fill(triangleStart.begin(), triangleStart.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i) triangleList[fill[positionOf[result[i]]]++] = (unsigned int)(i / 3);
+
+        // Kandydaci: kazda krawedz w tanszym z dozwolonych kierunkow
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = result[i + e], b = result[i + (e + 1) % 3];
+                unsigned int pa = positionOf[a], pb = positionOf[b];
+                Collapse best = {0, 0, -1.0};
+                for (int dir = 0; dir < 2; ++dir) {
+                    unsigned int from = dir ? b : a, to = dir ? a : b;
+                    unsigned int pf = dir ? pb : pa, pt = dir ? pa : pb;
+                    if (locked[pf]) continue;
+                    Quadric q = quadrics[pf];
+                    addQuadric(q, quadrics[pt]);
+                    double cost = quadricError(q, positionAt(pt));
+                    if (best.cost < 0.0 || cost < best.cost) best = {from, to, cost};
+                }
+                if (best.cost >= 0.0 && best.cost <= errorLimit) collapses.push_back(best);
+            }
+        }
+        if (collapses.empty()) break;
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        for (size_t v = 0; v < vertexCount; ++v) remap[v] = (unsigned int)v;
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t remainingIndices = result.size();
+        size_t applied = 0;
+
+        for (const Collapse& collapse : collapses) {
+            if (remainingIndices <= targetIndexCount) break;
+            unsigned int pf = positionOf[collapse.from], pt = positionOf[collapse.to];
+            if (touched[pf] || touched[pt]) continue;
+
+            // Odrzucenie, gdy ktorys trojkat odwrocilby sie po przesunieciu
+            glm::vec3 target = positionAt(pt);
+            bool flips = false;
+            size_t degenerate = 0;
+            for (unsigned int t = triangleStart[pf]; t < triangleStart[pf + 1] && !flips; ++t) {
+                const unsigned int* tri = &result[triangleList[t] * 3];
+                unsigned int p[3] = {positionOf[tri[0]], positionOf[tri[1]], positionOf[tri[2]]};
+                if (p[0] == pt || p[1] == pt || p[2] == pt) {
+                    ++degenerate;
+                    continue;
+                }
+                glm::vec3 before[3], after[3];
+                for (int k = 0; k < 3; ++k) {
+                    before[k] = positionAt(p[k]);
+                    after[k] = p[k] == pf ? target : before[k];
+                }
+                glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+                flips = glm::dot(n0, n1) <= 0.0f;
+            }
+            if (flips) continue;
+
+            // Przesuniecie: kopie wierzcholka pf (bez szwu jest jedna) na wskazana kopie pt
+            for (unsigned int t = triangleStart[pf]; t < triangleStart[pf + 1]; ++t) {
+                const unsigned int* tri = &result[triangleList[t] * 3];
+                for (int k = 0; k < 3; ++k) {
+                    touched[positionOf[tri[k]]] = 1;
+                    if (positionOf[tri[k]] == pf) remap[tri[k]] = collapse.to;
+                }
+            }
+            addQuadric(quadrics[pt], quadrics[pf]);
+            maxError = std::max(maxError, collapse.cost);
+            remainingIndices -= std::min(remainingIndices, degenerate * 3);
+            ++applied;
+        }
+        if (applied == 0) break;
+
+        // Nowe indeksy bez zdegenerowanych trojkatow
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            unsigned int pa = positionOf[a], pb = positionOf[b], pc = positionOf[c];
+            if (pa == pb || pb == pc || pa == pc) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (resultError) *resultError = (float)(std::sqrt(maxError) / scale);
+    return result;
+}
@@ -0,0 +1,576 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gpu_geometry.h"
+#include "lod.h"
+#include "mapped_file.h"
+#include "mesh.h"
+#include "shader_cache.h"
+
+// ============== IMPORT MODELI OBJ ==============
+// Plik mapowany w pamieci i dzielony na kawalki (granice na koncach linii)
+// parsowane rownolegle w dwoch przebiegach:
+//   1. zliczenie v/vt/vn w kazdym kawalku -> globalne offsety (sumy prefiksowe),
+//   2. parsowanie prosto do wspolnych tablic pod te offsety; indeksy scian
+//      (tez ujemne/wzgledne) rozwiazywane od razu na globalne.
+// Naroza scian (v/vt/vn) sa deduplikowane mapa haszujaca do ukladu 8 floatow
+// (pozycja, normalna, UV) uzywanego przez generatory, a dalej idzie zwykla
+// sciezka packMesh (optymalizacja indeksow + kompaktowy format). Poziomy LOD
+// 1.. powstaja z uproszczenia (generateLodIndices).
+//
+// Wynik trafia do cache siatek (mesh_cache/): gotowe bufory w formacie GPU,
+// wszystkie poziomy LOD w jednym pliku. Kolejne uruchomienie mapuje plik i
+// wysyla kazdy poziom jednym przydzialem w puli, bez parsowania i upraszczania.
+// Klucz: sciezka, rozmiar i czas modyfikacji zrodla + uklad wierzcholkow, wiec
+// zmiana modelu albo --vertex-format daje nowy plik.
+
+// ---------- parsowanie liczb (bez locale, bez kopiowania linii) ----------
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+inline float parseObjFloat(const char*& p, const char* end) {
+    p = skipBlanks(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+    double value = 0.0;
+    while (p < end && *p >= '0' && *p <= '9') value = value * 10.0 + (*p++ - '0');
+    if (p < end && *p == '.') {
+        ++p;
+        double fraction = 0.0, divisor = 1.0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            fraction = fraction * 10.0 + (*p++ - '0');
+            divisor *= 10.0;
+        }
+        value += fraction / divisor;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) negativeExponent = (*p++ == '-');
+        int exponent = 0;
+        while (p < end && *p >= '0' && *p <= '9') exponent = exponent * 10 + (*p++ - '0');
+        value *= std::pow(10.0, negativeExponent ? -exponent : exponent);
+    }
+    return (float)(negative ? -value : value);
+}
+
+// Zwraca false gdy nie ma liczby (np. puste pole w "1//3")
+inline bool parseObjInt(const char*& p, const char* end, long& value) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+    if (p >= end || *p < '0' || *p > '9') return false;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+    if (negative) value = -value;
+    return true;
+}
+
+// Naroze sciany: globalne indeksy od 0, -1 = brak
+struct ObjCorner {
+    int position, uv, normal;
+
+    bool operator==(const ObjCorner& other) const {
+        return position == other.position && uv == other.uv && normal == other.normal;
+    }
+};
+
+struct ObjCornerHash {
+    size_t operator()(const ObjCorner& corner) const {
+        uint64_t hash = (uint64_t)(uint32_t)corner.position * 0x9E3779B97F4A7C15ull;
+        hash ^= (uint64_t)(uint32_t)corner.uv * 0xC2B2AE3D27D4EB4Full + (hash << 6) + (hash >> 2);
+        hash ^= (uint64_t)(uint32_t)corner.normal * 0x165667B19E3779F9ull + (hash << 6) + (hash >> 2);
+        return (size_t)hash;
+    }
+};
+
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+    size_t positionCount, uvCount, normalCount;   // przebieg 1
+    size_t positionBase, uvBase, normalBase;      // sumy prefiksowe
+    std::vector<ObjCorner> corners;               // trojkaty, po 3
+    bool valid;
+    const char* error;                            // przyczyna valid == false
+};
+
+// Typ linii po pierwszym tokenie: 'v', 't' (vt), 'n' (vn), 'f', 0 - inne
+inline char objLineType(const char* p, const char* end) {
+    p = skipBlanks(p, end);
+    if (end - p < 2) return 0;
+    if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) return 'f';
+    if (p[0] != 'v') return 0;
+    if (p[1] == ' ' || p[1] == '\t') return 'v';
+    if (end - p < 3 || (p[2] != ' ' && p[2] != '\t')) return 0;
+    if (p[1] == 't') return 't';
+    if (p[1] == 'n') return 'n';
+    return 0;
+}
+
+inline const char* objLineEnd(const char* p, const char* end) {
+    const char* newline = (const char*)std::memchr(p, '\n', end - p);
+    return newline ? newline : end;
+}
+
+inline void countObjChunk(ObjChunk& chunk) {
+    chunk.positionCount = chunk.uvCount = chunk.normalCount = 0;
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* lineEnd = objLineEnd(line, chunk.end);
+        switch (objLineType(line, lineEnd)) {
+            case 'v': ++chunk.positionCount; break;
+            case 't': ++chunk.uvCount; break;
+            case 'n': ++chunk.normalCount; break;
+            default: break;
+        }
+        line = lineEnd + 1;
+    }
+}
+
+// Indeks narozy bez wartosci (-1 - brak uv/normalnej) i indeks bledny
+const int OBJ_INDEX_INVALID = -2;
+
+// OBJ: indeks > 0 od poczatku pliku (od 1), < 0 wzgledem liczby wczytanych dotad
+// elementow; 0 i indeks wzgledny sprzed pierwszego elementu sa bledne
+inline int resolveObjIndex(long index, size_t countSoFar) {
+    if (index > 0) return (int)(index - 1);
+    if (index < 0 && index >= -(long)countSoFar) return (int)((long)countSoFar + index);
+    return OBJ_INDEX_INVALID;
+}
+
+inline void parseObjChunk(ObjChunk& chunk, std::vector<glm::vec3>& positions, std::vector<glm::vec2>& uvs,
+                          std::vector<glm::vec3>& normals) {
+    size_t position = chunk.positionBase, uv = chunk.uvBase, normal = chunk.normalBase;
+    std::vector<ObjCorner> polygon;
+    chunk.valid = true;
+    chunk.error = NULL;
+
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* lineEnd = objLineEnd(line, chunk.end);
+        char type = objLineType(line, lineEnd);
+        const char* p = skipBlanks(line, lineEnd) + (type == 't' || type == 'n' ? 2 : 1);
+
+        if (type == 'v') {
+            float x = parseObjFloat(p, lineEnd);
+            float y = parseObjFloat(p, lineEnd);
+            float z = parseObjFloat(p, lineEnd);
+            positions[position++] = glm::vec3(x, y, z);
+        } else if (type == 't') {
+            float u = parseObjFloat(p, lineEnd);
+            float v = parseObjFloat(p, lineEnd);
+            uvs[uv++] = glm::vec2(u, v);
+        } else if (type == 'n') {
+            float x = parseObjFloat(p, lineEnd);
+            float y = parseObjFloat(p, lineEnd);
+            float z = parseObjFloat(p, lineEnd);
+            normals[normal++] = glm::vec3(x, y, z);
+        } else if (type == 'f') {
+            polygon.clear();
+            while (true) {
+                p = skipBlanks(p, lineEnd);
+                long value;
+                if (!parseObjInt(p, lineEnd, value)) break;
+                ObjCorner corner = {resolveObjIndex(value, position), -1, -1};
+                if (p < lineEnd && *p == '/') {
+                    ++p;
+                    if (parseObjInt(p, lineEnd, value)) corner.uv = resolveObjIndex(value, uv);
+                    if (p < lineEnd && *p == '/') {
+                        ++p;
+                        if (parseObjInt(p, lineEnd, value)) corner.normal = resolveObjIndex(value, normal);
+                    }
+                }
+                polygon.push_back(corner);
+            }
+            for (const ObjCorner& corner : polygon) {
+                if (corner.position == OBJ_INDEX_INVALID || corner.uv == OBJ_INDEX_INVALID ||
+                    corner.normal == OBJ_INDEX_INVALID) {
+                    chunk.valid = false;
+                    chunk.error = "OBJ: indeks poza zakresem";
+                }
+            }
+            if (polygon.size() < 3) {
+                chunk.valid = false;
+                chunk.error = "OBJ: sciana z mniej niz 3 wierzcholkami";
+            }
+            // Wielokaty wypukle - wachlarz trojkatow
+            for (size_t i = 2; i < polygon.size(); ++i) {
+                chunk.corners.push_back(polygon[0]);
+                chunk.corners.push_back(polygon[i - 1]);
+                chunk.corners.push_back(polygon[i]);
+            }
+        }
+        line = lineEnd + 1;
+    }
+}
+
+// Parsuje OBJ do wierzcholkow 8-floatowych i indeksow (wszystkie obiekty/grupy
+// jako jedna siatka, materialy pomijane). Brakujace normalne sa wygladzane
+// z normalnych scian, brakujace UV = 0.
+inline bool parseObj(const char* data, size_t size, std::vector<float>& vertices,
+                     std::vector<unsigned int>& indices, unsigned int threadCount = 0) {
+    const size_t MIN_CHUNK_BYTES = 1 << 20;
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, size / MIN_CHUNK_BYTES));
+
+    // Granice kawalkow przesuniete za najblizszy koniec linii
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* end = data + size;
+    const char* begin = data;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* chunkEnd = (i + 1 == chunkCount) ? end : data + size * (i + 1) / chunkCount;
+        if (chunkEnd < begin) chunkEnd = begin;
+        if (chunkEnd < end) chunkEnd = objLineEnd(chunkEnd, end);
+        chunks[i].begin = begin;
+        chunks[i].end = chunkEnd;
+        begin = std::min(chunkEnd + 1, end);
+    }
+
+    auto runParallel = [&chunks](auto&& work) {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < chunks.size(); ++i) workers.emplace_back([&work, &chunks, i]() { work(chunks[i]); });
+        work(chunks[0]);
+        for (std::thread& worker : workers) worker.join();
+    };
+
+    runParallel([](ObjChunk& chunk) { countObjChunk(chunk); });
+
+    size_t positionCount = 0, uvCount = 0, normalCount = 0;
+    for (ObjChunk& chunk : chunks) {
+        chunk.positionBase = positionCount;
+        chunk.uvBase = uvCount;
+        chunk.normalBase = normalCount;
+        positionCount += chunk.positionCount;
+        uvCount += chunk.uvCount;
+        normalCount += chunk.normalCount;
+    }
+
+    std::vector<glm::vec3> positions(positionCount), normals(normalCount);
+    std::vector<glm::vec2> uvs(uvCount);
+    runParallel([&](ObjChunk& chunk) { parseObjChunk(chunk, positions, uvs, normals); });
+
+    // Deduplikacja narozy i walidacja indeksow
+    size_t cornerCount = 0;
+    for (const ObjChunk& chunk : chunks) {
+        if (!chunk.valid) {
+            std::cerr << chunk.error << std::endl;
+            return false;
+        }
+        cornerCount += chunk.corners.size();
+    }
+    if (cornerCount == 0) {
+        std::cerr << "OBJ: brak scian" << std::endl;
+        return false;
+    }
+
+    std::unordered_map<ObjCorner, unsigned int, ObjCornerHash> vertexOf;
+    vertexOf.reserve(cornerCount);
+    std::vector<ObjCorner> unique;
+    indices.clear();
+    indices.reserve(cornerCount);
+    bool missingNormals = false;
+    for (const ObjChunk& chunk : chunks) {
+        for (const ObjCorner& corner : chunk.corners) {
+            if (corner.position < 0 || corner.position >= (int)positionCount || corner.uv >= (int)uvCount ||
+                corner.normal >= (int)normalCount || (corner.uv < -1) || (corner.normal < -1)) {
+                std::cerr << "OBJ: indeks poza zakresem" << std::endl;
+                return false;
+            }
+            std::pair<std::unordered_map<ObjCorner, unsigned int, ObjCornerHash>::iterator, bool> inserted =
+                vertexOf.emplace(corner, (unsigned int)unique.size());
+            if (inserted.second) {
+                unique.push_back(corner);
+                if (corner.normal < 0) missingNormals = true;
+            }
+            indices.push_back(inserted.first->second);
+        }
+    }
+
+    // Normalne wygladzone: suma normalnych scian (wazona polem) na pozycje
+    std::vector<glm::vec3> smoothNormals;
+    if (missingNormals) {
+        smoothNormals.assign(positionCount, glm::vec3(0.0f));
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            int a = unique[indices[i]].position, b = unique[indices[i + 1]].position,
+                c = unique[indices[i + 2]].position;
+            glm::vec3 faceNormal = glm::cross(positions[b] - positions[a], positions[c] - positions[a]);
+            smoothNormals[a] += faceNormal;
+            smoothNormals[b] += faceNormal;
+            smoothNormals[c] += faceNormal;
+        }
+    }
+
+    vertices.resize(unique.size() * SOURCE_VERTEX_FLOATS);
+    for (size_t i = 0; i < unique.size(); ++i) {
+        const ObjCorner& corner = unique[i];
+        glm::vec3 normal(0.0f, 1.0f, 0.0f);
+        if (corner.normal >= 0) {
+            normal = normals[corner.normal];
+        } else if (glm::length(smoothNormals[corner.position]) > 0.0f) {
+            normal = glm::normalize(smoothNormals[corner.position]);
+        }
+        glm::vec2 uv = corner.uv >= 0 ? uvs[corner.uv] : glm::vec2(0.0f);
+        float* vertex = &vertices[i * SOURCE_VERTEX_FLOATS];
+        const glm::vec3& position = positions[corner.position];
+        vertex[0] = position.x;
+        vertex[1] = position.y;
+        vertex[2] = position.z;
+        vertex[3] = normal.x;
+        vertex[4] = normal.y;
+        vertex[5] = normal.z;
+        vertex[6] = uv.x;
+        vertex[7] = uv.y;
+    }
+    return true;
+}
+
+// ============== CACHE PRZETWORZONYCH SIATEK ==============
+// Plik: FileHeader, LevelHeader x levelCount, potem dane kolejnych poziomow
+// (wierzcholki, indeksy).
+class CookedMeshCache {
+public:
+    explicit CookedMeshCache(const std::string& directory = "mesh_cache") : directory(directory), enabled(true) {}
+
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled; }
+
+    // FNV-1a (64 bit) z identyfikacji zrodla i ukladu wierzcholkow
+    uint64_t makeKey(const std::string& sourcePath, const VertexLayout& layout) const {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= ((const unsigned char*)data)[i];
+                hash *= 1099511628211ull;
+            }
+        };
+        std::error_code ec;
+        std::string path = std::filesystem::absolute(sourcePath, ec).string();
+        uint64_t fileSize = (uint64_t)std::filesystem::file_size(sourcePath, ec);
+        int64_t modified = (int64_t)std::filesystem::last_write_time(sourcePath, ec).time_since_epoch().count();
+        int layoutFields[] = {(int)layout.normals, (int)layout.uvs, (int)layout.shortIndices,
+                              (int)layout.optimizeIndices};
+        mix(path.data(), path.size());
+        mix(&fileSize, sizeof(fileSize));
+        mix(&modified, sizeof(modified));
+        mix(layoutFields, sizeof(layoutFields));
+        return hash;
+    }
+
+    // Mapuje plik i wysyla poziomy do puli prosto z mapowania. Uszkodzony lub
+    // niepasujacy plik jest usuwany.
+    bool load(uint64_t key, GeometryPool& pool, size_t stride, const char* name, LodChain& lods) {
+        if (!enabled) return false;
+        std::string path = pathFor(key);
+        MappedFile file;
+        if (!file.open(path)) return false;
+
+        FileHeader header;
+        std::vector<LevelHeader> levels;
+        bool valid = file.size() >= sizeof(header);
+        if (valid) {
+            std::memcpy(&header, file.data(), sizeof(header));
+            valid = header.magic == MAGIC && header.version == VERSION && header.key == key &&
+                    header.vertexStride == stride && header.levelCount >= 1 &&
+                    header.levelCount <= (uint32_t)MAX_LOD_LEVELS &&
+                    file.size() >= sizeof(header) + header.levelCount * sizeof(LevelHeader);
+        }
+        uint64_t expectedSize = sizeof(header) + (valid ? header.levelCount * sizeof(LevelHeader) : 0);
+        if (valid) {
+            levels.resize(header.levelCount);
+            std::memcpy(levels.data(), file.data() + sizeof(header), levels.size() * sizeof(LevelHeader));
+            for (const LevelHeader& level : levels) {
+                valid = valid && level.vertexBytes == (uint64_t)level.vertexCount * header.vertexStride &&
+                        level.indexBytes == (uint64_t)level.indexCount * indexSize(level.indexType);
+                expectedSize += level.vertexBytes + level.indexBytes;
+            }
+            valid = valid && file.size() == expectedSize;
+        }
+        if (!valid) {
+            file.close();
+            std::cerr << "Cache siatek: odrzucono " << path << std::endl;
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return false;
+        }
+
+        const char* payload = file.data() + sizeof(header) + levels.size() * sizeof(LevelHeader);
+        for (const LevelHeader& level : levels) {
+            AABB bounds;
+            bounds.min = glm::vec3(level.boundsMin[0], level.boundsMin[1], level.boundsMin[2]);
+            bounds.max = glm::vec3(level.boundsMax[0], level.boundsMax[1], level.boundsMax[2]);
+            lods.add(uploadPackedMesh(pool, payload, level.vertexCount, payload + level.vertexBytes,
+                                      level.indexCount, level.indexType, bounds, name));
+            payload += level.vertexBytes + level.indexBytes;
+        }
+        if (!lods.valid()) {
+            lods.release();
+            return false;
+        }
+        return true;
+    }
+
+    // Zapis przez wlasny plik tymczasowy + rename (jak w ProgramBinaryCache)
+    bool store(uint64_t key, const std::vector<PackedMesh>& meshes, size_t stride) {
+        if (!enabled || meshes.empty()) return false;
+
+        FileHeader header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.key = key;
+        header.levelCount = (uint32_t)meshes.size();
+        header.vertexStride = (uint32_t)stride;
+
+        std::vector<LevelHeader> levels(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            const PackedMesh& mesh = meshes[i];
+            LevelHeader& level = levels[i];
+            level.vertexCount = (uint32_t)mesh.vertexCount;
+            level.indexCount = (uint32_t)mesh.indexCount;
+            level.indexType = mesh.indexType;
+            level.reserved = 0;
+            for (int k = 0; k < 3; ++k) {
+                level.boundsMin[k] = mesh.bounds.min[k];
+                level.boundsMax[k] = mesh.bounds.max[k];
+            }
+            level.vertexBytes = mesh.vertices.size();
+            level.indexBytes = mesh.indices.size();
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) return false;
+
+        std::string path = pathFor(key);
+        std::string tmpPath = cacheTempPath(path);
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(LevelHeader));
+            for (const PackedMesh& mesh : meshes) {
+                file.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size());
+                file.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size());
+            }
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(tmpPath, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const uint32_t MAGIC = 0x434d4b47; // "GKMC"
+    static const uint32_t VERSION = 2;        // 2 - poziomy LOD
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t levelCount;
+        uint32_t vertexStride;
+    };
+
+    struct LevelHeader {
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t indexType;
+        uint32_t reserved;
+        float boundsMin[3];
+        float boundsMax[3];
+        uint64_t vertexBytes;
+        uint64_t indexBytes;
+    };
+
+    std::string pathFor(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.mesh", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+
+    std::string directory;
+    bool enabled;
+};
+
+// Wspolny cache siatek (jak shaderBinaryCache)
+inline CookedMeshCache& cookedMeshCache() {
+    static CookedMeshCache cache;
+    return cache;
+}
+
+// Model z pliku OBJ z poziomami LOD: z cache siatek albo parsowanie,
+// upraszczanie i zapis do cache. Pusty lancuch przy bledzie.
+inline LodChain loadObjModel(GeometryPool& pool, const std::string& path) {
+    std::string name = std::filesystem::path(path).filename().string();
+    size_t stride = vertexStride(vertexLayout);
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    CookedMeshCache& cache = cookedMeshCache();
+    uint64_t key = cache.makeKey(path, vertexLayout);
+    LodChain lods;
+    if (cache.load(key, pool, stride, name.c_str(), lods)) {
+        std::cout << "Model " << name << ": z cache (" << lods.count() << " poziomow LOD, " << elapsedMs()
+                  << " ms)" << std::endl;
+        return lods;
+    }
+
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Nie mozna otworzyc modelu: " << path << std::endl;
+        return lods;
+    }
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    if (!parseObj(file.data(), file.size(), vertices, indices)) {
+        std::cerr << "Blad wczytywania modelu: " << path << std::endl;
+        return lods;
+    }
+    file.close();
+    double parseMs = elapsedMs();
+
+    // Poziomy z oryginalnych wierzcholkow; packMesh odrzuca nieuzywane
+    std::vector<std::vector<unsigned int>> levelIndices = generateLodIndices(vertices, indices);
+    levelIndices.insert(levelIndices.begin(), std::move(indices));
+    std::vector<PackedMesh> packed;
+    for (size_t level = 0; level < levelIndices.size(); ++level) {
+        std::vector<float> levelVertices = vertices;
+        std::string levelName = name + " LOD" + std::to_string(level);
+        packed.push_back(packMesh(levelVertices, levelIndices[level], levelName.c_str()));
+    }
+    cache.store(key, packed, stride);
+    std::cout << "Model " << name << ": parsowanie " << parseMs << " ms, razem " << elapsedMs() << " ms"
+              << std::endl;
+
+    for (const PackedMesh& mesh : packed) {
+        lods.add(uploadPackedMesh(pool, mesh.vertices.data(), mesh.vertexCount, mesh.indices.data(),
+                                  mesh.indexCount, mesh.indexType, mesh.bounds, name.c_str()));
+    }
+    if (!lods.valid()) lods.release();
+    return lods;
+}
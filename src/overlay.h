@@ -0,0 +1,234 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "gl_state.h"
+#include "shader.h"
+
+// ============== NAKLADKA TEKSTOWA (OVERLAY) ==============
+// Tekst i prostokaty w pikselach ekranu (0,0 = lewy gorny rog), skladane
+// w jeden bufor i rysowane jednym wywolaniem. Czcionka 3x5 wbudowana
+// w kod - bez zewnetrznych plikow i bibliotek.
+
+struct OverlayGlyph {
+    char character;
+    unsigned char rows[5]; // 3 bity na wiersz, najstarszy bit = lewa kolumna
+};
+
+// Komorka 0 atlasu jest pelna - sluzy do rysowania prostokatow
+const OverlayGlyph OVERLAY_FONT[] = {
+    {'\x01', {0b111, 0b111, 0b111, 0b111, 0b111}},
+    {' ', {0b000, 0b000, 0b000, 0b000, 0b000}},
+    {'0', {0b111, 0b101, 0b101, 0b101, 0b111}},
+    {'1', {0b010, 0b110, 0b010, 0b010, 0b111}},
+    {'2', {0b111, 0b001, 0b111, 0b100, 0b111}},
+    {'3', {0b111, 0b001, 0b111, 0b001, 0b111}},
+    {'4', {0b101, 0b101, 0b111, 0b001, 0b001}},
+    {'5', {0b111, 0b100, 0b111, 0b001, 0b111}},
+    {'6', {0b111, 0b100, 0b111, 0b101, 0b111}},
+    {'7', {0b111, 0b001, 0b010, 0b010, 0b010}},
+    {'8', {0b111, 0b101, 0b111, 0b101, 0b111}},
+    {'9', {0b111, 0b101, 0b111, 0b001, 0b111}},
+    {'A', {0b010, 0b101, 0b111, 0b101, 0b101}},
+    {'B', {0b110, 0b101, 0b110, 0b101, 0b110}},
+    {'C', {0b011, 0b100, 0b100, 0b100, 0b011}},
+    {'D', {0b110, 0b101, 0b101, 0b101, 0b110}},
+    {'E', {0b111, 0b100, 0b110, 0b100, 0b111}},
+    {'F', {0b111, 0b100, 0b110, 0b100, 0b100}},
+    {'G', {0b011, 0b100, 0b101, 0b101, 0b011}},
+    {'H', {0b101, 0b101, 0b111, 0b101, 0b101}},
+    {'I', {0b111, 0b010, 0b010, 0b010, 0b111}},
+    {'J', {0b001, 0b001, 0b001, 0b101, 0b010}},
+    {'K', {0b101, 0b101, 0b110, 0b101, 0b101}},
+    {'L', {0b100, 0b100, 0b100, 0b100, 0b111}},
+    {'M', {0b101, 0b111, 0b111, 0b101, 0b101}},
+    {'N', {0b110, 0b101, 0b101, 0b101, 0b101}},
+    {'O', {0b010, 0b101, 0b101, 0b101, 0b010}},
+    {'P', {0b110, 0b101, 0b110, 0b100, 0b100}},
+    {'Q', {0b010, 0b101, 0b101, 0b110, 0b011}},
+    {'R', {0b110, 0b101, 0b110, 0b101, 0b101}},
+    {'S', {0b011, 0b100, 0b010, 0b001, 0b110}},
+    {'T', {0b111, 0b010, 0b010, 0b010, 0b010}},
+    {'U', {0b101, 0b101, 0b101, 0b101, 0b111}},
+    {'V', {0b101, 0b101, 0b101, 0b101, 0b010}},
+    {'W', {0b101, 0b101, 0b111, 0b111, 0b101}},
+    {'X', {0b101, 0b101, 0b010, 0b101, 0b101}},
+    {'Y', {0b101, 0b101, 0b010, 0b010, 0b010}},
+    {'Z', {0b111, 0b001, 0b010, 0b100, 0b111}},
+    {'.', {0b000, 0b000, 0b000, 0b000, 0b010}},
+    {',', {0b000, 0b000, 0b000, 0b010, 0b100}},
+    {':', {0b000, 0b010, 0b000, 0b010, 0b000}},
+    {'-', {0b000, 0b000, 0b111, 0b000, 0b000}},
+    {'+', {0b000, 0b010, 0b111, 0b010, 0b000}},
+    {'=', {0b000, 0b111, 0b000, 0b111, 0b000}},
+    {'_', {0b000, 0b000, 0b000, 0b000, 0b111}},
+    {'/', {0b001, 0b001, 0b010, 0b100, 0b100}},
+    {'%', {0b101, 0b001, 0b010, 0b100, 0b101}},
+    {'(', {0b001, 0b010, 0b010, 0b010, 0b001}},
+    {')', {0b100, 0b010, 0b010, 0b010, 0b100}},
+    {'[', {0b011, 0b010, 0b010, 0b010, 0b011}},
+    {']', {0b110, 0b010, 0b010, 0b010, 0b110}},
+    {'<', {0b001, 0b010, 0b100, 0b010, 0b001}},
+    {'>', {0b100, 0b010, 0b001, 0b010, 0b100}},
+    {'!', {0b010, 0b010, 0b010, 0b000, 0b010}},
+    {'?', {0b111, 0b001, 0b010, 0b000, 0b010}},
+    {'|', {0b010, 0b010, 0b010, 0b010, 0b010}},
+    {'#', {0b101, 0b111, 0b101, 0b111, 0b101}},
+    {'*', {0b000, 0b101, 0b010, 0b101, 0b000}},
+};
+
+class TextOverlay {
+public:
+    TextOverlay() : VAO(0), VBO(0), fontTexture(0), atlasWidth(1), screenWidth(1), screenHeight(1) {
+        for (int& cell : glyphCell) cell = 1; // Nieznane znaki jako spacja
+    }
+
+    bool init() {
+        if (!shader.loadFromFiles("shaders/overlay_vertex.glsl", "shaders/overlay_fragment.glsl")) {
+            return false;
+        }
+        shader.use();
+        shader.setInt("fontAtlas", 0);
+
+        // Atlas: komorki 4x6 tekseli (glif 3x5 + odstep) w jednym wierszu
+        const int glyphCount = sizeof(OVERLAY_FONT) / sizeof(OVERLAY_FONT[0]);
+        atlasWidth = glyphCount * CELL_W;
+        std::vector<unsigned char> pixels(atlasWidth * CELL_H, 0);
+        for (int g = 0; g < glyphCount; ++g) {
+            const OverlayGlyph& glyph = OVERLAY_FONT[g];
+            glyphCell[(unsigned char)glyph.character] = g;
+            for (int row = 0; row < 5; ++row) {
+                for (int col = 0; col < 3; ++col) {
+                    if (glyph.rows[row] & (4 >> col)) {
+                        pixels[row * atlasWidth + g * CELL_W + col] = 255;
+                    }
+                }
+            }
+        }
+
+        glGenTextures(1, &fontTexture);
+        glBindTexture(GL_TEXTURE_2D, fontTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, CELL_H, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // Pozycja (piksele), UV, kolor RGBA
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(4 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        bindVertexArray(0);
+
+        return true;
+    }
+
+    // Rozpoczyna nowa klatke nakladki dla biezacego viewportu
+    void begin() {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        screenWidth = viewport[2];
+        screenHeight = viewport[3];
+        vertices.clear();
+    }
+
+    // Wysokosc linii tekstu w pikselach dla danej skali
+    static float lineHeight(float scale) { return (CELL_H + 1) * scale; }
+
+    void addRect(float x, float y, float w, float h, const glm::vec4& color) {
+        // Srodek pelnej komorki 0 - probkowanie zawsze daje 1.0
+        float u = 1.5f / atlasWidth, v = 2.5f / CELL_H;
+        addQuad(x, y, x + w, y + h, u, v, u, v, color);
+    }
+
+    void addText(float x, float y, const std::string& text, const glm::vec4& color, float scale = 2.0f) {
+        float cursor = x;
+        for (char c : text) {
+            if (c == '\n') {
+                cursor = x;
+                y += lineHeight(scale);
+                continue;
+            }
+            int cell = glyphCell[(unsigned char)std::toupper((unsigned char)c)];
+            float u0 = (float)(cell * CELL_W) / atlasWidth;
+            float u1 = (float)(cell * CELL_W + 3) / atlasWidth;
+            float v0 = 0.0f;
+            float v1 = 5.0f / CELL_H;
+            addQuad(cursor, y, cursor + 3 * scale, y + 5 * scale, u0, v0, u1, v1, color);
+            cursor += CELL_W * scale;
+        }
+    }
+
+    // Rysuje wszystko jednym glDrawArrays; przywraca test glebokosci i blending
+    void draw() {
+        if (vertices.empty()) return;
+
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        bool cullFace = cullFaceEnabled;
+        glDisable(GL_DEPTH_TEST);
+        setCullFace(false);
+        setBlend(true);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        shader.use();
+        shader.setVec2("screenSize", glm::vec2((float)screenWidth, (float)screenHeight));
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, fontTexture);
+
+        bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // Osierocenie bufora - sterownik nie czeka na poprzednia klatke
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(float), vertices.data());
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(vertices.size() / 8));
+        countDrawCall();
+        bindVertexArray(0);
+
+        setBlend(false);
+        if (depthTest) glEnable(GL_DEPTH_TEST);
+        setCullFace(cullFace);
+    }
+
+    void destroy() {
+        deleteVertexArray(VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &fontTexture);
+        deleteProgram(shader.ID);
+    }
+
+private:
+    static const int CELL_W = 4;
+    static const int CELL_H = 6;
+
+    void addQuad(float x0, float y0, float x1, float y1,
+                 float u0, float v0, float u1, float v1, const glm::vec4& c) {
+        const float quad[6][4] = {
+            {x0, y0, u0, v0}, {x1, y0, u1, v0}, {x1, y1, u1, v1},
+            {x1, y1, u1, v1}, {x0, y1, u0, v1}, {x0, y0, u0, v0},
+        };
+        for (const auto& v : quad) {
+            vertices.insert(vertices.end(), {v[0], v[1], v[2], v[3], c.r, c.g, c.b, c.a});
+        }
+    }
+
+    Shader shader;
+    unsigned int VAO, VBO, fontTexture;
+    int atlasWidth;
+    int glyphCell[256];
+    int screenWidth, screenHeight;
+    std::vector<float> vertices;
+};
@@ -0,0 +1,355 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ============== PROFILER KLATKI ==============
+// Nazwane zakresy CPU (zegar) i GPU (zapytania GL_TIME_ELAPSED) wokol
+// przebiegow renderowania oraz liczniki klatki. Wyniki GPU odczytywane sa
+// z opoznieniem PROFILER_LATENCY klatek, a gdy jeszcze nie sa gotowe -
+// klatka jest pomijana zamiast czekac na GPU.
+
+// Liczniki zerowane na poczatku kazdej klatki
+struct FrameCounters {
+    unsigned int drawCalls;
+    unsigned int stateChanges;   // program, VAO, glEnable/glDisable, bufory
+    unsigned int skippedStateChanges; // powtorzone ustawienia pominiete przez cache stanu
+    unsigned int uniformUploads; // glUniform* + wysylki do UBO
+    unsigned int tessTriangles;  // trojkaty z tessellation (GL_PRIMITIVES_GENERATED)
+    unsigned int transformUpdates; // wezly przeliczone w TransformStore
+    unsigned int visibleObjects;   // obiekty po frustum cullingu
+    unsigned int culledObjects;
+    unsigned int meshTriangles;    // trojkaty siatek wyslane do rysowania (po wyborze LOD)
+    unsigned int lights;           // swiatla w klastrach
+    unsigned int maxClusterLights; // najwiecej swiatel w jednym klastrze
+    unsigned int shadowStaticViews;  // widoki swiatel z przerysowana geometria statyczna
+    unsigned int shadowSampledViews; // widoki skopiowane i uzupelnione o obiekty ruchome
+    unsigned int shadedSamples;    // probki po tescie glebokosci (GL_SAMPLES_PASSED) - overdraw
+};
+
+// Globalne liczniki - inkrementowane w miejscach wywolan GL
+inline FrameCounters frameCounters = FrameCounters();
+
+inline void countDrawCall() { ++frameCounters.drawCalls; }
+inline void countStateChange(unsigned int n = 1) { frameCounters.stateChanges += n; }
+inline void countSkippedStateChange() { ++frameCounters.skippedStateChanges; }
+inline void countUniformUpload(unsigned int n = 1) { frameCounters.uniformUploads += n; }
+inline void countTriangles(unsigned int n) { frameCounters.meshTriangles += n; }
+
+// Flagi zakresu
+const unsigned int PROFILE_CPU = 0;
+const unsigned int PROFILE_GPU = 1;          // zapytanie GL_TIME_ELAPSED
+const unsigned int PROFILE_PRIMITIVES = 2;   // zapytanie GL_PRIMITIVES_GENERATED
+const unsigned int PROFILE_SAMPLES = 4;      // zapytanie GL_SAMPLES_PASSED
+
+const int PROFILER_LATENCY = 3;
+
+struct ProfileResult {
+    const char* name;
+    int depth;
+    double cpuMs;
+    double gpuMs;      // < 0 gdy zakres nie mial pomiaru GPU
+};
+
+class FrameProfiler {
+public:
+    // Wyniki ostatniej w pelni odczytanej klatki
+    std::vector<ProfileResult> results;
+    FrameCounters counters;
+    double frameCpuMs;
+    double frameGpuMs;
+
+    FrameProfiler() : frameCpuMs(0.0), frameGpuMs(0.0), frameNumber(0), activeGpuScope(-1),
+                      activePrimitivesScope(-1), activeSamplesScope(-1), gpuClockOffsetUs(0.0),
+                      captureFramesLeft(0), capturedFrames(0) {
+        counters = FrameCounters();
+    }
+
+    void init() {
+        epoch = std::chrono::steady_clock::now();
+        // Kalibracja zegara GPU do osi czasu CPU (tylko dla eksportu trace)
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuClockOffsetUs = nowUs() - gpuNow / 1000.0;
+    }
+
+    void beginFrame() {
+        Slot& slot = slots[frameNumber % PROFILER_LATENCY];
+        if (slot.pending) collect(slot);
+
+        slot.records.clear();
+        slot.usedTimeQueries = 0;
+        slot.usedPrimitiveQueries = 0;
+        slot.usedSampleQueries = 0;
+        slot.frameNumber = frameNumber;
+        slot.frameBeginUs = nowUs();
+        frameCounters = FrameCounters();
+        openScopes.clear();
+    }
+
+    void endFrame() {
+        Slot& slot = slots[frameNumber % PROFILER_LATENCY];
+        slot.frameEndUs = nowUs();
+        slot.counters = frameCounters;
+        slot.pending = true;
+        ++frameNumber;
+    }
+
+    int beginScope(const char* name, unsigned int flags = PROFILE_GPU) {
+        Slot& slot = slots[frameNumber % PROFILER_LATENCY];
+        Record record;
+        record.name = name;
+        record.depth = (int)openScopes.size();
+        record.cpuBeginUs = nowUs();
+        record.cpuEndUs = record.cpuBeginUs;
+        record.timeQuery = -1;
+        record.primitivesQuery = -1;
+        record.samplesQuery = -1;
+
+        // GL_TIME_ELAPSED nie moze sie zagniezdzac - zakres wewnetrzny mierzy tylko CPU,
+        // a pomiary wokol calej klatki (FrameTimer) uzywaja znacznikow GL_TIMESTAMP
+        if ((flags & PROFILE_GPU) && activeGpuScope < 0) {
+            record.timeQuery = acquire(slot.timeQueries, slot.usedTimeQueries, 2);
+            glQueryCounter(slot.timeQueries[record.timeQuery + 1], GL_TIMESTAMP);
+            glBeginQuery(GL_TIME_ELAPSED, slot.timeQueries[record.timeQuery]);
+            activeGpuScope = (int)slot.records.size();
+        }
+        if ((flags & PROFILE_PRIMITIVES) && activePrimitivesScope < 0) {
+            record.primitivesQuery = acquire(slot.primitiveQueries, slot.usedPrimitiveQueries, 1);
+            glBeginQuery(GL_PRIMITIVES_GENERATED, slot.primitiveQueries[record.primitivesQuery]);
+            activePrimitivesScope = (int)slot.records.size();
+        }
+        if ((flags & PROFILE_SAMPLES) && activeSamplesScope < 0) {
+            record.samplesQuery = acquire(slot.sampleQueries, slot.usedSampleQueries, 1);
+            glBeginQuery(GL_SAMPLES_PASSED, slot.sampleQueries[record.samplesQuery]);
+            activeSamplesScope = (int)slot.records.size();
+        }
+
+        slot.records.push_back(record);
+        openScopes.push_back((int)slot.records.size() - 1);
+        return openScopes.back();
+    }
+
+    void endScope(int scope) {
+        Slot& slot = slots[frameNumber % PROFILER_LATENCY];
+        Record& record = slot.records[scope];
+        if (activeGpuScope == scope) {
+            glEndQuery(GL_TIME_ELAPSED);
+            activeGpuScope = -1;
+        }
+        if (activePrimitivesScope == scope) {
+            glEndQuery(GL_PRIMITIVES_GENERATED);
+            activePrimitivesScope = -1;
+        }
+        if (activeSamplesScope == scope) {
+            glEndQuery(GL_SAMPLES_PASSED);
+            activeSamplesScope = -1;
+        }
+        record.cpuEndUs = nowUs();
+        if (!openScopes.empty()) openScopes.pop_back();
+    }
+
+    // Odbiera wyniki pozostalych klatek (po glFinish wszystkie sa gotowe)
+    void finish() {
+        for (int i = 0; i < PROFILER_LATENCY; ++i) {
+            Slot& slot = slots[(frameNumber + i) % PROFILER_LATENCY];
+            if (slot.pending) collect(slot);
+        }
+    }
+
+    // Nagrywanie kolejnych klatek do eksportu w formacie Chrome trace
+    void startCapture(int frames) {
+        traceEvents.clear();
+        capturedFrames = 0;
+        captureFramesLeft = frames;
+    }
+
+    bool isCapturing() const { return captureFramesLeft > 0; }
+    int capturedFrameCount() const { return capturedFrames; }
+
+    // Plik do otwarcia w chrome://tracing lub ui.perfetto.dev
+    bool writeTrace(const std::string& path) {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Nie mozna zapisac trace: " << path << std::endl;
+            return false;
+        }
+        file << "{\"traceEvents\": [\n";
+        file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"CPU\"}},\n";
+        file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"GPU\"}}";
+        for (const TraceEvent& e : traceEvents) {
+            file << ",\n{\"name\": \"" << e.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.track
+                 << ", \"ts\": " << (long long)e.beginUs << ", \"dur\": " << (long long)e.durationUs;
+            if (e.track == 1 && e.frame >= 0) file << ", \"args\": {\"frame\": " << e.frame << "}";
+            file << "}";
+        }
+        file << "\n]}\n";
+        std::cout << "Trace (" << capturedFrames << " klatek): " << path << std::endl;
+        return true;
+    }
+
+    void destroy() {
+        for (Slot& slot : slots) {
+            if (!slot.timeQueries.empty()) {
+                glDeleteQueries((GLsizei)slot.timeQueries.size(), slot.timeQueries.data());
+            }
+            if (!slot.primitiveQueries.empty()) {
+                glDeleteQueries((GLsizei)slot.primitiveQueries.size(), slot.primitiveQueries.data());
+            }
+            if (!slot.sampleQueries.empty()) {
+                glDeleteQueries((GLsizei)slot.sampleQueries.size(), slot.sampleQueries.data());
+            }
+            slot.timeQueries.clear();
+            slot.primitiveQueries.clear();
+            slot.sampleQueries.clear();
+        }
+    }
+
+private:
+    struct Record {
+        const char* name;
+        int depth;
+        double cpuBeginUs, cpuEndUs;
+        int timeQuery;        // para [TIME_ELAPSED, TIMESTAMP] w puli slotu
+        int primitivesQuery;
+        int samplesQuery;
+    };
+
+    struct Slot {
+        std::vector<Record> records;
+        std::vector<GLuint> timeQueries, primitiveQueries, sampleQueries;
+        int usedTimeQueries = 0, usedPrimitiveQueries = 0, usedSampleQueries = 0;
+        bool pending = false;
+        long frameNumber = 0;
+        double frameBeginUs = 0.0, frameEndUs = 0.0;
+        FrameCounters counters = FrameCounters();
+    };
+
+    struct TraceEvent {
+        const char* name;
+        int track;   // 1 = CPU, 2 = GPU
+        long frame;
+        double beginUs, durationUs;
+    };
+
+    double nowUs() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // Pula zapytan rosnie tylko przy pierwszych klatkach
+    int acquire(std::vector<GLuint>& pool, int& used, int count) {
+        if (used + count > (int)pool.size()) {
+            size_t oldSize = pool.size();
+            pool.resize(used + count);
+            glGenQueries((GLsizei)(pool.size() - oldSize), pool.data() + oldSize);
+        }
+        int index = used;
+        used += count;
+        return index;
+    }
+
+    bool isAvailable(GLuint query) const {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        return available != 0;
+    }
+
+    void collect(Slot& slot) {
+        slot.pending = false;
+
+        // Wszystkie zapytania musza byc gotowe - inaczej klatka jest pomijana
+        for (int i = 0; i < slot.usedTimeQueries; ++i) {
+            if (!isAvailable(slot.timeQueries[i])) return;
+        }
+        for (int i = 0; i < slot.usedPrimitiveQueries; ++i) {
+            if (!isAvailable(slot.primitiveQueries[i])) return;
+        }
+        for (int i = 0; i < slot.usedSampleQueries; ++i) {
+            if (!isAvailable(slot.sampleQueries[i])) return;
+        }
+
+        results.clear();
+        counters = slot.counters;
+        counters.tessTriangles = 0;
+        counters.shadedSamples = 0;
+        frameCpuMs = (slot.frameEndUs - slot.frameBeginUs) / 1000.0;
+        frameGpuMs = 0.0;
+
+        bool capture = captureFramesLeft > 0;
+        if (capture) {
+            traceEvents.push_back({"Klatka", 1, slot.frameNumber, slot.frameBeginUs,
+                                   slot.frameEndUs - slot.frameBeginUs});
+        }
+
+        for (const Record& record : slot.records) {
+            ProfileResult result;
+            result.name = record.name;
+            result.depth = record.depth;
+            result.cpuMs = (record.cpuEndUs - record.cpuBeginUs) / 1000.0;
+            result.gpuMs = -1.0;
+
+            if (record.timeQuery >= 0) {
+                GLuint64 elapsedNs = 0, beginNs = 0;
+                glGetQueryObjectui64v(slot.timeQueries[record.timeQuery], GL_QUERY_RESULT, &elapsedNs);
+                glGetQueryObjectui64v(slot.timeQueries[record.timeQuery + 1], GL_QUERY_RESULT, &beginNs);
+                result.gpuMs = elapsedNs / 1.0e6;
+                frameGpuMs += result.gpuMs;
+                if (capture) {
+                    traceEvents.push_back({record.name, 2, slot.frameNumber,
+                                           beginNs / 1000.0 + gpuClockOffsetUs, elapsedNs / 1000.0});
+                }
+            }
+            if (record.primitivesQuery >= 0) {
+                GLuint primitives = 0;
+                glGetQueryObjectuiv(slot.primitiveQueries[record.primitivesQuery], GL_QUERY_RESULT, &primitives);
+                counters.tessTriangles += primitives;
+            }
+            if (record.samplesQuery >= 0) {
+                GLuint samples = 0;
+                glGetQueryObjectuiv(slot.sampleQueries[record.samplesQuery], GL_QUERY_RESULT, &samples);
+                counters.shadedSamples += samples;
+            }
+            if (capture) {
+                traceEvents.push_back({record.name, 1, -1, record.cpuBeginUs,
+                                       record.cpuEndUs - record.cpuBeginUs});
+            }
+            results.push_back(result);
+        }
+
+        if (capture) {
+            --captureFramesLeft;
+            ++capturedFrames;
+        }
+    }
+
+    Slot slots[PROFILER_LATENCY];
+    long frameNumber;
+    int activeGpuScope;
+    int activePrimitivesScope;
+    int activeSamplesScope;
+    std::vector<int> openScopes;
+
+    std::chrono::steady_clock::time_point epoch;
+    double gpuClockOffsetUs;
+
+    std::vector<TraceEvent> traceEvents;
+    int captureFramesLeft;
+    int capturedFrames;
+};
+
+// Zakres RAII: ProfileScope scope(profiler, "Obiekty");
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& profiler, const char* name, unsigned int flags = PROFILE_GPU)
+        : profiler(profiler), scope(profiler.beginScope(name, flags)) {}
+    ~ProfileScope() { profiler.endScope(scope); }
+
+private:
+    FrameProfiler& profiler;
+    int scope;
+};
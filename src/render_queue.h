@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gl_state.h"
+#include "profiler.h"
+#include "shader.h"
+#include "uniform_buffers.h"
+
+// ============== KOLEJKA RYSOWANIA (KLUCZE SORTOWANIA) ==============
+// Rysowania klatki trafiaja do kolejki jako komendy z 64-bitowym kluczem.
+// Po sortowaniu pozycyjnym (LSD po bajtach, stabilne) komendy o tym samym
+// stanie leza obok siebie, a execute() zmienia program, culling i material
+// tylko na granicach grup. Uklad klucza od najstarszych bitow:
+//   przebieg 4 | program 8 | stan 4 | VAO 12 | material 12 | glebokosc 24
+// Glebokosc (od przodu) rozstrzyga dopiero przy identycznym stanie; rowne
+// klucze zachowuja kolejnosc dodania. Bez sortowania stanu klucz to tylko
+// przebieg i glebokosc.
+// Sortowanie od przodu (--sort) razem z sortowaniem stanu: w przebiegach
+// glebokosci i nieprzezroczystym zgrubna glebokosc (256 przedzialow zasiegu)
+// idzie przed stanem, zeby early-Z dzialal miedzy materialami:
+//   przebieg 4 | glebokosc 8 | program 8 | stan 4 | VAO 12 | material 12 | glebokosc 16
+// Grupy stanu laczone sa wtedy tylko w obrebie przedzialu glebokosci.
+
+enum RenderPass {
+    RENDER_PASS_DEPTH = 0,      // pre-pass glebokosci
+    RENDER_PASS_OPAQUE = 1,     // siatki trojkatow
+    RENDER_PASS_SURFACES = 2,   // powierzchnie Beziera (tessellation)
+    RENDER_PASS_COUNT = 3
+};
+
+const unsigned int RENDER_STATE_TWO_SIDED = 1;   // bez GL_CULL_FACE
+
+struct RenderCommand {
+    Shader* shader;
+    unsigned int vertexArray;   // tylko do klucza - VAO wiaze rysujacy
+    int material;               // -1 - bez materialu (przebieg glebokosci)
+    unsigned int state;         // RENDER_STATE_*
+    int kind;                   // rodzaj rysowania - interpretuje funkcja z execute()
+    int index;
+};
+
+class RenderQueue {
+public:
+    RenderQueue() : passBegin(), depthScale(0.0f), sortState(true) {}
+
+    // depthRange - glebokosc widoku mapowana na najwieksza wartosc pola klucza;
+    // 0 wylacza glebokosc w kluczu (kolejnosc dodania w grupie stanu)
+    void begin(float depthRange, bool stateSorting) {
+        commands.clear();
+        items.clear();
+        std::fill(passBegin, passBegin + RENDER_PASS_COUNT + 1, 0);
+        depthScale = depthRange > 0.0f ? (float)DEPTH_MASK / depthRange : 0.0f;
+        sortState = stateSorting;
+    }
+
+    void submit(RenderPass pass, const RenderCommand& command, float depth) {
+        items.push_back({makeKey(pass, command, depth), (unsigned int)commands.size()});
+        commands.push_back(command);
+    }
+
+    // Sortowanie pozycyjne 8 x 256 kubelkow; histogramy wszystkich bajtow z
+    // jednego przejscia, bajty jednakowe we wszystkich kluczach sa pomijane
+    void sort() {
+        std::fill(passBegin, passBegin + RENDER_PASS_COUNT + 1, items.size());
+        if (items.empty()) return;
+
+        std::memset(histogram, 0, sizeof(histogram));
+        for (const Item& item : items) {
+            for (int byte = 0; byte < 8; ++byte) ++histogram[byte][(item.key >> (byte * 8)) & 0xFF];
+        }
+        scratch.resize(items.size());
+        for (int byte = 0; byte < 8; ++byte) {
+            size_t* counts = histogram[byte];
+            if (counts[(items[0].key >> (byte * 8)) & 0xFF] == items.size()) continue;
+            size_t offset = 0;
+            for (int value = 0; value < 256; ++value) {
+                size_t count = counts[value];
+                counts[value] = offset;
+                offset += count;
+            }
+            for (const Item& item : items) scratch[counts[(item.key >> (byte * 8)) & 0xFF]++] = item;
+            items.swap(scratch);
+        }
+
+        for (int pass = RENDER_PASS_COUNT - 1; pass >= 0; --pass) {
+            auto first = std::partition_point(items.begin(), items.end(), [pass](const Item& item) {
+                return (int)(item.key >> PASS_SHIFT) < pass;
+            });
+            passBegin[pass] = (size_t)(first - items.begin());
+        }
+    }
+
+    // Komendy przebiegu w kolejnosci kluczy; draw(const RenderCommand&) rysuje
+    // przy ustawionym programie, cullingu i materiale. Przywraca culling.
+    template <typename DrawFn>
+    void execute(RenderPass pass, const UniformBuffers& ubo, DrawFn&& draw) {
+        int material = -1;
+        for (size_t i = passBegin[pass]; i < passBegin[pass + 1]; ++i) {
+            const RenderCommand& command = commands[items[i].command];
+            command.shader->use();
+            setCullFace((command.state & RENDER_STATE_TWO_SIDED) == 0);
+            if (command.material >= 0) {
+                if (command.material != material) {
+                    ubo.bindMaterial(command.material);
+                    material = command.material;
+                } else {
+                    countSkippedStateChange();
+                }
+            }
+            draw(command);
+        }
+        setCullFace(true);
+    }
+
+    size_t size() const { return commands.size(); }
+
+private:
+    static const int PASS_SHIFT = 60;
+    static const int PROGRAM_SHIFT = 52;
+    static const int STATE_SHIFT = 48;
+    static const int VAO_SHIFT = 36;
+    static const int MATERIAL_SHIFT = 24;
+    static const uint32_t DEPTH_MASK = 0xFFFFFF;
+    static const int DEPTH_BITS = 24;
+    static const int COARSE_DEPTH_BITS = 8;   // przedzialy glebokosci nad stanem (sortowanie od przodu)
+
+    struct Item {
+        uint64_t key;
+        unsigned int command;
+    };
+
+    uint64_t makeKey(RenderPass pass, const RenderCommand& command, float depth) {
+        uint64_t key = (uint64_t)pass << PASS_SHIFT;
+        uint64_t quantized = (uint64_t)std::min(std::max(depth * depthScale, 0.0f), (float)DEPTH_MASK);
+        if (!sortState) return key | quantized;
+
+        // Zgrubna glebokosc nad stanem - stan przesuniety o jej bity w dol
+        bool depthFirst = depthScale > 0.0f && (pass == RENDER_PASS_DEPTH || pass == RENDER_PASS_OPAQUE);
+        uint64_t state = (uint64_t)(programSlot(command.shader->ID) & 0xFF) << PROGRAM_SHIFT;
+        state |= (uint64_t)(command.state & 0xF) << STATE_SHIFT;
+        state |= (uint64_t)(command.vertexArray & 0xFFF) << VAO_SHIFT;
+        state |= (uint64_t)((command.material + 1) & 0xFFF) << MATERIAL_SHIFT;
+        if (!depthFirst) return key | state | quantized;
+
+        uint64_t coarse = quantized >> (DEPTH_BITS - COARSE_DEPTH_BITS);
+        return key | coarse << (PASS_SHIFT - COARSE_DEPTH_BITS) | state >> COARSE_DEPTH_BITS |
+               quantized >> COARSE_DEPTH_BITS;
+    }
+
+    // Identyfikatory programow bywaja duze - w kluczu gesty indeks (programow jest kilkanascie)
+    unsigned int programSlot(unsigned int program) {
+        for (size_t i = 0; i < programs.size(); ++i) {
+            if (programs[i] == program) return (unsigned int)i;
+        }
+        programs.push_back(program);
+        return (unsigned int)programs.size() - 1;
+    }
+
+    std::vector<RenderCommand> commands;
+    std::vector<Item> items, scratch;
+    std::vector<unsigned int> programs;
+    size_t histogram[8][256];
+    size_t passBegin[RENDER_PASS_COUNT + 1];
+    float depthScale;
+    bool sortState;
+};
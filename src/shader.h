@@ -0,0 +1,388 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gl_state.h"
+#include "profiler.h"
+#include "shader_cache.h"
+#include "uniform_buffers.h"
+
+// Wspolny cache binariow dla wszystkich programow
+inline ProgramBinaryCache& shaderBinaryCache() {
+    static ProgramBinaryCache cache;
+    return cache;
+}
+
+// ============== SHADER CLASS ==============
+class Shader {
+public:
+    unsigned int ID;
+
+    Shader() : ID(0) {}
+
+    // Pojedynczy program - partia ShaderBuilder z jednym elementem
+    bool loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath,
+                       const std::string& tcsPath = "", const std::string& tesPath = "");
+
+    // Program z samym compute shaderem (GL 4.3+)
+    bool loadCompute(const std::string& computePath);
+
+    // Przez cache stanu - ponowne use() tego samego programu nic nie kosztuje
+    void use() {
+        useProgram(ID);
+    }
+
+    // Lokalizacje sa zapamietywane - glGetUniformLocation wolany jest raz na nazwe
+    int getUniformLocation(const std::string& name) const {
+        auto it = uniformLocations.find(name);
+        if (it != uniformLocations.end()) return it->second;
+        int location = glGetUniformLocation(ID, name.c_str());
+        uniformLocations[name] = location;
+        return location;
+    }
+
+    void setBool(const std::string& name, bool value) const {
+        glUniform1i(getUniformLocation(name), (int)value);
+        countUniformUpload();
+    }
+    void setInt(const std::string& name, int value) const {
+        glUniform1i(getUniformLocation(name), value);
+        countUniformUpload();
+    }
+    void setFloat(const std::string& name, float value) const {
+        glUniform1f(getUniformLocation(name), value);
+        countUniformUpload();
+    }
+    void setVec2(const std::string& name, const glm::vec2& value) const {
+        glUniform2fv(getUniformLocation(name), 1, glm::value_ptr(value));
+        countUniformUpload();
+    }
+    void setVec3(const std::string& name, const glm::vec3& value) const {
+        glUniform3fv(getUniformLocation(name), 1, glm::value_ptr(value));
+        countUniformUpload();
+    }
+    void setVec4Array(const std::string& name, const glm::vec4* values, int count) const {
+        glUniform4fv(getUniformLocation(name), count, glm::value_ptr(values[0]));
+        countUniformUpload();
+    }
+    void setMat3(const std::string& name, const glm::mat3& mat) const {
+        glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
+        countUniformUpload();
+    }
+    void setMat4(const std::string& name, const glm::mat4& mat) const {
+        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
+        countUniformUpload();
+    }
+
+    // Wersje przyjmujace lokalizacje - dla uniformow ustawianych per obiekt
+    void setMat3(int location, const glm::mat3& mat) const {
+        glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+        countUniformUpload();
+    }
+    void setMat4(int location, const glm::mat4& mat) const {
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+        countUniformUpload();
+    }
+
+private:
+    friend class ShaderBuilder;
+
+    // Stan zalezny od programu - po linkowaniu i po wczytaniu binarium
+    void onLinked() {
+        uniformLocations.clear();
+        UniformBuffers::bindBlocks(ID);
+    }
+
+    mutable std::unordered_map<std::string, int> uniformLocations;
+};
+
+// ============== BUDOWANIE PROGRAMOW (PARTIAMI) ==============
+// Zrodla wszystkich programow partii czytane sa w watku roboczym, potem
+// wszystkie kompilacje i linkowania zlecane naraz - bez pytania o status po
+// kazdym etapie (glGet*iv statusu czeka na kompilator). Z
+// GL_KHR/ARB_parallel_shader_compile sterownik kompiluje we wlasnych watkach,
+// a postep sprawdzany jest przez GL_COMPLETION_STATUS bez blokowania.
+// Bledy wypisywane sa z pelnym logiem, numery linii jako plik:linia.
+
+class ShaderBuilder {
+public:
+    void add(Shader& shader, const std::string& vertexPath, const std::string& fragmentPath,
+             const std::string& tcsPath = "", const std::string& tesPath = "") {
+        addVariant(shader, "", vertexPath, fragmentPath, tcsPath, tesPath);
+    }
+
+    // Program z dyrektywami (np. "#define USE_FOG\n") wstawionymi za #version
+    // kazdego etapu - klucz cache binariow obejmuje je razem ze zrodlem
+    void addVariant(Shader& shader, const std::string& defines, const std::string& vertexPath,
+                    const std::string& fragmentPath, const std::string& tcsPath = "",
+                    const std::string& tesPath = "") {
+        Job job;
+        job.target = &shader;
+        job.defines = defines;
+        job.stages.push_back(Stage(GL_VERTEX_SHADER, vertexPath));
+        job.stages.push_back(Stage(GL_FRAGMENT_SHADER, fragmentPath));
+        if (!tcsPath.empty() && !tesPath.empty()) {
+            job.stages.push_back(Stage(GL_TESS_CONTROL_SHADER, tcsPath));
+            job.stages.push_back(Stage(GL_TESS_EVALUATION_SHADER, tesPath));
+        }
+        jobs.push_back(job);
+    }
+
+    void addCompute(Shader& shader, const std::string& computePath) {
+        Job job;
+        job.target = &shader;
+        job.stages.push_back(Stage(GL_COMPUTE_SHADER, computePath));
+        jobs.push_back(job);
+    }
+
+    size_t size() const { return jobs.size(); }
+
+    // Cala partia. waitFrame(gotowe, wszystkie) wolane w czasie czytania zrodel
+    // i kompilacji (np. klatka ladowania); bez niej finish() czeka na sterownik.
+    bool build(const std::function<void(size_t, size_t)>& waitFrame = nullptr) {
+        std::future<void> reading = std::async(std::launch::async, [this]() { readSources(); });
+        if (waitFrame) {
+            while (reading.wait_for(std::chrono::milliseconds(5)) != std::future_status::ready) {
+                waitFrame(0, jobs.size());
+            }
+        }
+        reading.get();
+
+        submit();
+        if (waitFrame && parallelCompile()) {
+            size_t ready;
+            while ((ready = poll()) < jobs.size()) waitFrame(ready, jobs.size());
+        }
+        return finish();
+    }
+
+private:
+    struct Stage {
+        GLenum type;
+        std::string path;
+        std::string source;
+        unsigned int shader;
+
+        Stage(GLenum stageType, const std::string& stagePath) : type(stageType), path(stagePath), shader(0) {}
+    };
+
+    struct Job {
+        Shader* target = NULL;
+        std::vector<Stage> stages;
+        std::string defines;
+        std::string error;        // blad odczytu zrodel (watek roboczy)
+        unsigned int program = 0;
+        uint64_t cacheKey = 0;
+        bool cached = false;      // program z binarium - gotowy po submit()
+    };
+
+    // Watek roboczy - bez wywolan GL
+    void readSources() {
+        for (Job& job : jobs) {
+            for (Stage& stage : job.stages) {
+                std::ifstream file(stage.path);
+                if (!file.is_open()) {
+                    job.error = "Nie mozna otworzyc: " + stage.path;
+                    break;
+                }
+                std::stringstream stream;
+                stream << file.rdbuf();
+                stage.source = insertDefines(stream.str(), job.defines);
+            }
+        }
+    }
+
+    // Dyrektywy za linia #version; #line przywraca numeracje pliku w logach bledow
+    static std::string insertDefines(const std::string& source, const std::string& defines) {
+        if (defines.empty()) return source;
+        size_t version = source.find("#version");
+        size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+        if (lineEnd == std::string::npos) return defines + source;
+        size_t nextLine = 2 + std::count(source.begin(), source.begin() + lineEnd, '\n');
+        return source.substr(0, lineEnd + 1) + defines + "#line " + std::to_string(nextLine) + "\n" +
+               source.substr(lineEnd + 1);
+    }
+
+    // Wlaczane raz na kontekst; maksymalna liczba watkow kompilatora sterownika
+    static bool parallelCompile() {
+        static int supported = -1;
+        if (supported < 0) {
+            supported = 0;
+            if (GLEW_KHR_parallel_shader_compile) {
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+                supported = 1;
+            } else if (GLEW_ARB_parallel_shader_compile) {
+                glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+                supported = 1;
+            }
+        }
+        return supported == 1;
+    }
+
+    // Najpierw wszystkie kompilacje, potem wszystkie linkowania - statusy dopiero w finish()
+    void submit() {
+        parallelCompile();
+        ProgramBinaryCache& cache = shaderBinaryCache();
+        for (Job& job : jobs) {
+            if (!job.error.empty()) continue;
+            std::vector<std::string> sources;
+            for (const Stage& stage : job.stages) sources.push_back(stage.source);
+            job.cacheKey = cache.makeKey(sources);
+
+            // Gotowy program z cache binariow - bez kompilacji i linkowania
+            job.program = glCreateProgram();
+            if (cache.load(job.program, job.cacheKey)) {
+                job.cached = true;
+                continue;
+            }
+            glDeleteProgram(job.program);
+            job.program = 0;
+
+            for (Stage& stage : job.stages) {
+                stage.shader = glCreateShader(stage.type);
+                const char* code = stage.source.c_str();
+                glShaderSource(stage.shader, 1, &code, NULL);
+                glCompileShader(stage.shader);
+            }
+        }
+        for (Job& job : jobs) {
+            if (!job.error.empty() || job.cached) continue;
+            job.program = glCreateProgram();
+            glProgramParameteri(job.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            for (const Stage& stage : job.stages) glAttachShader(job.program, stage.shader);
+            glLinkProgram(job.program);
+        }
+    }
+
+    // Programy gotowe do sprawdzenia bez czekania (tylko z parallel_shader_compile)
+    size_t poll() const {
+        size_t ready = 0;
+        for (const Job& job : jobs) {
+            GLint complete = GL_TRUE;
+            if (!job.error.empty() || job.cached) {
+                ++ready;
+                continue;
+            }
+            glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &complete);
+            if (complete) ++ready;
+        }
+        return ready;
+    }
+
+    // Statusy wszystkich programow; bledy kazdego z nich, nie tylko pierwszego
+    bool finish() {
+        bool ok = true;
+        ProgramBinaryCache& cache = shaderBinaryCache();
+        for (Job& job : jobs) {
+            if (!job.error.empty()) {
+                std::cerr << job.error << std::endl;
+                ok = false;
+                continue;
+            }
+            GLint linked = GL_TRUE;
+            if (!job.cached) {
+                glGetProgramiv(job.program, GL_LINK_STATUS, &linked);
+                if (!linked) reportErrors(job);
+                for (Stage& stage : job.stages) glDeleteShader(stage.shader);
+                if (linked) cache.store(job.program, job.cacheKey);
+            }
+            if (!linked) {
+                glDeleteProgram(job.program);
+                job.target->ID = 0;
+                ok = false;
+                continue;
+            }
+            job.target->ID = job.program;
+            job.target->onLinked();
+        }
+        jobs.clear();
+        return ok;
+    }
+
+    void reportErrors(const Job& job) const {
+        bool stageFailed = false;
+        for (const Stage& stage : job.stages) {
+            GLint compiled = GL_TRUE;
+            glGetShaderiv(stage.shader, GL_COMPILE_STATUS, &compiled);
+            if (compiled) continue;
+            stageFailed = true;
+            GLint length = 0;
+            glGetShaderiv(stage.shader, GL_INFO_LOG_LENGTH, &length);
+            std::string log(std::max(length, 1), '\0');
+            glGetShaderInfoLog(stage.shader, (GLsizei)log.size(), NULL, &log[0]);
+            std::cerr << "Blad kompilacji " << stage.path << describeDefines(job) << ":\n"
+                      << annotateLog(stage.path, log.c_str());
+        }
+        if (stageFailed) return;
+
+        GLint length = 0;
+        glGetProgramiv(job.program, GL_INFO_LOG_LENGTH, &length);
+        std::string log(std::max(length, 1), '\0');
+        glGetProgramInfoLog(job.program, (GLsizei)log.size(), NULL, &log[0]);
+        std::cerr << "Blad linkowania";
+        for (const Stage& stage : job.stages) std::cerr << " " << stage.path;
+        std::cerr << describeDefines(job) << ":\n" << log.c_str() << std::endl;
+    }
+
+    // " [USE_BLINN USE_FOG]" dla wariantow, pusty napis dla zwyklych programow
+    static std::string describeDefines(const Job& job) {
+        if (job.defines.empty()) return "";
+        std::istringstream lines(job.defines);
+        std::string line, names;
+        while (std::getline(lines, line)) {
+            if (line.compare(0, 8, "#define ") != 0) continue;
+            names += (names.empty() ? "" : " ") + line.substr(8);
+        }
+        return " [" + names + "]";
+    }
+
+    // Polozenie bledu jako plik:linia[:kolumna]. Formaty sterownikow:
+    // "0(12) : error" (NVIDIA), "0:12(5): error" (Mesa), "ERROR: 0:12: ..." (AMD/Intel)
+    static std::string annotateLog(const std::string& path, const std::string& log) {
+        static const std::regex location("^(ERROR: |WARNING: )?\\d+[:(](\\d+)\\)?(?:\\((\\d+)\\))?[ :]*");
+        std::istringstream lines(log);
+        std::ostringstream out;
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.empty()) continue;
+            std::smatch match;
+            if (std::regex_search(line, match, location)) {
+                out << path << ":" << match[2];
+                if (match[3].matched) out << ":" << match[3];
+                out << ": " << match[1] << match.suffix() << "\n";
+            } else {
+                out << path << ": " << line << "\n";
+            }
+        }
+        return out.str();
+    }
+
+    std::vector<Job> jobs;
+};
+
+inline bool Shader::loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath,
+                                  const std::string& tcsPath, const std::string& tesPath) {
+    ShaderBuilder builder;
+    builder.add(*this, vertexPath, fragmentPath, tcsPath, tesPath);
+    return builder.build();
+}
+
+inline bool Shader::loadCompute(const std::string& computePath) {
+    ShaderBuilder builder;
+    builder.addCompute(*this, computePath);
+    return builder.build();
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// ============== CACHE BINARIOW PROGRAMOW ==============
+// Zlinkowane programy zapisywane sa na dysku (glGetProgramBinary) i przy
+// kolejnym uruchomieniu wczytywane przez glProgramBinary zamiast kompilacji.
+// Klucz to hash zrodel wszystkich etapow + vendor/renderer/wersja sterownika,
+// wiec zmiana shadera albo aktualizacja sterownika daje nowy plik.
+
+// Plik tymczasowy zapisu do cache (tez CookedMeshCache, CookedTextureCache):
+// nazwa z pid i licznikiem, wiec rownolegli pisarze - procesy i watki - nie
+// pisza do wspolnego pliku; kazdy rename podmienia docelowy plik w calosci
+inline std::string cacheTempPath(const std::string& path) {
+    static std::atomic<unsigned long> counter(0);
+#ifdef _WIN32
+    unsigned long pid = (unsigned long)_getpid();
+#else
+    unsigned long pid = (unsigned long)getpid();
+#endif
+    return path + "." + std::to_string(pid) + "." + std::to_string(counter++) + ".tmp";
+}
+
+class ProgramBinaryCache {
+public:
+    explicit ProgramBinaryCache(const std::string& directory = "shader_cache")
+        : directory(directory), enabled(true), supportChecked(false), supported(false) {}
+
+    void setEnabled(bool value) { enabled = value; }
+
+    // Wymaga aktywnego kontekstu - sterownik moze nie obslugiwac zadnego formatu
+    bool isAvailable() {
+        if (!enabled) return false;
+        if (!supportChecked) {
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            supported = formats > 0;
+            supportChecked = true;
+        }
+        return supported;
+    }
+
+    // FNV-1a (64 bit) ze zrodel i identyfikacji sterownika
+    uint64_t makeKey(const std::vector<std::string>& sources) const {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const char* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= (unsigned char)data[i];
+                hash *= 1099511628211ull;
+            }
+            // Separator - "ab"+"c" i "a"+"bc" daja rozne klucze
+            hash ^= 0xff;
+            hash *= 1099511628211ull;
+        };
+        const GLenum driverStrings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+        for (GLenum name : driverStrings) {
+            const char* value = (const char*)glGetString(name);
+            if (value) mix(value, std::char_traits<char>::length(value));
+        }
+        for (const std::string& source : sources) {
+            mix(source.data(), source.size());
+        }
+        return hash;
+    }
+
+    // Zwraca true gdy program zostal zlinkowany z binarium. Odrzucone
+    // binarium (np. po zmianie sterownika) jest usuwane z dysku.
+    bool load(GLuint program, uint64_t key) {
+        if (!isAvailable()) return false;
+
+        std::string path = pathFor(key);
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        FileHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        bool valid = file.good() && header.magic == MAGIC && header.version == VERSION &&
+                     header.key == key && header.length > 0;
+        std::vector<char> binary;
+        if (valid) {
+            binary.resize(header.length);
+            file.read(binary.data(), header.length);
+            valid = file.good();
+        }
+        file.close();
+
+        if (valid) {
+            glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+            GLint success = 0;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (success) return true;
+        }
+
+        std::cerr << "Cache shaderow: odrzucono " << path << ", kompilacja ze zrodel" << std::endl;
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return false;
+    }
+
+    // Zapis przez wlasny plik tymczasowy (cacheTempPath) + rename, zeby przerwany
+    // zapis albo dwa rownolegle procesy nigdy nie zostawily polowy pliku pod
+    // docelowa nazwa
+    bool store(GLuint program, uint64_t key) {
+        if (!isAvailable()) return false;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return false;
+
+        std::vector<char> binary(length);
+        FileHeader header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.key = key;
+        GLenum format = 0;
+        glGetProgramBinary(program, length, NULL, &format, binary.data());
+        header.format = format;
+        header.length = (uint32_t)length;
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) return false;
+
+        std::string path = pathFor(key);
+        std::string tmpPath = cacheTempPath(path);
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(binary.data(), binary.size());
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(tmpPath, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const uint32_t MAGIC = 0x42504b47; // "GKPB"
+    static const uint32_t VERSION = 1;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    std::string pathFor(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+
+    std::string directory;
+    bool enabled;
+    bool supportChecked;
+    bool supported;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gl_state.h"
+#include "shader.h"
+#include "uniform_buffers.h"
+
+// ============== WARIANTY SHADEROW (PERMUTACJE) ==============
+// Zamiast galezi po uniformach bool (useBlinn, fogEnabled, useTexture,
+// useCheckerboard, useFlagColors) kazda kombinacja cech to osobny program
+// skompilowany z #define - petle swiatel nie sprawdzaja trybu dla kazdego
+// swiatla, a kod wylaczonych cech nie trafia do programu. Warianty leza
+// w cache wg maski cech. Komplet potrzebny scenie (cechy globalne x maski
+// materialow) budowany jest jedna partia przy starcie; wariant spoza
+// kompletu kompiluje sie przy pierwszym uzyciu (z ostrzezeniem).
+
+enum ShaderFeature {
+    SHADER_FEATURE_BLINN = 1 << 0,          // USE_BLINN - Blinn-Phong zamiast Phonga
+    SHADER_FEATURE_FOG = 1 << 1,            // USE_FOG - mgla wykladnicza
+    SHADER_FEATURE_TEXTURE = 1 << 2,        // USE_TEXTURE - kolor z tekstury
+    SHADER_FEATURE_CHECKERBOARD = 1 << 3,   // USE_CHECKERBOARD - szachownica z UV
+    SHADER_FEATURE_FLAG_COLORS = 1 << 4,    // USE_FLAG_COLORS - pasy flagi
+    SHADER_FEATURE_COUNT = 5
+};
+
+// Cechy przelaczane klawiszami (wspolne dla klatki) i cechy materialu
+const unsigned int SHADER_FEATURES_GLOBAL = SHADER_FEATURE_BLINN | SHADER_FEATURE_FOG;
+const unsigned int SHADER_FEATURES_MATERIAL =
+    SHADER_FEATURE_TEXTURE | SHADER_FEATURE_CHECKERBOARD | SHADER_FEATURE_FLAG_COLORS;
+
+inline const char* shaderFeatureName(int bit) {
+    static const char* names[SHADER_FEATURE_COUNT] = {"USE_BLINN", "USE_FOG", "USE_TEXTURE", "USE_CHECKERBOARD",
+                                                      "USE_FLAG_COLORS"};
+    return names[bit];
+}
+
+inline std::string shaderDefines(unsigned int features) {
+    std::string defines;
+    for (int bit = 0; bit < SHADER_FEATURE_COUNT; ++bit) {
+        if (features & (1u << bit)) defines += std::string("#define ") + shaderFeatureName(bit) + "\n";
+    }
+    return defines;
+}
+
+// Szachownica ma pierwszenstwo przed tekstura (jak galezie w fragment.glsl)
+inline unsigned int materialFeatures(const MaterialStd140& material) {
+    unsigned int features = 0;
+    if (material.useCheckerboard) {
+        features |= SHADER_FEATURE_CHECKERBOARD;
+    } else if (material.useTexture) {
+        features |= SHADER_FEATURE_TEXTURE;
+    }
+    if (material.useFlagColors) features |= SHADER_FEATURE_FLAG_COLORS;
+    return features;
+}
+
+class ShaderVariants {
+public:
+    ShaderVariants() : supported(0) {}
+
+    // supportedFeatures - cechy rozrozniane przez pliki programu; pozostale
+    // bity masek sa pomijane (wspolny wariant)
+    void setup(const std::string& programName, unsigned int supportedFeatures, const std::string& vertex,
+               const std::string& fragment, const std::string& tcs = "", const std::string& tes = "") {
+        name = programName;
+        supported = supportedFeatures;
+        vertexPath = vertex;
+        fragmentPath = fragment;
+        tcsPath = tcs;
+        tesPath = tes;
+    }
+
+    // Do partii: kazda kombinacja obslugiwanych cech globalnych z kazda maska materialu
+    void addTo(ShaderBuilder& builder, const std::vector<unsigned int>& materialMasks) {
+        unsigned int globals = supported & SHADER_FEATURES_GLOBAL;
+        for (unsigned int material : materialMasks) {
+            // Wszystkie podzbiory bitow globals
+            unsigned int subset = 0;
+            do {
+                unsigned int features = (subset | material) & supported;
+                if (variants.find(features) == variants.end()) {
+                    builder.addVariant(variants[features].shader, shaderDefines(features), vertexPath,
+                                       fragmentPath, tcsPath, tesPath);
+                }
+                subset = (subset - globals) & globals;
+            } while (subset != 0);
+        }
+    }
+
+    Shader& select(unsigned int features) {
+        features &= supported;
+        auto it = variants.find(features);
+        if (it == variants.end()) {
+            std::cerr << "Wariant " << name << " [" << describe(features)
+                      << "] spoza kompletu - kompilacja w trakcie renderowania" << std::endl;
+            it = variants.insert(std::make_pair(features, Variant())).first;
+            ShaderBuilder builder;
+            builder.addVariant(it->second.shader, shaderDefines(features), vertexPath, fragmentPath, tcsPath,
+                               tesPath);
+            builder.build();
+        }
+        ++it->second.selections;
+        return it->second.shader;
+    }
+
+    // Raport kosztu: rozmiar binarium (przyblizenie dlugosci kodu po
+    // optymalizacji), aktywne uniformy i wybory od poprzedniego raportu
+    void report(std::ostream& out) {
+        for (auto& entry : variants) {
+            Variant& variant = entry.second;
+            GLint binaryBytes = 0, uniforms = 0;
+            if (variant.shader.ID) {
+                glGetProgramiv(variant.shader.ID, GL_PROGRAM_BINARY_LENGTH, &binaryBytes);
+                glGetProgramiv(variant.shader.ID, GL_ACTIVE_UNIFORMS, &uniforms);
+            }
+            std::string label = name + " [" + describe(entry.first) + "]";
+            out << "  " << std::left << std::setw(52) << label << std::right << std::setw(9) << binaryBytes
+                << " B" << std::setw(6) << uniforms << std::setw(10) << variant.selections << std::endl;
+            variant.selections = 0;
+        }
+    }
+
+    size_t size() const { return variants.size(); }
+
+    void destroy() {
+        for (auto& entry : variants) deleteProgram(entry.second.shader.ID);
+        variants.clear();
+    }
+
+private:
+    struct Variant {
+        Shader shader;
+        unsigned long long selections = 0;
+    };
+
+    static std::string describe(unsigned int features) {
+        std::string text;
+        for (int bit = 0; bit < SHADER_FEATURE_COUNT; ++bit) {
+            if (!(features & (1u << bit))) continue;
+            text += (text.empty() ? "" : " ") + std::string(shaderFeatureName(bit));
+        }
+        return text.empty() ? "-" : text;
+    }
+
+    std::string name;
+    unsigned int supported;
+    std::string vertexPath, fragmentPath, tcsPath, tesPath;
+    std::map<unsigned int, Variant> variants;   // wezly mapy nie zmieniaja adresow - Shader* w kolejce
+};
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "culling.h"
+#include "profiler.h"
+#include "uniform_buffers.h"
+
+// ============== MAPY CIENI Z CACHE ==============
+// Cienie rzucaja dwa pierwsze reflektory (mapy 2D w tablicy tekstur) i dwa
+// pierwsze swiatla punktowe (kostki w tablicy kostek). Kazdy widok swiatla
+// (reflektor albo sciana kostki) ma dwie warstwy glebokosci:
+//  - statyczna: geometria nieruchoma, rysowana tylko gdy zmieni sie widok
+//    swiatla (lampy i reflektor sceny - raz, reflektor pojazdu - gdy pojazd
+//    lub spotlightYaw/Pitch sie ruszy),
+//  - probkowana: kopia statycznej (glBlitFramebuffer) + obiekty ruchome.
+// Kopia i dorysowanie ruchomych obiektow odbywa sie tylko w widokach, ktore
+// te obiekty przecinaja (albo przecinaly klatke wczesniej) - pozostale
+// sciany nie kosztuja ani jednego wywolania rysowania.
+// Widok renderuje sie zwyklymi programami sceny: blok FrameData jest na czas
+// przebiegu podmieniany na kopie z macierzami swiatla (wpis pierscienia
+// danych dynamicznych, jak ShadowData).
+
+const int SHADOW_SPOT_LIGHTS = 2;
+const int SHADOW_POINT_LIGHTS = 2;
+const int SHADOW_VIEWS = SHADOW_SPOT_LIGHTS + SHADOW_POINT_LIGHTS * 6;
+const int SHADOW_SPOT_SIZE = 1024;
+const int SHADOW_CUBE_SIZE = 512;
+// Scena miesci sie w 30 jednostkach od kazdego swiatla - staly zakres
+// (niezalezny od pory dnia), wiec zmiana jasnosci nie uniewaznia map
+const float SHADOW_NEAR = 0.1f;
+const float SHADOW_FAR = 30.0f;
+
+// Blok ShadowData (std140) - czytany przez shadery oswietlenia
+struct ShadowUniformsStd140 {
+    glm::mat4 spotShadowMatrices[SHADOW_SPOT_LIGHTS]; // uklad kamery -> [0,1] mapy reflektora
+    glm::mat4 viewToWorld;       // obrot ukladu kamery do swiata (kierunki kostek)
+    glm::vec4 pointShadowDepth;  // (a, b) obu kostek: glebokosc = a + b / os glowna
+    int shadowedPointLights;     // swiatla 0..n-1 maja mapy (0 - cienie wylaczone)
+    int shadowedSpotLights;
+    float shadowNormalBias;      // przesuniecie wzdluz normalnej na jednostke odleglosci
+    float _pad0;
+};
+
+static_assert(sizeof(ShadowUniformsStd140) == 224, "ShadowData musi miec uklad std140");
+
+class ShadowMaps {
+public:
+    ShadowUniformsStd140 uniforms;
+
+    ShadowMaps() : spotStatic(0), spotSampled(0), cubeStatic(0), cubeSampled(0), views(SHADOW_VIEWS) {
+        std::memset(static_cast<void*>(&uniforms), 0, sizeof(uniforms));
+    }
+
+    bool init() {
+        spotStatic = createArray(GL_TEXTURE_2D_ARRAY, SHADOW_SPOT_SIZE, SHADOW_SPOT_LIGHTS);
+        spotSampled = createArray(GL_TEXTURE_2D_ARRAY, SHADOW_SPOT_SIZE, SHADOW_SPOT_LIGHTS);
+        cubeStatic = createArray(GL_TEXTURE_CUBE_MAP_ARRAY, SHADOW_CUBE_SIZE, SHADOW_POINT_LIGHTS * 6);
+        cubeSampled = createArray(GL_TEXTURE_CUBE_MAP_ARRAY, SHADOW_CUBE_SIZE, SHADOW_POINT_LIGHTS * 6);
+
+        // Jeden framebuffer na warstwe - bez przepinania zalacznikow co klatke
+        for (int i = 0; i < SHADOW_VIEWS; ++i) {
+            View& view = views[i];
+            bool spot = i < SHADOW_SPOT_LIGHTS;
+            int layer = spot ? i : i - SHADOW_SPOT_LIGHTS;
+            view.size = spot ? SHADOW_SPOT_SIZE : SHADOW_CUBE_SIZE;
+            view.staticTarget = createTarget(spot ? spotStatic : cubeStatic, layer);
+            view.sampledTarget = createTarget(spot ? spotSampled : cubeSampled, layer);
+            if (!view.staticTarget || !view.sampledTarget) return false;
+        }
+
+        uniforms.shadowNormalBias = 3.0f / SHADOW_CUBE_SIZE;   // ~1.5 texela kostki
+        // Filtrowanie na krawedziach scian kostki siega do sasiednich scian
+        glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+        return glGetError() == GL_NO_ERROR;
+    }
+
+    // Reflektor i (0..SHADOW_SPOT_LIGHTS-1), pozycja i kierunek w ukladzie swiata
+    void setSpotLight(int index, const glm::vec3& position, const glm::vec3& direction, float outerCutOffDegrees) {
+        glm::vec3 up = std::fabs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        // Zapas 5 stopni - filtrowanie na krawedzi stozka nie wychodzi poza mape
+        float fov = glm::radians(2.0f * outerCutOffDegrees + 5.0f);
+        setView(index, glm::lookAt(position, position + direction, up),
+                glm::perspective(fov, 1.0f, SHADOW_NEAR, SHADOW_FAR));
+    }
+
+    // Swiatlo punktowe i - szesc scian kostki w konwencji GL_TEXTURE_CUBE_MAP_*
+    void setPointLight(int index, const glm::vec3& position) {
+        static const glm::vec3 directions[6] = {
+            glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+            glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)};
+        static const glm::vec3 ups[6] = {
+            glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+            glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)};
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, SHADOW_NEAR, SHADOW_FAR);
+        for (int face = 0; face < 6; ++face) {
+            setView(SHADOW_SPOT_LIGHTS + index * 6 + face,
+                    glm::lookAt(position, position + directions[face], ups[face]), projection);
+        }
+        // Glebokosc okna z odleglosci wzdluz osi glownej: 0.5 * (-P22 + P32 / m) + 0.5
+        uniforms.pointShadowDepth[index * 2] = 0.5f - 0.5f * projection[2][2];
+        uniforms.pointShadowDepth[index * 2 + 1] = 0.5f * projection[3][2];
+    }
+
+    int viewCount() const { return SHADOW_VIEWS; }
+    const Frustum& viewFrustum(int view) const { return views[view].frustum; }
+    bool staticValid(int view) const { return views[view].staticValid; }
+    // Warstwa probkowana rozni sie od statycznej (ruchome obiekty albo nowa statyczna)
+    bool sampledDirty(int view) const { return views[view].sampledDirty; }
+
+    // Przebieg geometrii nieruchomej do warstwy statycznej widoku
+    void beginStatic(int view, UniformBuffers& ubo) {
+        beginView(view, views[view].staticTarget, ubo);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        views[view].staticValid = true;
+        views[view].sampledDirty = true;
+        ++frameCounters.shadowStaticViews;
+    }
+
+    // Kopia warstwy statycznej do probkowanej; potem wywolujacy dorysowuje
+    // obiekty ruchome (dynamicDrawn = czy cos dorysuje)
+    void beginSampled(int view, UniformBuffers& ubo, bool dynamicDrawn) {
+        View& target = views[view];
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target.staticTarget);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.sampledTarget);
+        glBlitFramebuffer(0, 0, target.size, target.size, 0, 0, target.size, target.size, GL_DEPTH_BUFFER_BIT,
+                          GL_NEAREST);
+        countStateChange(2);
+        if (dynamicDrawn) beginView(view, target.sampledTarget, ubo);
+        target.sampledDirty = dynamicDrawn;
+        ++frameCounters.shadowSampledViews;
+    }
+
+    // Stan renderowania widokow swiatla: polygon offset przeciw "tradzikowi"
+    void beginPass() {
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.5f, 4.0f);
+        countStateChange();
+    }
+
+    // Przywraca cel, viewport i FrameData kamery
+    void endPass(unsigned int outputFramebuffer, int viewportWidth, int viewportHeight, UniformBuffers& ubo) {
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+        glViewport(0, 0, viewportWidth, viewportHeight);
+        ubo.bindFrame();
+        countStateChange(3);
+    }
+
+    // Macierze probkowania (uklad kamery biezacej klatki) do pierscienia
+    void upload(const glm::mat4& cameraView, bool enabled, UniformBuffers& ubo) {
+        glm::mat4 inverseView = glm::inverse(cameraView);
+        const glm::mat4 bias = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)) *
+                               glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+        for (int i = 0; i < SHADOW_SPOT_LIGHTS; ++i) {
+            uniforms.spotShadowMatrices[i] = bias * views[i].projection * views[i].view * inverseView;
+        }
+        uniforms.viewToWorld = glm::mat4(glm::mat3(inverseView));
+        uniforms.shadowedPointLights = enabled ? SHADOW_POINT_LIGHTS : 0;
+        uniforms.shadowedSpotLights = enabled ? SHADOW_SPOT_LIGHTS : 0;
+
+        ubo.dynamic.bind(UBO_BINDING_SHADOW, ubo.dynamic.push(uniforms), sizeof(uniforms));
+    }
+
+    void bind() const {
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_SPOT_SHADOWS);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, spotSampled);
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_POINT_SHADOWS);
+        glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, cubeSampled);
+        glActiveTexture(GL_TEXTURE0);
+        countStateChange(2);
+    }
+
+    void destroy() {
+        for (View& view : views) {
+            if (view.staticTarget) glDeleteFramebuffers(1, &view.staticTarget);
+            if (view.sampledTarget) glDeleteFramebuffers(1, &view.sampledTarget);
+            view.staticTarget = view.sampledTarget = 0;
+            view.staticValid = false;
+        }
+        unsigned int textures[] = {spotStatic, spotSampled, cubeStatic, cubeSampled};
+        glDeleteTextures(4, textures);
+        spotStatic = spotSampled = cubeStatic = cubeSampled = 0;
+    }
+
+private:
+    struct View {
+        glm::mat4 view = glm::mat4(1.0f), projection = glm::mat4(1.0f);
+        Frustum frustum;
+        unsigned int staticTarget = 0, sampledTarget = 0;
+        int size = 0;
+        bool staticValid = false;
+        bool sampledDirty = true;
+    };
+
+    // Nowe macierze uniewazniaja warstwe statyczna; te same - nic nie robia
+    void setView(int index, const glm::mat4& view, const glm::mat4& projection) {
+        View& target = views[index];
+        if (target.staticValid && std::memcmp(&target.view, &view, sizeof(view)) == 0 &&
+            std::memcmp(&target.projection, &projection, sizeof(projection)) == 0) {
+            return;
+        }
+        target.view = view;
+        target.projection = projection;
+        target.frustum.extract(projection * view);
+        target.staticValid = false;
+    }
+
+    void beginView(int index, unsigned int framebuffer, UniformBuffers& ubo) {
+        const View& target = views[index];
+        FrameUniformsStd140 lightFrame = ubo.frame;
+        lightFrame.view = target.view;
+        lightFrame.projection = target.projection;
+        lightFrame.viewportSize = glm::vec2((float)target.size);   // poziomy tessellation wg rozdzielczosci mapy
+        ubo.dynamic.bind(UBO_BINDING_FRAME, ubo.dynamic.push(lightFrame), sizeof(lightFrame));
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, target.size, target.size);
+        countStateChange(2);
+    }
+
+    unsigned int createArray(GLenum target, int size, int layers) {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(target, texture);
+        glTexImage3D(target, 0, GL_DEPTH_COMPONENT24, size, size, layers, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT,
+                     NULL);
+        // Porownanie sprzetowe + filtrowanie liniowe = PCF 2x2 w jednym odczycie
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(target, 0);
+        return texture;
+    }
+
+    unsigned int createTarget(unsigned int texture, int layer) {
+        unsigned int framebuffer;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) {
+            std::cerr << "Niekompletny framebuffer mapy cieni (warstwa " << layer << ")" << std::endl;
+            glDeleteFramebuffers(1, &framebuffer);
+            return 0;
+        }
+        return framebuffer;
+    }
+
+    unsigned int spotStatic, spotSampled, cubeStatic, cubeSampled;
+    std::vector<View> views;
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// ============== SYMULACJA ZE STALYM KROKIEM ==============
+// Ruchomy obiekt, reflektor, pora dnia i czas animacji liczy osobny watek
+// ze stala czestotliwoscia (SimulationThread), niezaleznie od dlugosci klatki.
+// Kazdy takt publikuje niezmienny snapshot (stan poprzedni i biezacy) przez
+// potrojny bufor; watek renderowania interpoluje miedzy nimi wg zegara, wiec
+// obraz jest opozniony o co najwyzej jeden takt. Przestoje renderowania
+// (kompilacja shaderow, vsync, swap) nie spowalniaja ruchu, a wynik symulacji
+// zalezy tylko od wejscia w kolejnych taktach.
+
+const int SIMULATION_TICK_RATE = 120;       // takty na sekunde (domyslnie)
+const double SIMULATION_MAX_LAG = 0.25;     // dluzsze zaleglosci sa pomijane, nie doganiane
+
+const float MOVING_OBJECT_SPEED = 2.0f;     // j/s
+const float MOVING_OBJECT_TURN_SPEED = 90.0f;   // stopnie/s
+const float SPOTLIGHT_YAW_SPEED = 45.0f;
+const float SPOTLIGHT_PITCH_SPEED = 30.0f;
+const float SPOTLIGHT_PITCH_LIMIT = 45.0f;
+const float DAY_NIGHT_SPEED = 0.5f;         // pelna zmiana w 2 s
+
+// Wcisniete klawisze (maska bitowa) - probkowane przez watek okna
+enum SimulationInput {
+    SIM_INPUT_FORWARD = 1 << 0,
+    SIM_INPUT_BACK = 1 << 1,
+    SIM_INPUT_TURN_LEFT = 1 << 2,
+    SIM_INPUT_TURN_RIGHT = 1 << 3,
+    SIM_INPUT_SPOT_LEFT = 1 << 4,
+    SIM_INPUT_SPOT_RIGHT = 1 << 5,
+    SIM_INPUT_SPOT_UP = 1 << 6,
+    SIM_INPUT_SPOT_DOWN = 1 << 7,
+    SIM_INPUT_DAY = 1 << 8,
+    SIM_INPUT_NIGHT = 1 << 9
+};
+
+// Jednorazowe komendy (np. z key_callback) - wykonywane w najblizszym takcie
+enum SimulationCommand {
+    SIM_COMMAND_TOGGLE_DAY_NIGHT = 1 << 0
+};
+
+struct SimulationState {
+    glm::vec3 movingObjectPos;
+    float movingObjectAngle;
+    float spotlightYaw;
+    float spotlightPitch;
+    float dayNightFactor;
+    double time;            // czas symulacji (takty * krok)
+};
+
+// Jeden takt symulacji o dlugosci step
+inline void stepSimulation(SimulationState& state, unsigned int input, unsigned int commands, float step) {
+    // Sterowanie ruchomym obiektem
+    float move = 0.0f;
+    if (input & SIM_INPUT_FORWARD) move += MOVING_OBJECT_SPEED * step;
+    if (input & SIM_INPUT_BACK) move -= MOVING_OBJECT_SPEED * step;
+    state.movingObjectPos.x += std::sin(glm::radians(state.movingObjectAngle)) * move;
+    state.movingObjectPos.z += std::cos(glm::radians(state.movingObjectAngle)) * move;
+    if (input & SIM_INPUT_TURN_LEFT) state.movingObjectAngle += MOVING_OBJECT_TURN_SPEED * step;
+    if (input & SIM_INPUT_TURN_RIGHT) state.movingObjectAngle -= MOVING_OBJECT_TURN_SPEED * step;
+
+    // Sterowanie kierunkiem reflektora
+    if (input & SIM_INPUT_SPOT_LEFT) state.spotlightYaw += SPOTLIGHT_YAW_SPEED * step;
+    if (input & SIM_INPUT_SPOT_RIGHT) state.spotlightYaw -= SPOTLIGHT_YAW_SPEED * step;
+    if (input & SIM_INPUT_SPOT_UP) {
+        state.spotlightPitch = std::min(state.spotlightPitch + SPOTLIGHT_PITCH_SPEED * step, SPOTLIGHT_PITCH_LIMIT);
+    }
+    if (input & SIM_INPUT_SPOT_DOWN) {
+        state.spotlightPitch = std::max(state.spotlightPitch - SPOTLIGHT_PITCH_SPEED * step, -SPOTLIGHT_PITCH_LIMIT);
+    }
+
+    // Pora dnia: skok z klawisza N albo plynna zmiana
+    if (commands & SIM_COMMAND_TOGGLE_DAY_NIGHT) {
+        state.dayNightFactor = (state.dayNightFactor > 0.5f) ? 0.0f : 1.0f;
+    }
+    if (input & SIM_INPUT_DAY) state.dayNightFactor = std::min(state.dayNightFactor + DAY_NIGHT_SPEED * step, 1.0f);
+    if (input & SIM_INPUT_NIGHT) state.dayNightFactor = std::max(state.dayNightFactor - DAY_NIGHT_SPEED * step, 0.0f);
+
+    state.time += step;
+}
+
+// Katy nie sa zawijane (rosna przy obrocie), wiec interpolacja liniowa wystarcza
+inline SimulationState interpolateSimulation(const SimulationState& a, const SimulationState& b, float t) {
+    SimulationState state;
+    state.movingObjectPos = glm::mix(a.movingObjectPos, b.movingObjectPos, t);
+    state.movingObjectAngle = glm::mix(a.movingObjectAngle, b.movingObjectAngle, t);
+    state.spotlightYaw = glm::mix(a.spotlightYaw, b.spotlightYaw, t);
+    state.spotlightPitch = glm::mix(a.spotlightPitch, b.spotlightPitch, t);
+    state.dayNightFactor = glm::mix(a.dayNightFactor, b.dayNightFactor, t);
+    state.time = a.time + (b.time - a.time) * t;
+    return state;
+}
+
+// Potrojny bufor jednego producenta i jednego konsumenta bez blokad: producent
+// pisze do wlasnego bufora i wymienia go z posrednim, konsument zabiera
+// posredni tylko gdy jest nowszy. Zaden nie czeka na drugiego, a konsument
+// zawsze czyta kompletny snapshot.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), writeIndex(0), readIndex(2) {}
+
+    // Przed startem producenta - wszystkie bufory z ta sama wartoscia
+    void reset(const T& value) {
+        for (T& buffer : buffers) buffer = value;
+        middle.store(1);
+        writeIndex = 0;
+        readIndex = 2;
+    }
+
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    void publish() {
+        writeIndex = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Przejmuje najnowszy opublikowany bufor; false - brak nowego
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const unsigned int INDEX_MASK = 3;
+    static const unsigned int FRESH = 4;
+
+    T buffers[3];
+    std::atomic<unsigned int> middle;   // indeks posredniego bufora | FRESH
+    unsigned int writeIndex;            // tylko producent
+    unsigned int readIndex;             // tylko konsument
+};
+
+class SimulationThread {
+public:
+    SimulationThread() : input(0), commands(0), stopRequested(false), tickSeconds(0.0) {}
+    ~SimulationThread() { stop(); }
+
+    void start(const SimulationState& initial, int tickRate) {
+        stop();
+        tickSeconds = 1.0 / std::max(tickRate, 1);
+        state = initial;
+        Snapshot snapshot;
+        snapshot.previous = snapshot.current = initial;
+        snapshot.publishTime = Clock::now();
+        snapshots.reset(snapshot);
+        input.store(0);
+        commands.store(0);
+        stopRequested.store(false);
+        thread = std::thread(&SimulationThread::run, this);
+    }
+
+    void stop() {
+        if (!thread.joinable()) return;
+        stopRequested.store(true);
+        thread.join();
+    }
+
+    bool running() const { return thread.joinable(); }
+
+    // Wywolywane z watku okna
+    void setInput(unsigned int mask) { input.store(mask, std::memory_order_relaxed); }
+    void post(SimulationCommand command) { commands.fetch_or(command, std::memory_order_relaxed); }
+
+    // Stan na chwile obecna minus jeden takt - interpolacja miedzy dwoma
+    // ostatnimi taktami (tylko watek renderowania)
+    SimulationState sample() {
+        snapshots.update();
+        const Snapshot& snapshot = snapshots.readBuffer();
+        double since = std::chrono::duration<double>(Clock::now() - snapshot.publishTime).count();
+        float t = (float)std::min(std::max(since / tickSeconds, 0.0), 1.0);
+        return interpolateSimulation(snapshot.previous, snapshot.current, t);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Snapshot {
+        SimulationState previous;
+        SimulationState current;
+        Clock::time_point publishTime;   // planowa chwila taktu
+    };
+
+    void run() {
+        const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(tickSeconds));
+        const Clock::duration maxLag = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(SIMULATION_MAX_LAG));
+        Clock::time_point due = Clock::now();
+
+        while (!stopRequested.load()) {
+            due += period;
+            std::this_thread::sleep_until(due);
+            // Po dlugim wstrzymaniu (np. debugger) bez nadrabiania setek taktow
+            Clock::time_point now = Clock::now();
+            if (now - due > maxLag) due = now;
+
+            Snapshot& snapshot = snapshots.writeBuffer();
+            snapshot.previous = state;
+            stepSimulation(state, input.load(std::memory_order_relaxed),
+                           commands.exchange(0, std::memory_order_relaxed), (float)tickSeconds);
+            snapshot.current = state;
+            snapshot.publishTime = due;
+            snapshots.publish();
+        }
+    }
+
+    TripleBuffer<Snapshot> snapshots;
+    SimulationState state;              // tylko watek symulacji
+    std::atomic<unsigned int> input;
+    std::atomic<unsigned int> commands;
+    std::atomic<bool> stopRequested;
+    double tickSeconds;
+    std::thread thread;
+};
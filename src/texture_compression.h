@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ============== OBRAZY TEKSTUR: DEKODOWANIE, MIPMAPY, KOMPRESJA BC ==============
+// Czesc przygotowania tekstur wykonywana w watkach roboczych (bez GL):
+//   - dekodowanie PPM (P6) i TGA (typ 2 i 10, 24/32 bity) do RGBA8,
+//   - lancuch mipmap filtrem pudelkowym 2x2 az do 1x1,
+//   - kompresja blokowa 4x4: BC1 (RGB, 8 B na blok) i BC3 (RGBA, 16 B).
+// Koder BC1 to dopasowanie prostopadloscianu otaczajacego (van Waveren,
+// "Real-Time DXT Compression") z przekatna wybrana wg kowariancji - szybki,
+// jakosc wystarczajaca dla tekstur rozproszonych. BC7 tylko z gotowych plikow
+// .tex z zewnetrznego narzedzia (texture_streaming.h) - tu go nie kodujemy.
+
+enum TextureFormat {
+    TEXTURE_FORMAT_RGBA8 = 0,   // bez kompresji (brak S3TC w sterowniku)
+    TEXTURE_FORMAT_BC1 = 1,
+    TEXTURE_FORMAT_BC3 = 2,
+    TEXTURE_FORMAT_BC7 = 3
+};
+
+inline const char* textureFormatName(TextureFormat format) {
+    static const char* names[] = {"RGBA8", "BC1", "BC3", "BC7"};
+    return names[format];
+}
+
+inline bool isBlockCompressed(TextureFormat format) { return format != TEXTURE_FORMAT_RGBA8; }
+
+// Bajty na blok 4x4 (RGBA8 - na piksel)
+inline size_t textureBlockBytes(TextureFormat format) {
+    return format == TEXTURE_FORMAT_RGBA8 ? 4 : (format == TEXTURE_FORMAT_BC1 ? 8 : 16);
+}
+
+inline size_t textureLevelBytes(TextureFormat format, int width, int height) {
+    if (!isBlockCompressed(format)) return (size_t)width * height * 4;
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * textureBlockBytes(format);
+}
+
+// Bajty jednego wiersza blokow (RGBA8 - wiersza pikseli)
+inline size_t textureRowBytes(TextureFormat format, int width) {
+    if (!isBlockCompressed(format)) return (size_t)width * 4;
+    return (size_t)((width + 3) / 4) * textureBlockBytes(format);
+}
+
+struct TextureImage {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> rgba;   // wiersze od gory, 4 B na piksel
+};
+
+// ---------- dekodowanie ----------
+
+inline bool readImageFile(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Token naglowka PPM (komentarze # do konca linii)
+inline bool readPpmNumber(const std::vector<unsigned char>& bytes, size_t& p, int& value) {
+    while (p < bytes.size()) {
+        if (bytes[p] == '#') {
+            while (p < bytes.size() && bytes[p] != '\n') ++p;
+        } else if (bytes[p] == ' ' || bytes[p] == '\t' || bytes[p] == '\r' || bytes[p] == '\n') {
+            ++p;
+        } else {
+            break;
+        }
+    }
+    if (p >= bytes.size() || bytes[p] < '0' || bytes[p] > '9') return false;
+    value = 0;
+    while (p < bytes.size() && bytes[p] >= '0' && bytes[p] <= '9') value = value * 10 + (bytes[p++] - '0');
+    return true;
+}
+
+inline bool decodePpm(const std::vector<unsigned char>& bytes, TextureImage& image) {
+    if (bytes.size() < 2 || bytes[0] != 'P' || bytes[1] != '6') return false;
+    size_t p = 2;
+    int width, height, maxValue;
+    if (!readPpmNumber(bytes, p, width) || !readPpmNumber(bytes, p, height) || !readPpmNumber(bytes, p, maxValue)) {
+        return false;
+    }
+    ++p;   // jeden bialy znak przed danymi
+    if (width <= 0 || height <= 0 || maxValue != 255 || bytes.size() < p + (size_t)width * height * 3) return false;
+
+    image.width = width;
+    image.height = height;
+    image.rgba.resize((size_t)width * height * 4);
+    const unsigned char* src = bytes.data() + p;
+    for (size_t i = 0; i < (size_t)width * height; ++i) {
+        image.rgba[i * 4 + 0] = src[i * 3 + 0];
+        image.rgba[i * 4 + 1] = src[i * 3 + 1];
+        image.rgba[i * 4 + 2] = src[i * 3 + 2];
+        image.rgba[i * 4 + 3] = 255;
+    }
+    return true;
+}
+
+// TGA: typ 2 (bez kompresji) i 10 (RLE), piksele BGR(A)
+inline bool decodeTga(const std::vector<unsigned char>& bytes, TextureImage& image) {
+    if (bytes.size() < 18) return false;
+    int idLength = bytes[0], colorMapType = bytes[1], imageType = bytes[2];
+    int width = bytes[12] | (bytes[13] << 8);
+    int height = bytes[14] | (bytes[15] << 8);
+    int bitsPerPixel = bytes[16];
+    bool topDown = (bytes[17] & 0x20) != 0;
+    if (colorMapType != 0 || (imageType != 2 && imageType != 10) || (bitsPerPixel != 24 && bitsPerPixel != 32) ||
+        width <= 0 || height <= 0) {
+        return false;
+    }
+
+    size_t pixelBytes = bitsPerPixel / 8;
+    size_t pixelCount = (size_t)width * height;
+    size_t p = 18 + idLength;
+    std::vector<unsigned char> bgra(pixelCount * 4, 255);
+    auto readPixel = [&](size_t index) {
+        for (size_t c = 0; c < pixelBytes; ++c) bgra[index * 4 + c] = bytes[p + c];
+        p += pixelBytes;
+    };
+
+    if (imageType == 2) {
+        if (bytes.size() < p + pixelCount * pixelBytes) return false;
+        for (size_t i = 0; i < pixelCount; ++i) readPixel(i);
+    } else {
+        for (size_t i = 0; i < pixelCount;) {
+            if (p >= bytes.size()) return false;
+            int header = bytes[p++];
+            size_t count = std::min<size_t>((header & 0x7F) + 1, pixelCount - i);
+            bool run = (header & 0x80) != 0;
+            if (bytes.size() < p + (run ? 1 : count) * pixelBytes) return false;
+            for (size_t k = 0; k < count; ++k) {
+                if (run && k > 0) {
+                    std::memcpy(&bgra[(i + k) * 4], &bgra[i * 4], 4);
+                } else {
+                    readPixel(i + k);
+                }
+            }
+            i += count;
+        }
+    }
+
+    image.width = width;
+    image.height = height;
+    image.rgba.resize(pixelCount * 4);
+    for (int y = 0; y < height; ++y) {
+        int srcRow = topDown ? y : height - 1 - y;
+        for (int x = 0; x < width; ++x) {
+            const unsigned char* src = &bgra[((size_t)srcRow * width + x) * 4];
+            unsigned char* dst = &image.rgba[((size_t)y * width + x) * 4];
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            dst[3] = src[3];
+        }
+    }
+    return true;
+}
+
+// Format po rozszerzeniu pliku; false przy bledzie (komunikat na stderr)
+inline bool loadTextureImage(const std::string& path, TextureImage& image) {
+    std::vector<unsigned char> bytes;
+    if (!readImageFile(path, bytes)) {
+        std::cerr << "Nie mozna otworzyc tekstury: " << path << std::endl;
+        return false;
+    }
+    std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    for (char& c : extension) c = (char)std::tolower((unsigned char)c);
+    bool decoded = false;
+    if (extension == ".ppm") {
+        decoded = decodePpm(bytes, image);
+    } else if (extension == ".tga") {
+        decoded = decodeTga(bytes, image);
+    } else {
+        std::cerr << "Nieobslugiwany format tekstury (PPM P6, TGA): " << path << std::endl;
+        return false;
+    }
+    if (!decoded) std::cerr << "Blad dekodowania tekstury: " << path << std::endl;
+    return decoded;
+}
+
+// ---------- mipmapy ----------
+
+// Poziom 0 to obraz zrodlowy; wymiary nieparzyste - ostatni wiersz/kolumna
+// zrodla wchodzi do dwoch pikseli (zaciskanie)
+inline std::vector<TextureImage> generateMipChain(TextureImage base) {
+    std::vector<TextureImage> levels;
+    levels.push_back(std::move(base));
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        const TextureImage& src = levels.back();
+        TextureImage dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.rgba.resize((size_t)dst.width * dst.height * 4);
+        for (int y = 0; y < dst.height; ++y) {
+            int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src.rgba[((size_t)y0 * src.width + x0) * 4 + c] +
+                              src.rgba[((size_t)y0 * src.width + x1) * 4 + c] +
+                              src.rgba[((size_t)y1 * src.width + x0) * 4 + c] +
+                              src.rgba[((size_t)y1 * src.width + x1) * 4 + c];
+                    dst.rgba[((size_t)y * dst.width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        levels.push_back(std::move(dst));
+    }
+    return levels;
+}
+
+inline bool hasTranslucentPixels(const TextureImage& image) {
+    for (size_t i = 3; i < image.rgba.size(); i += 4) {
+        if (image.rgba[i] != 255) return true;
+    }
+    return false;
+}
+
+// ---------- kompresja BC1/BC3 ----------
+
+inline uint16_t packColor565(const unsigned char* color) {
+    return (uint16_t)(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+inline void unpackColor565(uint16_t packed, int* color) {
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// block - 16 pikseli RGBA (wiersze od gory); out - 8 B, zawsze tryb 4 kolorow
+inline void compressBC1Block(const unsigned char* block, unsigned char* out) {
+    int minColor[3] = {255, 255, 255}, maxColor[3] = {0, 0, 0};
+    int mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            minColor[c] = std::min(minColor[c], (int)block[i * 4 + c]);
+            maxColor[c] = std::max(maxColor[c], (int)block[i * 4 + c]);
+            mean[c] += block[i * 4 + c];
+        }
+    }
+    // Przekatna prostopadloscianu zgodna ze znakiem kowariancji G i B wzgledem R
+    int covarianceG = 0, covarianceB = 0;
+    for (int i = 0; i < 16; ++i) {
+        int r = block[i * 4] * 16 - mean[0];
+        covarianceG += r * (block[i * 4 + 1] * 16 - mean[1]);
+        covarianceB += r * (block[i * 4 + 2] * 16 - mean[2]);
+    }
+    if (covarianceG < 0) std::swap(minColor[1], maxColor[1]);
+    if (covarianceB < 0) std::swap(minColor[2], maxColor[2]);
+    // Wciecie o 1/16 zakresu - konce palety blizej wiekszosci pikseli
+    unsigned char endpoints[2][3];
+    for (int c = 0; c < 3; ++c) {
+        int inset = (maxColor[c] - minColor[c]) / 16;
+        endpoints[0][c] = (unsigned char)std::min(std::max(maxColor[c] - inset, 0), 255);
+        endpoints[1][c] = (unsigned char)std::min(std::max(minColor[c] + inset, 0), 255);
+    }
+
+    uint16_t color0 = packColor565(endpoints[0]);
+    uint16_t color1 = packColor565(endpoints[1]);
+    if (color0 < color1) std::swap(color0, color1);
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        unpackColor565(color0, palette[0]);
+        unpackColor565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDistance = 1 << 30;
+            for (int k = 0; k < 4; ++k) {
+                int distance = 0;
+                for (int c = 0; c < 3; ++c) {
+                    int d = block[i * 4 + c] - palette[k][c];
+                    distance += d * d;
+                }
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = k;
+                }
+            }
+            indices |= (uint32_t)best << (i * 2);
+        }
+    }
+    out[0] = (unsigned char)(color0 & 0xFF);
+    out[1] = (unsigned char)(color0 >> 8);
+    out[2] = (unsigned char)(color1 & 0xFF);
+    out[3] = (unsigned char)(color1 >> 8);
+    for (int i = 0; i < 4; ++i) out[4 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+// Blok alfy BC3 (8 B): dwa konce i 16 indeksow 3-bitowych, tryb 8 wartosci
+inline void compressBC3AlphaBlock(const unsigned char* block, unsigned char* out) {
+    int alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < 16; ++i) {
+        alpha0 = std::max(alpha0, (int)block[i * 4 + 3]);
+        alpha1 = std::min(alpha1, (int)block[i * 4 + 3]);
+    }
+    uint64_t indices = 0;
+    if (alpha0 != alpha1) {
+        int palette[8] = {alpha0, alpha1};
+        for (int k = 1; k < 7; ++k) palette[k + 1] = ((7 - k) * alpha0 + k * alpha1) / 7;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDistance = 256;
+            for (int k = 0; k < 8; ++k) {
+                int distance = std::abs(block[i * 4 + 3] - palette[k]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = k;
+                }
+            }
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+    out[0] = (unsigned char)alpha0;
+    out[1] = (unsigned char)alpha1;
+    for (int i = 0; i < 6; ++i) out[2 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+// Poziom do formatu docelowego (RGBA8 - kopia); bloki na krawedziach
+// uzupelnione powieleniem ostatniego wiersza/kolumny
+inline std::vector<unsigned char> compressTextureLevel(const TextureImage& image, TextureFormat format) {
+    if (!isBlockCompressed(format)) return image.rgba;
+
+    std::vector<unsigned char> out(textureLevelBytes(format, image.width, image.height));
+    size_t blockBytes = textureBlockBytes(format);
+    unsigned char* dst = out.data();
+    unsigned char block[64];
+    for (int by = 0; by < image.height; by += 4) {
+        for (int bx = 0; bx < image.width; bx += 4) {
+            for (int y = 0; y < 4; ++y) {
+                int sy = std::min(by + y, image.height - 1);
+                for (int x = 0; x < 4; ++x) {
+                    int sx = std::min(bx + x, image.width - 1);
+                    std::memcpy(&block[(y * 4 + x) * 4], &image.rgba[((size_t)sy * image.width + sx) * 4], 4);
+                }
+            }
+            if (format == TEXTURE_FORMAT_BC3) {
+                compressBC3AlphaBlock(block, dst);
+                compressBC1Block(block, dst + 8);
+            } else {
+                compressBC1Block(block, dst);
+            }
+            dst += blockBytes;
+        }
+    }
+    return out;
+}
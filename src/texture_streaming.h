@@ -0,0 +1,705 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mapped_file.h"
+#include "profiler.h"
+#include "shader_cache.h"
+#include "texture_compression.h"
+#include "worker_pool.h"
+
+// ============== STRUMIENIOWANIE TEKSTUR ==============
+// load() tylko kolejkuje plik - dekodowanie, mipmapy i kompresja BC ida
+// w tle we wlasnej puli watkow (WorkerPool::post), a wynik trafia do cache tekstur (texture_cache/, plik
+// .tex z gotowymi poziomami). Kolejne uruchomienie mapuje plik (mmap) bez
+// dekodowania; pliki .tex podane wprost (np. BC7 z zewnetrznego narzedzia)
+// sa wczytywane tak samo.
+// update() raz na klatke wysyla poziomy przez bufor PBO podzielony na
+// TEXTURE_UPLOAD_REGIONS obszarow (fence na obszar, jak DynamicBuffer):
+// najpierw ogon mipmap (<= TEXTURE_TAIL_SIZE) - tekstura widoczna od razu,
+// potem coraz dokladniejsze poziomy, duze w pasach wierszy rozlozonych na
+// klatki. Watek renderowania nigdy nie czeka - gdy GPU nie oddalo obszaru,
+// wysylanie czeka do nastepnej klatki.
+// Pamiec poziomow liczona wzgledem budzetu: brak miejsca zwalnia najpierw
+// poziomy dokladniejsze niz zadane (request), potem tekstur dawno nie
+// zadanych; ogon zostaje zawsze.
+
+const size_t TEXTURE_BUDGET_DEFAULT = 256u << 20;
+const size_t TEXTURE_UPLOAD_BYTES_PER_FRAME = 4u << 20;   // obszar PBO na klatke
+const int TEXTURE_UPLOAD_REGIONS = 3;
+const int TEXTURE_TAIL_SIZE = 64;            // poziomy do 64x64 wysylane razem, nie zwalniane
+const unsigned int TEXTURE_LOADER_THREADS = 2;
+const uint64_t TEXTURE_STALE_FRAMES = 120;   // tyle klatek bez request() - do zwolnienia
+
+struct CookedTextureLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;   // od poczatku pliku
+    uint64_t bytes;
+};
+
+// ============== CACHE SKOMPRESOWANYCH TEKSTUR ==============
+// Plik: FileHeader, CookedTextureLevel x levelCount, dane poziomow od 0.
+class CookedTextureCache {
+public:
+    explicit CookedTextureCache(const std::string& directory = "texture_cache")
+        : directory(directory), enabled(true) {}
+
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled; }
+
+    // FNV-1a (64 bit) z identyfikacji zrodla i dostepnosci kompresji
+    uint64_t makeKey(const std::string& sourcePath, bool compressed) const {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= ((const unsigned char*)data)[i];
+                hash *= 1099511628211ull;
+            }
+        };
+        std::error_code ec;
+        std::string path = std::filesystem::absolute(sourcePath, ec).string();
+        uint64_t fileSize = (uint64_t)std::filesystem::file_size(sourcePath, ec);
+        int64_t modified = (int64_t)std::filesystem::last_write_time(sourcePath, ec).time_since_epoch().count();
+        mix(path.data(), path.size());
+        mix(&fileSize, sizeof(fileSize));
+        mix(&modified, sizeof(modified));
+        mix(&compressed, sizeof(compressed));
+        return hash;
+    }
+
+    std::string pathFor(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.tex", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+
+    // Mapuje plik z cache; uszkodzony lub niepasujacy jest usuwany
+    bool open(uint64_t key, MappedFile& file, TextureFormat& format, std::vector<CookedTextureLevel>& levels) {
+        if (!enabled) return false;
+        std::string path = pathFor(key);
+        if (!file.open(path)) return false;
+        if (openMapped(file, &key, format, levels)) return true;
+        file.close();
+        std::cerr << "Cache tekstur: odrzucono " << path << std::endl;
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return false;
+    }
+
+    // Plik .tex podany wprost (klucz nie jest sprawdzany)
+    static bool openFile(const std::string& path, MappedFile& file, TextureFormat& format,
+                         std::vector<CookedTextureLevel>& levels) {
+        if (!file.open(path)) return false;
+        if (openMapped(file, NULL, format, levels)) return true;
+        file.close();
+        return false;
+    }
+
+    // Zapis przez wlasny plik tymczasowy + rename (jak w CookedMeshCache)
+    bool store(uint64_t key, TextureFormat format, const std::vector<TextureImage>& mips,
+               const std::vector<std::vector<unsigned char>>& data) {
+        if (!enabled || mips.empty()) return false;
+
+        FileHeader header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.key = key;
+        header.format = (uint32_t)format;
+        header.levelCount = (uint32_t)mips.size();
+
+        std::vector<CookedTextureLevel> levels(mips.size());
+        uint64_t offset = sizeof(header) + levels.size() * sizeof(CookedTextureLevel);
+        for (size_t i = 0; i < mips.size(); ++i) {
+            levels[i].width = (uint32_t)mips[i].width;
+            levels[i].height = (uint32_t)mips[i].height;
+            levels[i].offset = offset;
+            levels[i].bytes = data[i].size();
+            offset += data[i].size();
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) return false;
+
+        std::string path = pathFor(key);
+        std::string tmpPath = cacheTempPath(path);
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(CookedTextureLevel));
+            for (const std::vector<unsigned char>& level : data) {
+                file.write(reinterpret_cast<const char*>(level.data()), level.size());
+            }
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(tmpPath, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const uint32_t MAGIC = 0x58544b47;   // "GKTX"
+    static const uint32_t VERSION = 1;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t levelCount;
+    };
+
+    // Naglowek i tablica poziomow: wymiary kolejnych poziomow, rozmiary
+    // zgodne z formatem i dane w granicach pliku
+    static bool openMapped(const MappedFile& file, const uint64_t* key, TextureFormat& format,
+                           std::vector<CookedTextureLevel>& levels) {
+        FileHeader header;
+        if (file.size() < sizeof(header)) return false;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != MAGIC || header.version != VERSION || (key && header.key != *key) ||
+            header.format > TEXTURE_FORMAT_BC7 || header.levelCount < 1 || header.levelCount > 32 ||
+            file.size() < sizeof(header) + header.levelCount * sizeof(CookedTextureLevel)) {
+            return false;
+        }
+        format = (TextureFormat)header.format;
+        levels.resize(header.levelCount);
+        std::memcpy(levels.data(), file.data() + sizeof(header), levels.size() * sizeof(CookedTextureLevel));
+        for (size_t i = 0; i < levels.size(); ++i) {
+            const CookedTextureLevel& level = levels[i];
+            if (level.width == 0 || level.height == 0 ||
+                level.bytes != textureLevelBytes(format, (int)level.width, (int)level.height) ||
+                level.offset + level.bytes > file.size()) {
+                return false;
+            }
+            if (i > 0 && (level.width != std::max(1u, levels[i - 1].width / 2) ||
+                          level.height != std::max(1u, levels[i - 1].height / 2))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string directory;
+    bool enabled;
+};
+
+// Wspolny cache tekstur (jak cookedMeshCache)
+inline CookedTextureCache& cookedTextureCache() {
+    static CookedTextureCache cache;
+    return cache;
+}
+
+// ============== STRUMIENIOWANIE ==============
+class TextureStreamer {
+public:
+    TextureStreamer()
+        : uploadBuffer(0), staging(NULL), fences(), region(0), frame(0), budgetBytes(TEXTURE_BUDGET_DEFAULT), residentTotal(0),
+          s3tcSupported(false), bptcSupported(false), loaders(TEXTURE_LOADER_THREADS + 1) {}
+    ~TextureStreamer() { loaders.cancelPosted(); }
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Wymaga kontekstu GL: formaty sterownika, bufor PBO i watki robocze
+    bool init(size_t budget) {
+        budgetBytes = budget;
+        s3tcSupported = GLEW_EXT_texture_compression_s3tc != 0;
+        bptcSupported = GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+        if (!s3tcSupported) std::cerr << "Brak S3TC - tekstury bez kompresji (RGBA8)" << std::endl;
+
+        glGenBuffers(1, &uploadBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)(TEXTURE_UPLOAD_BYTES_PER_FRAME * TEXTURE_UPLOAD_REGIONS),
+                     NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return glGetError() == GL_NO_ERROR;
+    }
+
+    void setBudget(size_t bytes) { budgetBytes = bytes; }
+
+    // Kolejkuje plik (PPM, TGA albo gotowy .tex); uchwyt wazny od razu -
+    // do wyslania pierwszych poziomow texture() zwraca 0
+    int load(const std::string& path) {
+        std::unique_ptr<Entry> entry(new Entry());
+        entry->path = path;
+        entry->name = std::filesystem::path(path).filename().string();
+        Entry* job = entry.get();
+        entries.push_back(std::move(entry));
+        loaders.post([this, job]() {
+            job->state.store(cook(*job) ? ENTRY_READY : ENTRY_FAILED, std::memory_order_release);
+        });
+        return (int)entries.size() - 1;
+    }
+
+    // Najdokladniejszy potrzebny poziom w tej klatce (0 - pelna rozdzielczosc);
+    // kilka zadan w klatce - wygrywa najdokladniejszy
+    void request(int handle, int finestLevel) {
+        if (handle < 0 || handle >= (int)entries.size()) return;
+        Entry& entry = *entries[handle];
+        finestLevel = std::max(finestLevel, 0);
+        entry.wantedLevel = entry.lastRequest == frame ? std::min(entry.wantedLevel, finestLevel) : finestLevel;
+        entry.lastRequest = frame;
+    }
+
+    // Poziom, na ktorym tekstel odpowiada pikselowi, gdy szerokosc tekstury
+    // zajmuje pixels pikseli ekranu (przed wczytaniem - 0)
+    int levelForScreenSize(int handle, float pixels) const {
+        if (handle < 0 || handle >= (int)entries.size()) return 0;
+        const Entry& entry = *entries[handle];
+        if (entry.state.load(std::memory_order_acquire) != ENTRY_READY) return 0;
+        float texelsPerPixel = (float)entry.levels[0].width / std::max(pixels, 1.0f);
+        return std::max(0, (int)std::floor(std::log2(std::max(texelsPerPixel, 1.0f))));
+    }
+
+    // 0 - brak wyslanych poziomow (rysujacy wiaze teksture domyslna)
+    GLuint texture(int handle) const {
+        if (handle < 0 || handle >= (int)entries.size()) return 0;
+        const Entry& entry = *entries[handle];
+        if (entry.state.load(std::memory_order_acquire) != ENTRY_READY) return 0;
+        return entry.residentLevel < entry.levelCount() ? entry.texture : 0;
+    }
+
+    size_t residentBytes() const { return residentTotal; }
+    size_t budget() const { return budgetBytes; }
+
+    bool loading() const {
+        for (const std::unique_ptr<Entry>& entry : entries) {
+            if (entry->state.load(std::memory_order_acquire) == ENTRY_QUEUED) return true;
+        }
+        return false;
+    }
+
+    // Raz na klatke, przed rysowaniem; zwraca bajty wyslane w tej klatce.
+    // Zmienia wiazanie tekstury na jednostce 0.
+    size_t update() {
+        ++frame;
+        reportLoaded();
+
+        // Obszar PBO nastepnej klatki; GPU jeszcze go czyta - bez czekania
+        int next = (region + 1) % TEXTURE_UPLOAD_REGIONS;
+        if (fences[next]) {
+            GLenum status = glClientWaitSync(fences[next], 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) return 0;
+            glDeleteSync(fences[next]);
+            fences[next] = 0;
+        }
+
+        // Nadmiar ponad budzet (np. po zmianie budzetu) - zwalnianie od razu
+        makeRoom(0, NULL);
+
+        // Kolejnosc: brakujacy ogon, potem najwiekszy brak wzgledem zadanego poziomu
+        std::vector<Entry*> order;
+        for (const std::unique_ptr<Entry>& entry : entries) {
+            if (entry->state.load(std::memory_order_acquire) == ENTRY_READY && needsUpload(*entry)) {
+                order.push_back(entry.get());
+            }
+        }
+        std::sort(order.begin(), order.end(), [](const Entry* a, const Entry* b) {
+            bool aTail = a->residentLevel > a->tailLevel, bTail = b->residentLevel > b->tailLevel;
+            if (aTail != bTail) return aTail;
+            return a->residentLevel - a->wantedLevel > b->residentLevel - b->wantedLevel;
+        });
+
+        if (order.empty()) return 0;
+
+        // Pasy kopiowane do zmapowanego obszaru juz przy planowaniu; przydzialy
+        // poziomow (dane NULL) w tym czasie bez podpietego PBO
+        size_t regionOffset = (size_t)next * TEXTURE_UPLOAD_BYTES_PER_FRAME;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+        staging = static_cast<unsigned char*>(
+            glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, (GLintptr)regionOffset, (GLsizeiptr)TEXTURE_UPLOAD_BYTES_PER_FRAME,
+                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!staging) return 0;
+
+        std::vector<Upload> uploads;
+        size_t regionBytes = 0;
+        for (Entry* entry : order) {
+            if (!planUploads(*entry, uploads, regionBytes)) break;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        staging = NULL;
+        if (uploads.empty()) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return 0;
+        }
+        region = next;
+
+        for (const Upload& upload : uploads) {
+            Entry& entry = *upload.entry;
+            const CookedTextureLevel& level = entry.levels[upload.level];
+            glBindTexture(GL_TEXTURE_2D, entry.texture);
+            const void* offset = (const void*)(regionOffset + upload.bufferOffset);
+            if (isBlockCompressed(entry.format)) {
+                glCompressedTexSubImage2D(GL_TEXTURE_2D, upload.level, 0, upload.y, (GLsizei)level.width,
+                                          upload.height, glFormat(entry.format), (GLsizei)upload.bytes, offset);
+            } else {
+                glTexSubImage2D(GL_TEXTURE_2D, upload.level, 0, upload.y, (GLsizei)level.width, upload.height,
+                                GL_RGBA, GL_UNSIGNED_BYTE, offset);
+            }
+            // Ostatni pas poziomu - poziom gotowy do probkowania
+            if (upload.completesLevel) glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, upload.level);
+            countStateChange();
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return regionBytes;
+    }
+
+    // Blokujaco: do wczytania plikow i wyslania zadanych poziomow (benchmark -
+    // pomiar bez strumieniowania w tle)
+    void finish() {
+        for (;;) {
+            // Wszystkie wpisy traktowane jak zadane - bez zwalniania nieuzywanych
+            for (std::unique_ptr<Entry>& entry : entries) entry->lastRequest = frame + 1;
+            bool pending = loading();
+            size_t sent = update();
+            glFinish();
+            if (!pending && sent == 0) break;
+            if (sent == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void destroy() {
+        // Niewczytane pliki zostaja w ENTRY_QUEUED - niszczone razem z wpisami
+        loaders.cancelPosted();
+        for (std::unique_ptr<Entry>& entry : entries) {
+            if (entry->texture) glDeleteTextures(1, &entry->texture);
+        }
+        entries.clear();
+        for (GLsync& fence : fences) {
+            if (fence) glDeleteSync(fence);
+            fence = 0;
+        }
+        glDeleteBuffers(1, &uploadBuffer);
+        uploadBuffer = 0;
+        residentTotal = 0;
+    }
+
+private:
+    enum EntryState { ENTRY_QUEUED, ENTRY_READY, ENTRY_FAILED };
+
+    struct Entry {
+        std::string path, name;
+        std::atomic<int> state{ENTRY_QUEUED};
+
+        // Wynik watku roboczego - czytany dopiero po ENTRY_READY
+        MappedFile file;                        // plik .tex (mmap)
+        std::vector<unsigned char> memory;      // bez cache - poziomy w pamieci
+        const unsigned char* data = NULL;       // poczatek pliku lub memory (offsety poziomow)
+        TextureFormat format = TEXTURE_FORMAT_RGBA8;
+        std::vector<CookedTextureLevel> levels;
+        const char* origin = "";
+        double loadMs = 0.0;
+        bool reported = false;
+
+        // Stan GL (watek renderowania)
+        GLuint texture = 0;
+        int tailLevel = 0;          // pierwszy poziom ogona mipmap
+        int residentLevel = 0;      // najdokladniejszy kompletny poziom (levelCount - brak)
+        int allocatedLevel = 0;     // najdokladniejszy przydzielony (< residentLevel - w trakcie)
+        int uploadRow = 0;          // nastepny wiersz blokow poziomu w trakcie
+        int wantedLevel = 0;
+        uint64_t lastRequest = 0;
+
+        int levelCount() const { return (int)levels.size(); }
+    };
+
+    // Pas wierszy poziomu w obszarze PBO biezacej klatki
+    struct Upload {
+        Entry* entry;
+        int level;
+        int y, height;              // w pikselach
+        size_t bytes;
+        size_t bufferOffset;        // wzgledem poczatku obszaru
+        bool completesLevel;
+    };
+
+    static GLenum glFormat(TextureFormat format) {
+        switch (format) {
+            case TEXTURE_FORMAT_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case TEXTURE_FORMAT_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case TEXTURE_FORMAT_BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+            default: return GL_RGBA8;
+        }
+    }
+
+    bool formatSupported(TextureFormat format) const {
+        if (format == TEXTURE_FORMAT_BC7) return bptcSupported;
+        return format == TEXTURE_FORMAT_RGBA8 || s3tcSupported;
+    }
+
+    // ---------- watki robocze ----------
+
+    // Poziomy z cache albo dekodowanie + mipmapy + kompresja i zapis do cache
+    bool cook(Entry& entry) {
+        auto start = std::chrono::steady_clock::now();
+        CookedTextureCache& cache = cookedTextureCache();
+        bool opened = false;
+
+        if (entry.path.size() >= 4 && entry.path.compare(entry.path.size() - 4, 4, ".tex") == 0) {
+            opened = CookedTextureCache::openFile(entry.path, entry.file, entry.format, entry.levels);
+            if (!opened) {
+                std::cerr << "Nieprawidlowy plik tekstury: " << entry.path << std::endl;
+                return false;
+            }
+            entry.origin = "plik .tex";
+        } else {
+            uint64_t key = cache.makeKey(entry.path, s3tcSupported);
+            opened = cache.open(key, entry.file, entry.format, entry.levels);
+            if (opened) {
+                entry.origin = "z cache";
+            } else {
+                TextureImage image;
+                if (!loadTextureImage(entry.path, image)) return false;
+                entry.format = !s3tcSupported ? TEXTURE_FORMAT_RGBA8
+                                              : (hasTranslucentPixels(image) ? TEXTURE_FORMAT_BC3 : TEXTURE_FORMAT_BC1);
+                std::vector<TextureImage> mips = generateMipChain(std::move(image));
+                std::vector<std::vector<unsigned char>> data;
+                for (const TextureImage& mip : mips) data.push_back(compressTextureLevel(mip, entry.format));
+
+                opened = cache.store(key, entry.format, mips, data) &&
+                         cache.open(key, entry.file, entry.format, entry.levels);
+                if (opened) {
+                    entry.origin = "przygotowana, zapisana w cache";
+                } else {
+                    // Bez cache - poziomy jeden za drugim w pamieci
+                    entry.levels.clear();
+                    for (size_t i = 0; i < mips.size(); ++i) {
+                        CookedTextureLevel level = {(uint32_t)mips[i].width, (uint32_t)mips[i].height,
+                                                    (uint64_t)entry.memory.size(), (uint64_t)data[i].size()};
+                        entry.levels.push_back(level);
+                        entry.memory.insert(entry.memory.end(), data[i].begin(), data[i].end());
+                    }
+                    entry.origin = "przygotowana";
+                }
+            }
+        }
+        if (!formatSupported(entry.format)) {
+            std::cerr << "Tekstura " << entry.name << ": format " << textureFormatName(entry.format)
+                      << " nieobslugiwany przez sterownik" << std::endl;
+            return false;
+        }
+        entry.data = opened ? (const unsigned char*)entry.file.data() : entry.memory.data();
+
+        // Strony mapowania wczytane tutaj - memcpy do PBO w watku renderowania
+        // nie trafia na odczyt z dysku
+        if (opened) {
+            volatile unsigned char sink = 0;
+            for (size_t offset = 0; offset < entry.file.size(); offset += 4096) sink ^= entry.data[offset];
+            (void)sink;
+        }
+
+        int levelCount = entry.levelCount();
+        entry.tailLevel = levelCount - 1;
+        while (entry.tailLevel > 0 &&
+               (int)std::max(entry.levels[entry.tailLevel - 1].width, entry.levels[entry.tailLevel - 1].height) <=
+                   TEXTURE_TAIL_SIZE) {
+            --entry.tailLevel;
+        }
+        entry.residentLevel = entry.allocatedLevel = levelCount;
+        entry.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    void reportLoaded() {
+        for (const std::unique_ptr<Entry>& entry : entries) {
+            if (entry->reported) continue;
+            int state = entry->state.load(std::memory_order_acquire);
+            if (state == ENTRY_QUEUED) continue;
+            entry->reported = true;
+            if (state == ENTRY_FAILED) continue;
+            std::cout << "Tekstura " << entry->name << ": " << textureFormatName(entry->format) << " "
+                      << entry->levels[0].width << "x" << entry->levels[0].height << ", " << entry->levelCount()
+                      << " poziomow, " << entry->origin << " (" << entry->loadMs << " ms)" << std::endl;
+        }
+    }
+
+    // ---------- wysylanie i budzet ----------
+
+    bool isStale(const Entry& entry) const { return frame - entry.lastRequest > TEXTURE_STALE_FRAMES; }
+
+    // Tekstury niezadane dostaja tylko ogon - nie zajmuja obszaru ani budzetu
+    bool needsUpload(const Entry& entry) const {
+        if (entry.residentLevel > entry.tailLevel) return true;
+        return !isStale(entry) && (entry.allocatedLevel < entry.residentLevel || entry.residentLevel > entry.wantedLevel);
+    }
+
+    size_t levelBytes(const Entry& entry, int level) const { return (size_t)entry.levels[level].bytes; }
+
+    // Przydzial pamieci poziomu (dane NULL) - pasy dochodza przez PBO
+    void allocateLevel(Entry& entry, int level) {
+        if (!entry.texture) {
+            glGenTextures(1, &entry.texture);
+            glBindTexture(GL_TEXTURE_2D, entry.texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry.levelCount() - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.levelCount() - 1);
+        } else {
+            glBindTexture(GL_TEXTURE_2D, entry.texture);
+        }
+        const CookedTextureLevel& info = entry.levels[level];
+        if (isBlockCompressed(entry.format)) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, glFormat(entry.format), (GLsizei)info.width,
+                                   (GLsizei)info.height, 0, (GLsizei)info.bytes, NULL);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, (GLsizei)info.width, (GLsizei)info.height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, NULL);
+        }
+        entry.allocatedLevel = level;
+        entry.uploadRow = 0;
+        residentTotal += levelBytes(entry, level);
+    }
+
+    // Zwalnia najdokladniejszy przydzielony poziom spoza ogona
+    void evictFinest(Entry& entry) {
+        int level = entry.allocatedLevel;
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        if (level == entry.residentLevel) {
+            entry.residentLevel = level + 1;
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry.residentLevel);
+        }
+        // Poziom 0x0 poza zakresem BASE..MAX - sterownik zwalnia jego pamiec
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        entry.allocatedLevel = level + 1;
+        entry.uploadRow = 0;
+        residentTotal -= levelBytes(entry, level);
+    }
+
+    // Miejsce na bytes w budzecie kosztem poziomow zbednych (dokladniejszych
+    // niz zadane), potem tekstur niezadanych od TEXTURE_STALE_FRAMES klatek -
+    // najdawniej zadane najpierw. Poziomy potrzebne w tej klatce zostaja.
+    bool makeRoom(size_t bytes, const Entry* requester) {
+        while (residentTotal + bytes > budgetBytes) {
+            Entry* victim = NULL;
+            bool victimSurplus = false;
+            for (const std::unique_ptr<Entry>& candidate : entries) {
+                Entry* entry = candidate.get();
+                if (entry == requester || entry->state.load(std::memory_order_acquire) != ENTRY_READY ||
+                    entry->allocatedLevel >= entry->tailLevel) {
+                    continue;
+                }
+                bool surplus = entry->allocatedLevel < entry->wantedLevel;
+                bool stale = isStale(*entry);
+                if (!surplus && !stale) continue;
+                if (!victim || (surplus && !victimSurplus) ||
+                    (surplus == victimSurplus && entry->lastRequest < victim->lastRequest)) {
+                    victim = entry;
+                    victimSurplus = surplus;
+                }
+            }
+            if (!victim) return false;
+            evictFinest(*victim);
+        }
+        return true;
+    }
+
+    // Pasy jednego wpisu w obszarze klatki; stan poziomow zmienia sie od razu
+    // (wysylanie w tej samej klatce). false - obszar pelny
+    bool planUploads(Entry& entry, std::vector<Upload>& uploads, size_t& regionBytes) {
+        for (;;) {
+            int level;
+            if (entry.allocatedLevel < entry.residentLevel) {
+                level = entry.allocatedLevel;   // poziom w trakcie
+            } else if (entry.residentLevel > entry.tailLevel) {
+                // Caly ogon w jednej klatce - tekstura kompletna od razu
+                size_t tailBytes = 0;
+                for (int i = entry.tailLevel; i < entry.levelCount(); ++i) tailBytes += levelBytes(entry, i) + 16;
+                if (regionBytes + tailBytes > TEXTURE_UPLOAD_BYTES_PER_FRAME) return false;
+                makeRoom(tailBytes, &entry);   // ogon wchodzi nawet ponad budzet
+                for (int i = entry.levelCount() - 1; i >= entry.tailLevel; --i) {
+                    allocateLevel(entry, i);
+                    addUpload(entry, i, 0, (int)entry.levels[i].height, uploads, regionBytes);
+                }
+                continue;
+            } else if (entry.residentLevel > entry.wantedLevel) {
+                level = entry.residentLevel - 1;
+                if (!makeRoom(levelBytes(entry, level), &entry)) return true;   // brak budzetu - inne wpisy
+                allocateLevel(entry, level);
+            } else {
+                return true;
+            }
+
+            // Pas pelnych wierszy blokow (RGBA8 - pikseli), ile zmiesci obszar
+            const CookedTextureLevel& info = entry.levels[level];
+            int rowHeight = isBlockCompressed(entry.format) ? 4 : 1;
+            int rows = ((int)info.height + rowHeight - 1) / rowHeight;
+            size_t rowBytes = textureRowBytes(entry.format, (int)info.width);
+            size_t offset = alignUpload(regionBytes);
+            if (offset >= TEXTURE_UPLOAD_BYTES_PER_FRAME) return false;
+            int fit = std::min(rows - entry.uploadRow, (int)((TEXTURE_UPLOAD_BYTES_PER_FRAME - offset) / rowBytes));
+            if (fit <= 0) return false;
+            int y = entry.uploadRow * rowHeight;
+            int height = std::min(fit * rowHeight, (int)info.height - y);
+            addUpload(entry, level, y, height, uploads, regionBytes);
+        }
+    }
+
+    void addUpload(Entry& entry, int level, int y, int height, std::vector<Upload>& uploads, size_t& regionBytes) {
+        const CookedTextureLevel& info = entry.levels[level];
+        int rowHeight = isBlockCompressed(entry.format) ? 4 : 1;
+        int firstRow = y / rowHeight;
+        int rowCount = (height + rowHeight - 1) / rowHeight;
+        size_t rowBytes = textureRowBytes(entry.format, (int)info.width);
+
+        Upload upload;
+        upload.entry = &entry;
+        upload.level = level;
+        upload.y = y;
+        upload.height = height;
+        upload.bytes = rowCount * rowBytes;
+        upload.bufferOffset = alignUpload(regionBytes);
+        upload.completesLevel = y + height >= (int)info.height;
+        std::memcpy(staging + upload.bufferOffset, entry.data + info.offset + firstRow * rowBytes, upload.bytes);
+        uploads.push_back(upload);
+        regionBytes = upload.bufferOffset + upload.bytes;
+
+        entry.uploadRow = firstRow + rowCount;
+        if (upload.completesLevel) entry.residentLevel = level;
+    }
+
+    static size_t alignUpload(size_t offset) { return (offset + 15) & ~(size_t)15; }
+
+    std::vector<std::unique_ptr<Entry>> entries;
+    unsigned int uploadBuffer;
+    unsigned char* staging;     // zmapowany obszar PBO w trakcie update()
+    GLsync fences[TEXTURE_UPLOAD_REGIONS];
+    int region;                 // obszar PBO ostatniego wysylania
+    uint64_t frame;
+    size_t budgetBytes;
+    size_t residentTotal;       // pamiec przydzielonych poziomow
+    bool s3tcSupported, bptcSupported;
+
+    // Ostatni skladnik - niszczony (watki zatrzymane) przed wpisami
+    WorkerPool loaders;
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORM_SIMD_WIDTH 8
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TRANSFORM_SIMD_WIDTH 4
+#else
+#define TRANSFORM_SIMD_WIDTH 1
+#endif
+
+// ============== TRANSFORMACJE (STRUKTURA TABLIC) ==============
+// Lokalne pozycje/rotacje/skale wezlow trzymane w osobnych tablicach (SoA),
+// hierarchia przez indeks rodzica. Po zmianie wezel dostaje flage dirty;
+// update() przelicza tylko zmienione wezly i ich potomkow:
+//   1. wybor wezlow do przeliczenia (rodzic zawsze ma mniejszy indeks),
+//   2. macierze lokalne z TRS - SIMD, 4 (SSE) lub 8 (AVX2) wezlow naraz,
+//   3. world = world(rodzica) * local i macierz normalnych.
+// Macierz normalnych bez ogolnego odwracania: przy skali jednorodnej
+// R*s -> R/s (dzielenie przez s^2), w pozostalych przypadkach dopelnienia
+// algebraiczne (iloczyny wektorowe kolumn) podzielone przez wyznacznik.
+
+// transpose(inverse(m)) przez macierz dopelnien - bez eliminacji Gaussa
+inline glm::mat3 cofactorNormalMatrix(const glm::mat3& m) {
+    glm::mat3 cofactor(glm::cross(m[1], m[2]), glm::cross(m[2], m[0]), glm::cross(m[0], m[1]));
+    float det = glm::dot(m[0], cofactor[0]);
+    return cofactor * (1.0f / det);
+}
+
+class TransformStore {
+public:
+    // Liczba wezlow przeliczonych w ostatnim update()
+    unsigned int updatedCount;
+
+    TransformStore() : updatedCount(0) {}
+
+    void reserve(size_t count) {
+        for (std::vector<float>* array : localArrays()) array->reserve(count);
+        parents.reserve(count);
+        dirty.reserve(count);
+        changed.reserve(count);
+        localMatrices.reserve(count);
+        worldMatrices.reserve(count);
+        normalMatrices.reserve(count);
+        worldScale.reserve(count);
+    }
+
+    // Rodzic musi byc dodany wczesniej - kolejnosc tablic jest kolejnoscia przeliczania
+    int addNode(const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                const glm::vec3& scale = glm::vec3(1.0f), int parent = -1) {
+        posX.push_back(position.x);
+        posY.push_back(position.y);
+        posZ.push_back(position.z);
+        rotX.push_back(rotation.x);
+        rotY.push_back(rotation.y);
+        rotZ.push_back(rotation.z);
+        rotW.push_back(rotation.w);
+        scaleX.push_back(scale.x);
+        scaleY.push_back(scale.y);
+        scaleZ.push_back(scale.z);
+        parents.push_back(parent < (int)parents.size() ? parent : -1);
+        dirty.push_back(1);
+        changed.push_back(0);
+        localMatrices.push_back(glm::mat4(1.0f));
+        worldMatrices.push_back(glm::mat4(1.0f));
+        normalMatrices.push_back(glm::mat3(1.0f));
+        worldScale.push_back(1.0f);
+        return (int)parents.size() - 1;
+    }
+
+    size_t size() const { return parents.size(); }
+
+    // Settery pomijaja zapis (i flage dirty) gdy wartosc sie nie zmienila
+    void setPosition(int node, const glm::vec3& position) {
+        if (posX[node] == position.x && posY[node] == position.y && posZ[node] == position.z) return;
+        posX[node] = position.x;
+        posY[node] = position.y;
+        posZ[node] = position.z;
+        dirty[node] = 1;
+    }
+
+    void setRotation(int node, const glm::quat& rotation) {
+        if (rotX[node] == rotation.x && rotY[node] == rotation.y &&
+            rotZ[node] == rotation.z && rotW[node] == rotation.w) return;
+        rotX[node] = rotation.x;
+        rotY[node] = rotation.y;
+        rotZ[node] = rotation.z;
+        rotW[node] = rotation.w;
+        dirty[node] = 1;
+    }
+
+    void setScale(int node, const glm::vec3& scale) {
+        if (scaleX[node] == scale.x && scaleY[node] == scale.y && scaleZ[node] == scale.z) return;
+        scaleX[node] = scale.x;
+        scaleY[node] = scale.y;
+        scaleZ[node] = scale.z;
+        dirty[node] = 1;
+    }
+
+    const glm::mat4& world(int node) const { return worldMatrices[node]; }
+    const glm::mat3& normalMatrix(int node) const { return normalMatrices[node]; }
+    glm::vec3 worldPosition(int node) const { return glm::vec3(worldMatrices[node][3]); }
+
+    void update() {
+        // 1. Wezly zmienione lub z przeliczonym rodzicem
+        pending.clear();
+        for (size_t i = 0; i < parents.size(); ++i) {
+            int parent = parents[i];
+            changed[i] = dirty[i] || (parent >= 0 && changed[parent]);
+            if (changed[i]) pending.push_back((int)i);
+            dirty[i] = 0;
+        }
+        updatedCount = (unsigned int)pending.size();
+        if (pending.empty()) return;
+
+        // 2. Macierze lokalne - paczkami po TRANSFORM_SIMD_WIDTH
+        size_t first = 0;
+#if TRANSFORM_SIMD_WIDTH > 1
+        for (; first + TRANSFORM_SIMD_WIDTH <= pending.size(); first += TRANSFORM_SIMD_WIDTH) {
+            composeLocalBatch(&pending[first]);
+        }
+#endif
+        for (; first < pending.size(); ++first) {
+            composeLocalScalar(pending[first]);
+        }
+
+        // 3. Macierze swiata i normalnych w kolejnosci hierarchii
+        for (int node : pending) {
+            int parent = parents[node];
+            float localScale = uniformScale(node);
+            if (parent < 0) {
+                worldMatrices[node] = localMatrices[node];
+                worldScale[node] = localScale;
+            } else {
+                multiply(worldMatrices[parent], localMatrices[node], worldMatrices[node]);
+                worldScale[node] = (worldScale[parent] > 0.0f && localScale > 0.0f)
+                                       ? worldScale[parent] * localScale : -1.0f;
+            }
+
+            glm::mat3 linear(worldMatrices[node]);
+            float s = worldScale[node];
+            normalMatrices[node] = (s > 0.0f) ? linear * (1.0f / (s * s)) : cofactorNormalMatrix(linear);
+        }
+    }
+
+private:
+    std::vector<std::vector<float>*> localArrays() {
+        return {&posX, &posY, &posZ, &rotX, &rotY, &rotZ, &rotW, &scaleX, &scaleY, &scaleZ};
+    }
+
+    // Skala jednorodna -> jej wartosc, niejednorodna -> -1
+    float uniformScale(int node) const {
+        float sx = scaleX[node];
+        const float epsilon = 1e-5f * std::fabs(sx);
+        if (std::fabs(scaleY[node] - sx) > epsilon || std::fabs(scaleZ[node] - sx) > epsilon || sx <= 0.0f) {
+            return -1.0f;
+        }
+        return sx;
+    }
+
+    // Wersja skalarna - reszta paczki i platformy bez SSE (np. ARM)
+    void composeLocalScalar(int node) {
+        float x = rotX[node], y = rotY[node], z = rotZ[node], w = rotW[node];
+        float sx = scaleX[node], sy = scaleY[node], sz = scaleZ[node];
+        glm::mat4& m = localMatrices[node];
+        m[0] = glm::vec4((1.0f - 2.0f * (y * y + z * z)) * sx, 2.0f * (x * y + w * z) * sx,
+                         2.0f * (x * z - w * y) * sx, 0.0f);
+        m[1] = glm::vec4(2.0f * (x * y - w * z) * sy, (1.0f - 2.0f * (x * x + z * z)) * sy,
+                         2.0f * (y * z + w * x) * sy, 0.0f);
+        m[2] = glm::vec4(2.0f * (x * z + w * y) * sz, 2.0f * (y * z - w * x) * sz,
+                         (1.0f - 2.0f * (x * x + y * y)) * sz, 0.0f);
+        m[3] = glm::vec4(posX[node], posY[node], posZ[node], 1.0f);
+    }
+
+#if TRANSFORM_SIMD_WIDTH == 8
+    typedef __m256 Lane;
+    static Lane laneSet(float v) { return _mm256_set1_ps(v); }
+    static Lane laneAdd(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+    static Lane laneSub(Lane a, Lane b) { return _mm256_sub_ps(a, b); }
+    static Lane laneMul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+    static void laneStore(float* out, Lane a) { _mm256_storeu_ps(out, a); }
+    static Lane laneGather(const std::vector<float>& array, const int* nodes) {
+        __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(nodes));
+        return _mm256_i32gather_ps(array.data(), index, 4);
+    }
+#elif TRANSFORM_SIMD_WIDTH == 4
+    typedef __m128 Lane;
+    static Lane laneSet(float v) { return _mm_set1_ps(v); }
+    static Lane laneAdd(Lane a, Lane b) { return _mm_add_ps(a, b); }
+    static Lane laneSub(Lane a, Lane b) { return _mm_sub_ps(a, b); }
+    static Lane laneMul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+    static void laneStore(float* out, Lane a) { _mm_storeu_ps(out, a); }
+    static Lane laneGather(const std::vector<float>& array, const int* nodes) {
+        return _mm_setr_ps(array[nodes[0]], array[nodes[1]], array[nodes[2]], array[nodes[3]]);
+    }
+#endif
+
+#if TRANSFORM_SIMD_WIDTH > 1
+    // TRS -> macierz dla TRANSFORM_SIMD_WIDTH wezlow naraz (jeden wezel na tor)
+    void composeLocalBatch(const int* nodes) {
+        Lane x = laneGather(rotX, nodes), y = laneGather(rotY, nodes);
+        Lane z = laneGather(rotZ, nodes), w = laneGather(rotW, nodes);
+        Lane sx = laneGather(scaleX, nodes), sy = laneGather(scaleY, nodes), sz = laneGather(scaleZ, nodes);
+
+        Lane one = laneSet(1.0f), two = laneSet(2.0f);
+        Lane xx = laneMul(x, x), yy = laneMul(y, y), zz = laneMul(z, z);
+        Lane xy = laneMul(x, y), xz = laneMul(x, z), yz = laneMul(y, z);
+        Lane wx = laneMul(w, x), wy = laneMul(w, y), wz = laneMul(w, z);
+
+        // Kolumny macierzy rotacji przemnozone przez skale osi
+        float out[12][TRANSFORM_SIMD_WIDTH];
+        laneStore(out[0], laneMul(laneSub(one, laneMul(two, laneAdd(yy, zz))), sx));
+        laneStore(out[1], laneMul(laneMul(two, laneAdd(xy, wz)), sx));
+        laneStore(out[2], laneMul(laneMul(two, laneSub(xz, wy)), sx));
+        laneStore(out[3], laneMul(laneMul(two, laneSub(xy, wz)), sy));
+        laneStore(out[4], laneMul(laneSub(one, laneMul(two, laneAdd(xx, zz))), sy));
+        laneStore(out[5], laneMul(laneMul(two, laneAdd(yz, wx)), sy));
+        laneStore(out[6], laneMul(laneMul(two, laneAdd(xz, wy)), sz));
+        laneStore(out[7], laneMul(laneMul(two, laneSub(yz, wx)), sz));
+        laneStore(out[8], laneMul(laneSub(one, laneMul(two, laneAdd(xx, yy))), sz));
+        laneStore(out[9], laneGather(posX, nodes));
+        laneStore(out[10], laneGather(posY, nodes));
+        laneStore(out[11], laneGather(posZ, nodes));
+
+        for (int lane = 0; lane < TRANSFORM_SIMD_WIDTH; ++lane) {
+            glm::mat4& m = localMatrices[nodes[lane]];
+            m[0] = glm::vec4(out[0][lane], out[1][lane], out[2][lane], 0.0f);
+            m[1] = glm::vec4(out[3][lane], out[4][lane], out[5][lane], 0.0f);
+            m[2] = glm::vec4(out[6][lane], out[7][lane], out[8][lane], 0.0f);
+            m[3] = glm::vec4(out[9][lane], out[10][lane], out[11][lane], 1.0f);
+        }
+    }
+#endif
+
+    // out = a * b; kolumna wyniku to kombinacja kolumn a z wagami z kolumny b
+    static void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+#if TRANSFORM_SIMD_WIDTH > 1
+        __m128 a0 = _mm_loadu_ps(&a[0][0]), a1 = _mm_loadu_ps(&a[1][0]);
+        __m128 a2 = _mm_loadu_ps(&a[2][0]), a3 = _mm_loadu_ps(&a[3][0]);
+        float result[16];
+        for (int c = 0; c < 4; ++c) {
+            __m128 column = _mm_mul_ps(a0, _mm_set1_ps(b[c][0]));
+            column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(b[c][1])));
+            column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(b[c][2])));
+            column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(b[c][3])));
+            _mm_storeu_ps(result + 4 * c, column);
+        }
+        for (int c = 0; c < 4; ++c) {
+            out[c] = glm::vec4(result[4 * c], result[4 * c + 1], result[4 * c + 2], result[4 * c + 3]);
+        }
+#else
+        out = a * b;
+#endif
+    }
+
+    // Dane lokalne (SoA)
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> rotX, rotY, rotZ, rotW;
+    std::vector<float> scaleX, scaleY, scaleZ;
+    std::vector<int> parents;
+    std::vector<uint8_t> dirty;
+    std::vector<uint8_t> changed;
+
+    // Wyniki
+    std::vector<glm::mat4> localMatrices;
+    std::vector<glm::mat4> worldMatrices;
+    std::vector<glm::mat3> normalMatrices;
+    std::vector<float> worldScale;   // > 0 gdy skala w swiecie jest jednorodna
+
+    std::vector<int> pending;
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include "dynamic_buffer.h"
+#include "profiler.h"
+
+// ============== UNIFORM BUFFER OBJECTS (std140) ==============
+// Dane wspolne dla wszystkich programow (mainShader, bezierShader) trzymane
+// sa w blokach uniform. Struktury ponizej odwzorowuja uklad std140 bajt po
+// bajcie - kazde vec3 jest dopelnione skalarem do 16 bajtow, dokladnie tak
+// jak w deklaracjach blokow w shaderach. Swiatla nie mieszcza sie w UBO -
+// leza w buforach tekstur oswietlenia klastrowego (light_clusters.h), w tym
+// samym ukladzie std140. Bloki zmieniane co klatke (FrameData, ObjectData,
+// SurfaceData, ShadowData) leza w pierscieniu DynamicBuffer.
+
+// Punkty wiazania blokow (glUniformBlockBinding / glBindBufferBase)
+const GLuint UBO_BINDING_FRAME = 0;
+const GLuint UBO_BINDING_SHADOW = 1;
+const GLuint UBO_BINDING_MATERIAL = 2;
+const GLuint UBO_BINDING_OBJECT = 3;
+const GLuint UBO_BINDING_SURFACE = 4;
+
+// Obszar pierscienia na klatke: FrameData kamery i widokow swiatel, ShadowData,
+// SurfaceData i transformacje wezlow - kazdy wpis wyrownany (zwykle do 256 B)
+const size_t DYNAMIC_BUFFER_FRAME_BYTES = 64 * 1024;
+
+// Jednostka tekstury materialu (textureDiffuse)
+const GLuint TEXTURE_UNIT_DIFFUSE = 0;
+// Jednostki tekstur buforow swiatel (samplery ustawiane raz w bindBlocks)
+const GLuint TEXTURE_UNIT_LIGHTS = 1;
+const GLuint TEXTURE_UNIT_CLUSTERS = 2;
+const GLuint TEXTURE_UNIT_LIGHT_INDICES = 3;
+// Jednostki tekstur G-buffera (przebieg oswietlenia trybu odroczonego)
+const GLuint TEXTURE_UNIT_GBUFFER_ALBEDO = 4;
+const GLuint TEXTURE_UNIT_GBUFFER_NORMAL = 5;
+const GLuint TEXTURE_UNIT_GBUFFER_SPECULAR = 6;
+const GLuint TEXTURE_UNIT_GBUFFER_DEPTH = 7;
+// Jednostki map cieni (shadow_maps.h)
+const GLuint TEXTURE_UNIT_SPOT_SHADOWS = 8;
+const GLuint TEXTURE_UNIT_POINT_SHADOWS = 9;
+// Kolor sceny w skalowanej rozdzielczosci (dynamic_resolution.h)
+const GLuint TEXTURE_UNIT_SCENE_COLOR = 10;
+
+struct PointLightStd140 {
+    glm::vec3 position;  float constant;   // position w ukladzie kamery
+    glm::vec3 ambient;   float linear;
+    glm::vec3 diffuse;   float quadratic;
+    glm::vec3 specular;  float _pad0;
+};
+
+struct SpotLightStd140 {
+    glm::vec3 position;  float constant;   // position w ukladzie kamery
+    glm::vec3 direction; float linear;     // direction w ukladzie kamery
+    glm::vec3 ambient;   float quadratic;
+    glm::vec3 diffuse;   float cutOff;     // cos kata wewnetrznego
+    glm::vec3 specular;  float outerCutOff; // cos kata zewnetrznego
+};
+
+// Blok FrameData - zmienia sie co najwyzej raz na klatke
+struct FrameUniformsStd140 {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 fogColor;  float fogDensity;
+    float dayNightFactor;  // 0.0 = noc, 1.0 = dzien
+    int fogEnabled;        // bool w std140 zajmuje 4 bajty
+    int useBlinn;
+    float time;
+    int numPointLights;
+    int numSpotLights;
+    glm::vec2 viewportSize; // rozmiar celu renderowania w pikselach
+    float clusterDepthScale; // plasterek klastra = log(glebokosc) * scale - bias
+    float clusterDepthBias;
+    float _pad0, _pad1;
+};
+
+// Blok ObjectData - transformacja wezla (wpis pierscienia na wezel i klatke).
+// mat3 w std140 to trzy kolumny dopelnione do vec4.
+struct ObjectStd140 {
+    glm::mat4 model;
+    glm::vec4 normalMatrix[3];   // w ukladzie swiata - shader mnozy przez mat3(view)
+};
+
+// Blok SurfaceData - parametry powierzchni Beziera, raz na klatke
+struct SurfaceStd140 {
+    glm::vec2 windDirection;
+    float windStrength;
+    float tessMaxLevel;
+    float tessTriangleSize;
+    int adaptiveTessellation;
+    int backfaceCulling;
+    float _pad0;
+};
+
+// Blok MaterialData - jeden wpis na material, wysylany raz przy tworzeniu
+struct MaterialStd140 {
+    glm::vec3 ambient;       float shininess;
+    glm::vec3 diffuse;       int useTexture;
+    glm::vec3 specular;      int useCheckerboard;
+    glm::vec3 objectColor;   float checkerScale;
+    glm::vec3 checkerColor1; int useFlagColors;
+    glm::vec3 checkerColor2; float _pad0;
+    glm::vec3 flagColor1;    float _pad1;
+    glm::vec3 flagColor2;    float _pad2;
+};
+
+static_assert(sizeof(PointLightStd140) == 64, "PointLight musi miec uklad std140");
+static_assert(sizeof(SpotLightStd140) == 80, "SpotLight musi miec uklad std140");
+static_assert(sizeof(FrameUniformsStd140) == 192, "FrameData musi miec uklad std140");
+static_assert(sizeof(MaterialStd140) == 128, "MaterialData musi miec uklad std140");
+static_assert(sizeof(ObjectStd140) == 112, "ObjectData musi miec uklad std140");
+static_assert(sizeof(SurfaceStd140) == 32, "SurfaceData musi miec uklad std140");
+
+inline ObjectStd140 makeObjectData(const glm::mat4& model, const glm::mat3& normalMatrix) {
+    ObjectStd140 object;
+    object.model = model;
+    for (int i = 0; i < 3; ++i) object.normalMatrix[i] = glm::vec4(normalMatrix[i], 0.0f);
+    return object;
+}
+
+// Domyslny material (wartosci z dawnego setLightUniforms)
+inline MaterialStd140 makeMaterial(const glm::vec3& color) {
+    MaterialStd140 m;
+    std::memset(static_cast<void*>(&m), 0, sizeof(m));
+    m.ambient = glm::vec3(0.25f);
+    m.diffuse = glm::vec3(0.9f);
+    m.specular = glm::vec3(0.6f);  // Mniej intensywny specular
+    m.shininess = 12.0f;           // Wiekszy highlight
+    m.objectColor = color;
+    return m;
+}
+
+class UniformBuffers {
+public:
+    FrameUniformsStd140 frame;
+
+    // Pierscien danych zmienianych co klatke (beginFrame/endFrame wywoluje petla)
+    DynamicBuffer dynamic;
+
+    // Statystyki wysylania (zerowane w resetStats)
+    unsigned int uploadCount;
+    size_t uploadedBytes;
+
+    UniformBuffers() : uploadCount(0), uploadedBytes(0), materialUBO(0), materialStride(0),
+                       materialCapacity(0), materialCount(0), frameOffset(DYNAMIC_BUFFER_FULL) {
+        std::memset(static_cast<void*>(&frame), 0, sizeof(frame));
+    }
+
+    bool init(int maxMaterials) {
+        if (!dynamic.init(DYNAMIC_BUFFER_FRAME_BYTES)) return false;
+
+        // Materialy leza w jednym buforze, kazdy pod offsetem wyrownanym
+        // do GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT (wymog glBindBufferRange)
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        materialStride = (sizeof(MaterialStd140) + alignment - 1) / alignment * alignment;
+        materialCapacity = maxMaterials;
+
+        glGenBuffers(1, &materialUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, materialUBO);
+        glBufferData(GL_UNIFORM_BUFFER, materialStride * materialCapacity, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        return glGetError() == GL_NO_ERROR;
+    }
+
+    // Podlacza bloki programu do wspolnych punktow wiazania, a samplery tekstury
+    // materialu, buforow swiatel, G-buffera i map cieni do ich jednostek. Nieuzywane sa pomijane.
+    static void bindBlocks(GLuint program) {
+        const char* names[] = {"FrameData", "ShadowData", "MaterialData", "ObjectData", "SurfaceData"};
+        const GLuint bindings[] = {UBO_BINDING_FRAME, UBO_BINDING_SHADOW, UBO_BINDING_MATERIAL,
+                                   UBO_BINDING_OBJECT, UBO_BINDING_SURFACE};
+        for (int i = 0; i < 5; ++i) {
+            GLuint index = glGetUniformBlockIndex(program, names[i]);
+            if (index != GL_INVALID_INDEX) {
+                glUniformBlockBinding(program, index, bindings[i]);
+            }
+        }
+
+        const char* samplers[] = {"textureDiffuse", "clusterLights", "clusterRecords", "clusterLightIndices",
+                                  "gAlbedo", "gNormal", "gSpecular", "gDepth",
+                                  "spotShadowMaps", "pointShadowMaps", "sceneColor"};
+        const GLuint units[] = {TEXTURE_UNIT_DIFFUSE, TEXTURE_UNIT_LIGHTS, TEXTURE_UNIT_CLUSTERS, TEXTURE_UNIT_LIGHT_INDICES,
+                                TEXTURE_UNIT_GBUFFER_ALBEDO, TEXTURE_UNIT_GBUFFER_NORMAL,
+                                TEXTURE_UNIT_GBUFFER_SPECULAR, TEXTURE_UNIT_GBUFFER_DEPTH,
+                                TEXTURE_UNIT_SPOT_SHADOWS, TEXTURE_UNIT_POINT_SHADOWS, TEXTURE_UNIT_SCENE_COLOR};
+        for (int i = 0; i < 11; ++i) {
+            GLint location = glGetUniformLocation(program, samplers[i]);
+            if (location >= 0) glProgramUniform1i(program, location, (GLint)units[i]);
+        }
+    }
+
+    // Zwraca indeks materialu albo -1 gdy bufor jest pelny
+    int addMaterial(const MaterialStd140& material) {
+        int index = materialCount;
+        if (index >= materialCapacity) return -1;
+        glBindBuffer(GL_UNIFORM_BUFFER, materialUBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, index * materialStride, sizeof(MaterialStd140), &material);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        ++materialCount;
+        ++uploadCount;
+        uploadedBytes += sizeof(MaterialStd140);
+        return index;
+    }
+
+    // Przywraca FrameData kamery po przebiegach z innym widokiem (mapy cieni)
+    void bindFrame() {
+        dynamic.bind(UBO_BINDING_FRAME, frameOffset, sizeof(frame));
+    }
+
+    // Przelaczenie materialu to tylko zmiana zakresu - bez wysylania danych
+    void bindMaterial(int index) const {
+        glBindBufferRange(GL_UNIFORM_BUFFER, UBO_BINDING_MATERIAL, materialUBO,
+                          index * materialStride, sizeof(MaterialStd140));
+        countStateChange();
+    }
+
+    // Kopiuje dane klatki do pierscienia i podpina je. Wywolywane raz na
+    // klatke, po wypelnieniu pola frame i dynamic.beginFrame().
+    void upload() {
+        frameOffset = dynamic.push(frame);
+        bindFrame();
+    }
+
+    void resetStats() {
+        uploadCount = 0;
+        uploadedBytes = 0;
+    }
+
+    void destroy() {
+        dynamic.destroy();
+        glDeleteBuffers(1, &materialUBO);
+        materialUBO = 0;
+    }
+
+private:
+    unsigned int materialUBO;
+    size_t materialStride;
+    int materialCapacity;
+    int materialCount;
+    size_t frameOffset;   // FrameData kamery w obszarze biezacej klatki
+};
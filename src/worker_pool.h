@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============== PULA WATKOW ROBOCZYCH ==============
+// Stale watki dla pracy wykonywanej co klatke (tworzenie std::thread w kazdej
+// klatce kosztuje wiecej niz sama praca). run() dzieli zadania 0..taskCount-1
+// miedzy watki puli i watek wywolujacy, ktory takze pracuje, i wraca dopiero
+// po wykonaniu wszystkich.
+// post() kolejkuje zadanie w tle (np. wczytanie pliku) bez czekania. run()
+// czeka na wszystkie watki puli, wiec dluga praca w tle opoznilaby prace
+// klatki - zadania w tle dostaja osobna pule (TextureStreamer).
+
+class WorkerPool {
+public:
+    // threadCount - liczba watkow lacznie z wywolujacym (0 = liczba rdzeni)
+    explicit WorkerPool(unsigned int threadCount = 0)
+        : task(NULL), taskCount(0), nextTask(0), active(0), generation(0), runningPosted(0), stopping(false) {
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 1; i < threadCount; ++i) workers.emplace_back([this]() { loop(); });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned int size() const { return (unsigned int)workers.size() + 1; }
+
+    void run(size_t count, const std::function<void(size_t)>& work) {
+        if (count == 0) return;
+        if (workers.empty() || count == 1) {
+            for (size_t i = 0; i < count; ++i) work(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &work;
+            taskCount = count;
+            nextTask.store(0);
+            active = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        execute();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return active == 0; });
+        task = NULL;
+    }
+
+    // Zadanie w tle dla pierwszego wolnego watku; pula bez watkow wykonuje je od razu
+    void post(std::function<void()> job) {
+        if (workers.empty()) {
+            job();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            posted.push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    // Odrzuca nierozpoczete zadania w tle i czeka na koniec trwajacych
+    void cancelPosted() {
+        std::unique_lock<std::mutex> lock(mutex);
+        posted.clear();
+        done.wait(lock, [this]() { return runningPosted == 0; });
+    }
+
+private:
+    void execute() {
+        size_t index;
+        while ((index = nextTask.fetch_add(1)) < taskCount) (*task)(index);
+    }
+
+    void loop() {
+        size_t seen = 0;
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen]() { return stopping || generation != seen || !posted.empty(); });
+                if (stopping) return;
+                // Praca run() ma pierwszenstwo przed zadaniami w tle
+                if (generation != seen) {
+                    seen = generation;
+                } else {
+                    job = std::move(posted.front());
+                    posted.pop_front();
+                    ++runningPosted;
+                }
+            }
+            if (job) {
+                job();
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--runningPosted == 0) done.notify_all();
+                continue;
+            }
+            execute();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0) done.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(size_t)>* task;
+    size_t taskCount;
+    std::atomic<size_t> nextTask;
+    size_t active;         // watki puli, ktore nie skonczyly biezacego run()
+    size_t generation;     // numer run() - watek budzi sie raz na wywolanie
+    std::deque<std::function<void()>> posted;   // zadania w tle (post)
+    size_t runningPosted;  // zadania w tle w trakcie
+    bool stopping;
+};